@@ -0,0 +1,33 @@
+# ---------------------------------------------------------
+# Fuzzing and sanitizers
+#
+# Creates an option ENABLE_FUZZING. When it's ON:
+#   - everything is built with AddressSanitizer and UndefinedBehaviorSanitizer,
+#   - the fuzz targets from the fuzz/ directory are built,
+#   - with clang the targets are libFuzzer fuzzers and the library is instrumented for
+#     the coverage, with other compilers they replay the given inputs or random ones.
+#
+# The fuzz targets are also registered as tests, which run a fixed number of inputs.
+# ---------------------------------------------------------
+function(EnableFuzzing)
+option(ENABLE_FUZZING "Build the fuzz targets with the sanitizers" OFF)
+
+if (NOT ENABLE_FUZZING)
+  return()
+endif ()
+
+set(SANITIZER_FLAGS -fsanitize=address,undefined -fno-sanitize-recover=undefined
+  -fno-omit-frame-pointer)
+add_compile_options(${SANITIZER_FLAGS})
+add_link_options(${SANITIZER_FLAGS})
+
+if (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+  add_compile_options(-fsanitize=fuzzer-no-link)
+  set(FUZZING_LIBFUZZER ON PARENT_SCOPE)
+else ()
+  message(STATUS "libFuzzer needs clang, the fuzz targets use the standalone driver")
+  set(FUZZING_LIBFUZZER OFF PARENT_SCOPE)
+endif ()
+endfunction()
+# ---------------------------------------------------------
+EnableFuzzing()
@@ -0,0 +1,20 @@
+# ---------------------------------------------------------
+# Enables link time optimization
+#
+# Creates an option ENABLE_LTO
+# ---------------------------------------------------------
+function(EnableLTO)
+option(ENABLE_LTO "Enable link time optimization" OFF)
+
+if (ENABLE_LTO)
+  include(CheckIPOSupported)
+  check_ipo_supported(RESULT LTO_SUPPORTED OUTPUT LTO_ERROR)
+  if (LTO_SUPPORTED)
+    set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON PARENT_SCOPE)
+  else ()
+    message(SEND_ERROR "LTO requested but not supported: ${LTO_ERROR}")
+  endif ()
+endif ()
+endfunction()
+# ---------------------------------------------------------
+EnableLTO()
@@ -0,0 +1,52 @@
+# ---------------------------------------------------------
+# Profile guided optimization
+#
+# Creates an option PGO_MODE:
+#   OFF      - normal build
+#   GENERATE - instrumented build, running it writes the profile to PGO_PROFILE_DIR
+#   USE      - build optimized with the profile from PGO_PROFILE_DIR
+#
+# GCC names the profile files after the object files paths, so both stages must use the same
+# build directory. The whole two stage build is done by the ./run_pgo.sh script.
+# ---------------------------------------------------------
+function(EnablePGO)
+set(PGO_MODE "OFF" CACHE STRING "Profile guided optimization mode: OFF, GENERATE or USE")
+set_property(CACHE PGO_MODE PROPERTY STRINGS OFF GENERATE USE)
+set(PGO_PROFILE_DIR "${CMAKE_SOURCE_DIR}/build/pgo-profile" CACHE PATH
+  "Directory for the profile data")
+
+if (PGO_MODE STREQUAL "OFF")
+  return()
+endif ()
+
+if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+  if (PGO_MODE STREQUAL "GENERATE")
+    # the profile is updated atomically, as the engine runs many threads
+    set(PGO_FLAGS -fprofile-generate -fprofile-update=atomic -fprofile-dir=${PGO_PROFILE_DIR})
+  elseif (PGO_MODE STREQUAL "USE")
+    set(PGO_FLAGS -fprofile-use -fprofile-correction -Wno-missing-profile
+      -fprofile-dir=${PGO_PROFILE_DIR})
+  endif ()
+elseif (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+  if (PGO_MODE STREQUAL "GENERATE")
+    set(PGO_FLAGS -fprofile-instr-generate=${PGO_PROFILE_DIR}/slchess-%p.profraw)
+  elseif (PGO_MODE STREQUAL "USE")
+    # the raw profiles must be merged first with llvm-profdata
+    set(PGO_FLAGS -fprofile-instr-use=${PGO_PROFILE_DIR}/slchess.profdata
+      -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date)
+  endif ()
+else ()
+  message(SEND_ERROR "PGO is not supported for ${CMAKE_CXX_COMPILER_ID}")
+  return()
+endif ()
+
+if (NOT PGO_FLAGS)
+  message(SEND_ERROR "Unknown PGO_MODE: ${PGO_MODE}, use OFF, GENERATE or USE")
+  return()
+endif ()
+
+add_compile_options(${PGO_FLAGS})
+add_link_options(${PGO_FLAGS})
+endfunction()
+# ---------------------------------------------------------
+EnablePGO()
@@ -36,6 +36,17 @@ message("Use ClangTidy:                    ${ENABLE_CLANG_TIDY}")
 message_change(ENABLE_CLANG_TIDY)
 message("ClangTidy executable:             ${CLANGTIDY}")
 
+message("Collect statistics:               ${ENABLE_STATS}")
+message_change(ENABLE_STATS)
+
+message("Link time optimization:           ${ENABLE_LTO}")
+message_change(ENABLE_LTO)
+message("Profile guided optimization:      ${PGO_MODE}")
+message("  --> change with -DPGO_MODE=(OFF|GENERATE|USE)")
+message("PGO profile directory:            ${PGO_PROFILE_DIR}")
+message("Fuzz targets and sanitizers:      ${ENABLE_FUZZING}")
+message_change(ENABLE_FUZZING)
+
 
 message("###################################################")
 message("Using C++ standard:               ${CMAKE_CXX_STANDARD}")
@@ -0,0 +1,320 @@
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bitboard.hpp"
+#include "bitboard_batch.hpp"
+#include "fuzz_input.hpp"
+
+/**
+ * Differential fuzzing of the bitboards.
+ *
+ * The input is a sequence of operations applied to a `std::bitset`, the simple reference, and to
+ * the optimized implementations: the word array `bitboard` with and without the range checks and
+ * the `bitboard_batch` kernels. After every operation all of them must have the same bits.
+ *
+ * The first byte chooses the shape, the shapes cover a partial word, a full word and 2, 3 and 4
+ * words with a partial and a full last word.
+ */
+
+using namespace slchess;
+using namespace slchess::fuzz;
+
+namespace {
+
+template <size_t files_, size_t ranks_>
+class bitboard_fuzzer {
+ private:
+  static constexpr size_t bits = files_ * ranks_;
+  static constexpr size_t batch_size = 11;  ///< Not a multiple of the lane block.
+
+  using reference = std::bitset<bits>;
+  using checked = bitboard<files_, ranks_, true>;
+  using unchecked = bitboard<files_, ranks_, false>;
+  using batch = bitboard_batch<files_, ranks_>;
+
+  fuzz_input& input;
+  reference expected;
+  checked board;
+  unchecked fast_board;
+  std::vector<reference> expected_batch = std::vector<reference>(batch_size);
+  batch boards{batch_size};
+
+  static uint64_t reference_word(const reference& bits_, size_t w) {
+    uint64_t result = 0;
+    for (size_t bit = 0; bit < 64 && w * 64 + bit < bits; ++bit) {
+      if (bits_[w * 64 + bit]) {
+        result |= 1ULL << bit;
+      }
+    }
+    return result;
+  }
+
+  template <typename B>
+  static void compare(const reference& bits_, const B& bb, const char* name) {
+    for (size_t w = 0; w < B::words(); ++w) {
+      FUZZ_CHECK(bb.word(w) == reference_word(bits_, w),
+                 name << " " << files_ << "x" << ranks_ << " word " << w << " is " << bb.word(w)
+                      << " instead of " << reference_word(bits_, w));
+    }
+    FUZZ_CHECK(bb.count() == bits_.count(), name << " count");
+    FUZZ_CHECK(bb.any() == bits_.any(), name << " any");
+    FUZZ_CHECK(bb.none() == bits_.none(), name << " none");
+    FUZZ_CHECK(bb.all() == bits_.all(), name << " all");
+    FUZZ_CHECK(bb.to_string() == bits_.to_string('-', 'x'), name << " to_string");
+
+    bool fits = (bits_ >> std::min<size_t>(bits, 64)).none() || bits <= 64;
+    if (fits) {
+      FUZZ_CHECK(bb.to_ullong() == bits_.to_ullong(), name << " to_ullong");
+    } else {
+      bool thrown = false;
+      try {
+        static_cast<void>(bb.to_ullong());
+      } catch (const std::overflow_error&) {
+        thrown = true;
+      }
+      FUZZ_CHECK(thrown, name << " to_ullong should overflow");
+    }
+  }
+
+  template <typename B>
+  static B from_reference(const reference& bits_) {
+    B result;
+    for (size_t w = 0; w < B::words(); ++w) {
+      result.set_word(w, reference_word(bits_, w));
+    }
+    return result;
+  }
+
+  reference random_reference() {
+    reference result;
+    for (size_t w = 0; w < checked::words(); ++w) {
+      auto value = input.next<uint64_t>();
+      for (size_t bit = 0; bit < 64 && w * 64 + bit < bits; ++bit) {
+        result[w * 64 + bit] = (value >> bit) & 1;
+      }
+    }
+    return result;
+  }
+
+  /// Sets or resets the field in the reference and in both bitboards.
+  void assign(bool value) {
+    // the coordinates can be a bit outside the board, to check the range errors
+    auto file = File(input.next_below(files_ + 3));
+    auto rank = Rank(input.next_below(ranks_ + 3));
+    bool in_range = file < files_ && rank < ranks_;
+    bool use_square = (input.next<uint8_t>() & 1) != 0 && file < Square::max_files &&
+                      rank < Square::max_ranks;
+
+    bool thrown = false;
+    try {
+      if (use_square) {
+        value ? board.set(Square(file, rank)) : board.reset(Square(file, rank));
+      } else {
+        value ? board.set(file, rank) : board.reset(file, rank);
+      }
+    } catch (const std::out_of_range&) {
+      thrown = true;
+    }
+    FUZZ_CHECK(thrown == !in_range, "range check for " << file << ", " << rank);
+
+    if (in_range) {
+      expected[coordinates_to_index(file, rank, files_)] = value;
+      fast_board.set(file, rank, value);
+      FUZZ_CHECK(board.test(file, rank) == value, "test");
+      FUZZ_CHECK(fast_board.get(file, rank) == value, "unchecked get");
+    }
+  }
+
+  void apply_binary(int op, const reference& operand) {
+    auto checked_operand = from_reference<checked>(operand);
+    auto unchecked_operand = from_reference<unchecked>(operand);
+    switch (op) {
+      case 0:
+        expected &= operand;
+        board &= checked_operand;
+        fast_board &= unchecked_operand;
+        break;
+      case 1:
+        expected |= operand;
+        board |= checked_operand;
+        fast_board |= unchecked_operand;
+        break;
+      default:
+        expected ^= operand;
+        board ^= checked_operand;
+        fast_board ^= unchecked_operand;
+        break;
+    }
+    FUZZ_CHECK((board == checked_operand) == (expected == operand), "operator==");
+  }
+
+  void apply_batch() {
+    auto op = input.next_below(9);
+    if (op < 4) {
+      // an operation with another batch
+      batch other(batch_size);
+      std::vector<reference> other_expected(batch_size);
+      for (size_t n = 0; n < batch_size; ++n) {
+        other_expected[n] = random_reference();
+        other.store(n, from_reference<unchecked>(other_expected[n]));
+      }
+      for (size_t n = 0; n < batch_size; ++n) {
+        auto& bits_ = expected_batch[n];
+        bits_ = op == 0   ? bits_ & other_expected[n]
+                : op == 1 ? bits_ | other_expected[n]
+                : op == 2 ? bits_ ^ other_expected[n]
+                          : bits_ & ~other_expected[n];
+      }
+      op == 0   ? boards &= other
+      : op == 1 ? boards |= other
+      : op == 2 ? boards ^= other
+                : boards.and_not(other);
+    } else if (op < 8) {
+      // an operation with the same mask for all the bitboards
+      auto mask = random_reference();
+      auto mask_board = from_reference<unchecked>(mask);
+      for (auto& bits_ : expected_batch) {
+        bits_ = op == 4   ? bits_ & mask
+                : op == 5 ? bits_ | mask
+                : op == 6 ? bits_ ^ mask
+                          : bits_ & ~mask;
+      }
+      op == 4   ? boards &= mask_board
+      : op == 5 ? boards |= mask_board
+      : op == 6 ? boards ^= mask_board
+                : boards.and_not(mask_board);
+    } else {
+      auto shift = input.next_below(bits + 2);
+      bool left = (input.next<uint8_t>() & 1) != 0;
+      for (auto& bits_ : expected_batch) {
+        bits_ = left ? bits_ << shift : bits_ >> shift;
+      }
+      left ? boards <<= shift : boards >>= shift;
+    }
+  }
+
+  void compare_batch() {
+    std::vector<uint32_t> counts(batch_size);
+    boards.popcount(counts);
+    uint64_t total = 0;
+    for (size_t n = 0; n < batch_size; ++n) {
+      compare(expected_batch[n], boards.load(n), "batch");
+      FUZZ_CHECK(counts[n] == expected_batch[n].count(), "batch popcount " << n);
+      total += expected_batch[n].count();
+    }
+    FUZZ_CHECK(boards.popcount() == total, "batch total popcount");
+  }
+
+ public:
+  explicit bitboard_fuzzer(fuzz_input& input) : input(input) {}
+
+  void run() {
+    while (!input.empty()) {
+      auto op = input.next_below(13);
+      switch (op) {
+        case 0:
+        case 1:
+          assign(op == 0);
+          break;
+        case 2:
+          expected.set();
+          board.set();
+          fast_board.set();
+          break;
+        case 3:
+          expected.reset();
+          board.reset();
+          fast_board.reset();
+          break;
+        case 4:
+          expected.flip();
+          board.flip();
+          fast_board.flip();
+          break;
+        case 5:
+        case 6: {
+          auto shift = input.next_below(bits + 2);
+          expected = op == 5 ? expected << shift : expected >> shift;
+          board = op == 5 ? board << shift : board >> shift;
+          op == 5 ? fast_board <<= shift : fast_board >>= shift;
+          break;
+        }
+        case 7:
+          apply_binary(static_cast<int>(input.next_below(3)), random_reference());
+          break;
+        case 8: {
+          auto w = input.next_below(checked::words());
+          auto value = input.next<uint64_t>();
+          for (size_t bit = 0; bit < 64 && w * 64 + bit < bits; ++bit) {
+            expected[w * 64 + bit] = (value >> bit) & 1;
+          }
+          board.set_word(w, value);
+          fast_board.set_word(w, value);
+          break;
+        }
+        case 9: {
+          auto value = input.next<uint64_t>();
+          expected = reference(value);
+          board = checked(value);
+          fast_board = unchecked(value);
+          break;
+        }
+        case 10: {
+          auto n = input.next_below(batch_size);
+          expected_batch[n] = expected;
+          boards.store(n, fast_board);
+          break;
+        }
+        case 11:
+          apply_batch();
+          break;
+        default:
+          // the operators returning new bitboards
+          FUZZ_CHECK(from_reference<checked>(~expected) == ~board, "operator~");
+          FUZZ_CHECK(board == checked(board), "copy");
+          break;
+      }
+
+      compare(expected, board, "checked");
+      compare(expected, fast_board, "unchecked");
+      if (op >= 10) {
+        compare_batch();
+      }
+    }
+  }
+};
+
+template <size_t files_, size_t ranks_>
+void run(fuzz_input& input) {
+  bitboard_fuzzer<files_, ranks_> fuzzer(input);
+  fuzzer.run();
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  fuzz_input input(data, size);
+  switch (input.next_below(5)) {
+    case 0:
+      run<2, 3>(input);
+      break;
+    case 1:
+      run<8, 8>(input);
+      break;
+    case 2:
+      run<10, 10>(input);
+      break;
+    case 3:
+      run<11, 13>(input);
+      break;
+    default:
+      run<16, 16>(input);
+      break;
+  }
+  return 0;
+}
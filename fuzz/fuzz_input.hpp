@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+namespace slchess::fuzz {
+
+/**
+ * Reads the values from the fuzzer input, the values after the end of the input are zeros.
+ *
+ * The fuzzer mutates the bytes, so every byte should make a small, meaningful change: an operation
+ * code, a coordinate or a word.
+ */
+class fuzz_input {
+ private:
+  const uint8_t* data;
+  size_t size;
+  size_t position = 0;
+
+ public:
+  fuzz_input(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+  [[nodiscard]] bool empty() const { return position >= size; }
+
+  template <typename T>
+  [[nodiscard]] T next() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    T value{};
+    if (position < size) {
+      auto count = std::min(sizeof(T), size - position);
+      std::memcpy(&value, data + position, count);
+      position += count;
+    }
+    return value;
+  }
+
+  /**
+   * Returns a value in [0, bound), `bound` must be greater than zero.
+   */
+  [[nodiscard]] size_t next_below(size_t bound) {
+    return (bound <= 256 ? next<uint8_t>() : next<uint16_t>()) % bound;
+  }
+};
+
+/**
+ * Reports the difference and aborts, so the fuzzer saves the input.
+ */
+#define FUZZ_CHECK(condition, message)                                                \
+  do {                                                                                \
+    if (!(condition)) {                                                               \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": " << #condition << "\n  " << message \
+                << std::endl;                                                         \
+      std::abort();                                                                   \
+    }                                                                                 \
+  } while (false)
+
+}  // namespace slchess::fuzz
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fuzz_input.hpp"
+#include "move_picker.hpp"
+#include "movegen.hpp"
+#include "position.hpp"
+
+/**
+ * Differential fuzzing of the move generation.
+ *
+ * The input chooses a random playout from the starting position. In every position of the playout
+ * the different ways of getting the moves must agree:
+ *   - `generate<all>` and `generate<captures>` + `generate<quiets>`,
+ *   - `generate_legal` and `generate<all>` filtered with `is_legal`,
+ *   - `is_pseudo_legal` and the membership in `generate<all>`, also for random raw moves,
+ *   - `move_picker`, with random hash moves and killers, and `generate<all>`,
+ *   - the incrementally updated position and the one parsed from its FEN,
+ *   - `perft`, which uses `generate_legal`, and a perft of the staged generation, every few
+ *     plies.
+ */
+
+using namespace slchess;
+using namespace slchess::fuzz;
+
+namespace {
+
+/// Plies between the perft comparisons, which are much slower than the other checks.
+constexpr size_t perft_interval = 16;
+
+constexpr size_t max_plies = 400;
+
+std::vector<uint16_t> sorted(const move_list& moves) {
+  std::vector<uint16_t> result;
+  for (auto m : moves) {
+    result.push_back(m.raw());
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+void check_generation(const position& pos, const move_list& all) {
+  move_list captures;
+  move_list quiets;
+  generate<gen_type::captures>(pos, captures);
+  generate<gen_type::quiets>(pos, quiets);
+  for (auto m : captures) {
+    FUZZ_CHECK(m.is_capture() || m.is_promotion(), pos.to_fen() << " " << m.to_uci());
+  }
+  for (auto m : quiets) {
+    FUZZ_CHECK(!m.is_capture() && !m.is_promotion(), pos.to_fen() << " " << m.to_uci());
+  }
+  for (auto m : quiets) {
+    captures.push_back(m);
+  }
+  FUZZ_CHECK(sorted(captures) == sorted(all), pos.to_fen() << ": captures + quiets != all");
+
+  move_list legal;
+  generate_legal(pos, legal);
+  move_list filtered;
+  for (auto m : all) {
+    FUZZ_CHECK(is_pseudo_legal(pos, m), pos.to_fen() << " " << m.to_uci() << " not pseudo legal");
+    if (is_legal(pos, m)) {
+      filtered.push_back(m);
+    }
+  }
+  FUZZ_CHECK(sorted(legal) == sorted(filtered), pos.to_fen() << ": legal moves differ");
+}
+
+void check_raw_moves(const position& pos, const move_list& all, fuzz_input& input) {
+  auto generated = sorted(all);
+  for (int n = 0; n < 4; ++n) {
+    auto m = move::from_raw(input.next<uint16_t>());
+    bool expected = std::binary_search(generated.begin(), generated.end(), m.raw());
+    FUZZ_CHECK(is_pseudo_legal(pos, m) == expected,
+               pos.to_fen() << " " << m.to_uci() << " flags " << m.flags());
+  }
+}
+
+void check_picker(const position& pos, const move_list& all, fuzz_input& input) {
+  // the hash move and the killers are either generated moves or garbage, both must work
+  auto random_move = [&]() {
+    auto choice = input.next<uint16_t>();
+    return (choice & 1) != 0 && !all.empty() ? all[(choice >> 1) % all.size()]
+                                             : move::from_raw(input.next<uint16_t>());
+  };
+
+  history_tables history;
+  int ply = static_cast<int>(input.next_below(max_ply));
+  history.killers[ply][0] = random_move();
+  history.killers[ply][1] = random_move();
+  move_picker picker(pos, random_move(), history, ply, random_move());
+
+  move_list picked;
+  for (auto m = picker.next(); !m.is_none(); m = picker.next()) {
+    FUZZ_CHECK(picked.size() < all.size(), pos.to_fen() << ": the picker returns too many moves");
+    picked.push_back(m);
+  }
+  FUZZ_CHECK(sorted(picked) == sorted(all), pos.to_fen() << ": the picker moves differ");
+}
+
+/**
+ * Counts the leaf nodes like `perft`, but with the moves of the search: the captures and then the
+ * quiet moves, filtered with `is_legal`.
+ */
+uint64_t staged_perft(const position& pos, int depth) {
+  if (depth == 0) {
+    return 1;
+  }
+  move_list moves;
+  generate<gen_type::captures>(pos, moves);
+  generate<gen_type::quiets>(pos, moves);
+  uint64_t nodes = 0;
+  for (auto m : moves) {
+    if (is_legal(pos, m)) {
+      position next = pos;
+      next.make_move(m);
+      nodes += staged_perft(next, depth - 1);
+    }
+  }
+  return nodes;
+}
+
+void check_position(const position& pos) {
+  auto fen = pos.to_fen();
+  auto parsed = position::from_fen(fen);
+  FUZZ_CHECK(parsed.to_fen() == fen, fen << " round trip gives " << parsed.to_fen());
+  FUZZ_CHECK(parsed.key() == pos.key(), fen << ": the incremental key differs");
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  fuzz_input input(data, size);
+  auto pos = position::start();
+  for (size_t ply = 0; ply < max_plies && !input.empty(); ++ply) {
+    move_list all;
+    generate<gen_type::all>(pos, all);
+    check_generation(pos, all);
+    check_raw_moves(pos, all, input);
+    check_picker(pos, all, input);
+    check_position(pos);
+    if (ply % perft_interval == perft_interval - 1) {
+      FUZZ_CHECK(staged_perft(pos, 2) == perft(pos, 2), pos.to_fen() << ": perft differs");
+    }
+
+    move_list legal;
+    generate_legal(pos, legal);
+    if (legal.empty()) {
+      break;
+    }
+    pos.make_move(legal[input.next_below(legal.size())]);
+  }
+  return 0;
+}
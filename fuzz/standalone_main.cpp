@@ -0,0 +1,77 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * The driver for the fuzz targets when libFuzzer isn't available (e.g. with GCC).
+ *
+ * It runs the inputs from the given files and directories, like the libFuzzer reproducer,
+ * and then `-runs=N` random inputs of up to `-max_len=N` bytes generated from `-seed=N`.
+ * There is no coverage feedback, so it's a regression and random differential test.
+ */
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+namespace {
+
+void run_file(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  LLVMFuzzerTestOneInput(data.data(), data.size());
+}
+
+bool parse_flag(const std::string& arg, const char* name, uint64_t& value) {
+  auto prefix = std::string("-") + name + "=";
+  if (arg.rfind(prefix, 0) != 0) {
+    return false;
+  }
+  value = std::stoull(arg.substr(prefix.size()));
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  uint64_t runs = 0;
+  uint64_t seed = 0;
+  uint64_t max_len = 4096;
+  uint64_t files = 0;
+
+  for (int n = 1; n < argc; ++n) {
+    std::string arg = argv[n];
+    if (parse_flag(arg, "runs", runs) || parse_flag(arg, "seed", seed) ||
+        parse_flag(arg, "max_len", max_len)) {
+      continue;
+    }
+    if (std::filesystem::is_directory(arg)) {
+      for (const auto& entry : std::filesystem::directory_iterator(arg)) {
+        run_file(entry.path());
+        ++files;
+      }
+    } else {
+      run_file(arg);
+      ++files;
+    }
+  }
+
+  std::mt19937_64 rng(seed);
+  std::vector<uint8_t> data;
+  for (uint64_t run = 0; run < runs; ++run) {
+    data.resize(rng() % (max_len + 1));
+    for (auto& byte : data) {
+      byte = static_cast<uint8_t>(rng());
+    }
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+  }
+
+  std::cout << "Done " << files << " files and " << runs << " random inputs\n";
+  return 0;
+}
@@ -4,4 +4,5 @@ CMAKE_CMD='cmake . -DENABLE_CPPCHECK=ON'
 
 $CMAKE_CMD -DCMAKE_BUILD_TYPE=DEBUG -Bbuild/DEBUG
 $CMAKE_CMD -DCMAKE_BUILD_TYPE=RELEASE -Bbuild/RELEASE
+$CMAKE_CMD -DCMAKE_BUILD_TYPE=RELEASE -DENABLE_LTO=ON -Bbuild/RELEASE-LTO
 
@@ -0,0 +1,23 @@
+#!/bin/bash
+#
+# Builds the fuzz targets with clang, libFuzzer and the sanitizers in build/FUZZ, runs all the
+# tests of the sanitized build and then every fuzzer for the given number of seconds (60 by
+# default). The corpora are kept between the runs in build/fuzz-corpus, the crashing inputs are
+# written to the current directory.
+#
+# A crash can be reproduced with: build/FUZZ/bin/slchess-fuzz-<target> <input file>
+
+set -e
+
+BUILD_DIR=build/FUZZ
+CORPUS_DIR=build/fuzz-corpus
+SECONDS_PER_TARGET=${1:-60}
+
+CC=clang CXX=clang++ cmake . -DCMAKE_BUILD_TYPE=DEBUG -DENABLE_FUZZING=ON -B$BUILD_DIR
+cmake --build $BUILD_DIR
+ctest --test-dir $BUILD_DIR --output-on-failure
+
+for TARGET in bitboard movegen; do
+  mkdir -p "$CORPUS_DIR/$TARGET"
+  $BUILD_DIR/bin/slchess-fuzz-$TARGET -max_total_time="$SECONDS_PER_TARGET" "$CORPUS_DIR/$TARGET"
+done
@@ -0,0 +1,31 @@
+#!/bin/bash
+#
+# Builds the profile guided optimized binary in build/PGO:
+#  1. builds the instrumented binary,
+#  2. runs the bench on it, which writes the profile,
+#  3. builds the binary again in the same directory using the profile.
+#
+# The bench depth can be passed as the first argument.
+
+set -e
+
+BUILD_DIR=build/PGO
+PROFILE_DIR=$(pwd)/build/pgo-profile
+BENCH_DEPTH=${1:-8}
+CMAKE_CMD="cmake . -DCMAKE_BUILD_TYPE=RELEASE -DENABLE_LTO=ON -DPGO_PROFILE_DIR=$PROFILE_DIR -B$BUILD_DIR"
+
+rm -rf "$PROFILE_DIR"
+mkdir -p "$PROFILE_DIR"
+
+$CMAKE_CMD -DPGO_MODE=GENERATE
+cmake --build $BUILD_DIR --target slchess-bin
+$BUILD_DIR/bin/slchess bench depth "$BENCH_DEPTH"
+
+# clang writes the raw profiles, which must be merged
+if ls "$PROFILE_DIR"/*.profraw >/dev/null 2>&1; then
+  llvm-profdata merge -output="$PROFILE_DIR/slchess.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+$CMAKE_CMD -DPGO_MODE=USE
+cmake --build $BUILD_DIR --target slchess-bin
+$BUILD_DIR/bin/slchess bench depth "$BENCH_DEPTH"
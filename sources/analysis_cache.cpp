@@ -0,0 +1,126 @@
+#include "analysis_cache.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+namespace slchess {
+
+/**
+ * The first cache line of the file.
+ */
+struct alignas(64) analysis_cache::header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t entry_size;
+  uint64_t buckets;
+};
+
+namespace {
+
+constexpr uint64_t cache_magic = 0x4548434143534c53;  // "SLSCACHE"
+constexpr uint32_t cache_version = 1;
+
+uint64_t pack(move best_move, int score, int depth) {
+  return best_move.raw() | (static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16) |
+         (static_cast<uint64_t>(depth) << 32);
+}
+
+analysis_entry unpack(uint64_t data) {
+  return {move::from_raw(static_cast<uint16_t>(data)),
+          static_cast<int16_t>(data >> 16),
+          static_cast<int>((data >> 32) & 0xff)};
+}
+
+/**
+ * Closes the file descriptor when leaving the scope.
+ */
+struct file_descriptor {
+  int fd;
+
+  ~file_descriptor() { ::close(fd); }
+};
+
+}  // namespace
+
+analysis_cache::analysis_cache(const std::string& path, size_t entries) {
+  file_descriptor file{::open(path.c_str(), O_RDWR | O_CREAT, 0644)};
+  if (file.fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "Can't open " + path);
+  }
+
+  // the lock makes sure only one process initializes a new file
+  if (::flock(file.fd, LOCK_EX) != 0) {
+    throw std::system_error(errno, std::generic_category(), "Can't lock " + path);
+  }
+  struct stat info {};
+  if (::fstat(file.fd, &info) != 0) {
+    throw std::system_error(errno, std::generic_category(), "Can't stat " + path);
+  }
+
+  uint64_t buckets = 0;
+  if (info.st_size == 0) {
+    buckets = std::max<uint64_t>((entries + bucket_size - 1) / bucket_size, 1);
+    mapped_size = sizeof(header) + buckets * bucket_size * sizeof(lockless_entry);
+    if (::ftruncate(file.fd, static_cast<off_t>(mapped_size)) != 0) {
+      throw std::system_error(errno, std::generic_category(), "Can't resize " + path);
+    }
+    header new_header{cache_magic, cache_version, sizeof(lockless_entry), buckets};
+    if (::pwrite(file.fd, &new_header, sizeof(new_header), 0) !=
+        static_cast<ssize_t>(sizeof(new_header))) {
+      throw std::system_error(errno, std::generic_category(), "Can't write " + path);
+    }
+  } else {
+    header existing{};
+    auto read = ::pread(file.fd, &existing, sizeof(existing), 0);
+    if (read != static_cast<ssize_t>(sizeof(existing)) || existing.magic != cache_magic ||
+        existing.version != cache_version || existing.entry_size != sizeof(lockless_entry) ||
+        existing.buckets == 0 ||
+        static_cast<uint64_t>(info.st_size) !=
+            sizeof(header) + existing.buckets * bucket_size * sizeof(lockless_entry)) {
+      throw std::runtime_error("Not a valid analysis cache file: " + path);
+    }
+    buckets = existing.buckets;
+    mapped_size = static_cast<size_t>(info.st_size);
+  }
+  ::flock(file.fd, LOCK_UN);
+
+  void* address = ::mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+  if (address == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(), "Can't map " + path);
+  }
+  // the lookups are spread over the whole file
+  ::madvise(address, mapped_size, MADV_RANDOM);
+  header_ = static_cast<header*>(address);
+  table = lockless_table(header_ + 1, buckets);
+}
+
+analysis_cache::~analysis_cache() { ::munmap(header_, mapped_size); }
+
+std::optional<analysis_entry> analysis_cache::probe(uint64_t key) const {
+  auto data = table.probe(key);
+  if (data == 0) {
+    return std::nullopt;
+  }
+  return unpack(data);
+}
+
+void analysis_cache::store(uint64_t key, move best_move, int score, int depth) {
+  if (depth < 1) {
+    return;
+  }
+  auto slot = table.find_slot(key, [](uint64_t data) { return unpack(data).depth; });
+  if (slot.same_key && unpack(slot.data).depth > depth) {
+    return;
+  }
+  slot.entry->save(key, pack(best_move, score, std::min(depth, 255)));
+}
+
+}  // namespace slchess
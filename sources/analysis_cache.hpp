@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "lockless_table.hpp"
+#include "move.hpp"
+
+namespace slchess {
+
+/**
+ * A cached analysis result.
+ */
+struct analysis_entry {
+  move best_move;
+  int score = 0;  ///< Score in centipawns from the point of view of the side to move.
+  int depth = 0;
+};
+
+/**
+ * A persistent analysis cache: an open addressed hash table of the analysis results kept in
+ * a memory mapped file.
+ *
+ * The file is mapped as shared, so many engine processes on the same host can use the same
+ * cache at once, and the results survive the process restarts.
+ *
+ * The entries are kept in a `lockless_table` after the header of the file, so the processes
+ * share them without any locks: a torn entry (from two processes writing the same entry at once)
+ * just doesn't match the key and is treated as missing.
+ *
+ * The cached scores don't take the game history into account, so the repetitions before the
+ * analysed position are not seen.
+ */
+class analysis_cache {
+ public:
+  static constexpr size_t bucket_size = lockless_table::bucket_size;
+
+ private:
+  struct header;
+
+  header* header_ = nullptr;
+  lockless_table table;
+  size_t mapped_size = 0;
+
+ public:
+  /**
+   * Opens the cache file, creating it when it doesn't exist.
+   *
+   * @param path Path of the cache file.
+   * @param entries Number of the entries of a new file, rounded up to the whole buckets.
+   *                An existing file keeps its own size.
+   * @throws std::system_error when the file can't be opened or mapped.
+   * @throws std::runtime_error when the existing file is not a valid cache file.
+   */
+  analysis_cache(const std::string& path, size_t entries);
+  ~analysis_cache();
+
+  analysis_cache(const analysis_cache&) = delete;
+  analysis_cache& operator=(const analysis_cache&) = delete;
+
+  /**
+   * Returns the cached result for the position key.
+   */
+  [[nodiscard]] std::optional<analysis_entry> probe(uint64_t key) const;
+
+  /**
+   * Stores the result of the search of the given depth.
+   *
+   * A result for the same key is replaced only by a result of at least the same depth. When the
+   * bucket is full, the entry with the lowest depth is replaced.
+   *
+   * @param depth Depth of the search, the results with depth lower than 1 are not stored.
+   */
+  void store(uint64_t key, move best_move, int score, int depth);
+
+  /**
+   * Returns the number of the entries.
+   */
+  [[nodiscard]] size_t capacity() const { return table.capacity(); }
+};
+
+}  // namespace slchess
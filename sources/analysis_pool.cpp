@@ -0,0 +1,105 @@
+#include "analysis_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace slchess {
+
+analysis_pool::analysis_pool(unsigned threads, size_t hash_mb) : scheduler(threads) {
+  workers.reserve(scheduler.size());
+  for (size_t n = 0; n < scheduler.size(); ++n) {
+    workers.push_back(std::make_unique<worker>(hash_mb));
+  }
+}
+
+analysis_pool::~analysis_pool() {
+  cancel();
+  scheduler.wait(jobs);
+}
+
+std::future<search_result> analysis_pool::submit(const position& pos,
+                                                 const search_limits& limits,
+                                                 callback on_done) {
+  // the task must be copyable, so the job with its promise is shared
+  auto next = std::make_shared<job>(job{pos, limits, {}, std::move(on_done), 0});
+  auto result = next->promise.get_future();
+  {
+    std::lock_guard lock(mutex);
+    next->generation = generation;
+    ++queued;
+  }
+  scheduler.submit(jobs, [this, next] { run(*next); });
+  return result;
+}
+
+std::future<search_result> analysis_pool::submit(std::string_view fen,
+                                                 const search_limits& limits,
+                                                 callback on_done) {
+  return submit(position::from_fen(fen), limits, std::move(on_done));
+}
+
+std::vector<search_result> analysis_pool::analyse(std::span<const std::string> fens,
+                                                  const search_limits& limits) {
+  std::vector<position> positions;
+  positions.reserve(fens.size());
+  for (const auto& fen : fens) {
+    positions.push_back(position::from_fen(fen));
+  }
+
+  std::vector<std::future<search_result>> futures;
+  futures.reserve(positions.size());
+  for (const auto& pos : positions) {
+    futures.push_back(submit(pos, limits));
+  }
+  std::vector<search_result> results;
+  results.reserve(futures.size());
+  for (auto& future : futures) {
+    results.push_back(future.get());
+  }
+  return results;
+}
+
+void analysis_pool::cancel() {
+  std::lock_guard lock(mutex);
+  ++generation;
+  queued = 0;
+  for (auto& state : workers) {
+    state->stop.store(true, std::memory_order_relaxed);
+  }
+}
+
+size_t analysis_pool::pending() const {
+  std::lock_guard lock(mutex);
+  return queued;
+}
+
+void analysis_pool::run(job& current) {
+  auto& state = *workers[scheduler.worker_index()];
+  {
+    // the flag is cleared under the lock, so a `cancel` after this point stops the search
+    std::lock_guard lock(mutex);
+    if (current.generation != generation) {
+      // the promise is destroyed with the task, so the future throws
+      return;
+    }
+    --queued;
+    state.stop.store(false, std::memory_order_relaxed);
+  }
+
+  if (current.limits.stop == nullptr) {
+    current.limits.stop = &state.stop;
+  }
+  try {
+    // the positions built by hand are not checked by `from_fen`
+    current.pos.validate();
+    auto result = state.search.search(current.pos, current.limits);
+    if (current.on_done) {
+      current.on_done(result);
+    }
+    current.promise.set_value(std::move(result));
+  } catch (...) {
+    current.promise.set_exception(std::current_exception());
+  }
+}
+
+}  // namespace slchess
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "position.hpp"
+#include "search.hpp"
+#include "task_scheduler.hpp"
+#include "transposition_table.hpp"
+
+namespace slchess {
+
+/**
+ * A pool of the search threads analysing the queued positions, for the analysis servers.
+ *
+ * The jobs are the tasks of a `task_scheduler`, and every worker of the scheduler owns
+ * a `searcher` and a transposition table, created once and reused by all its jobs, so a job
+ * costs only the search itself. Every job is searched by one worker.
+ *
+ * @code
+ * analysis_pool pool(8, 64);
+ * search_limits limits;
+ * limits.depth = 12;
+ * limits.multi_pv = 3;
+ * auto result = pool.submit("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1", limits);
+ * for (const auto& line : result.get().lines) { ... }
+ * @endcode
+ */
+class analysis_pool {
+ public:
+  /// Called by the worker thread when the job is finished, before the future is ready.
+  using callback = std::function<void(const search_result&)>;
+
+ private:
+  struct job {
+    position pos;
+    search_limits limits;
+    std::promise<search_result> promise;
+    callback on_done;
+    uint64_t generation = 0;
+  };
+
+  struct worker {
+    transposition_table tt;
+    searcher search;
+    std::atomic<bool> stop{false};
+
+    explicit worker(size_t hash_mb) : tt(hash_mb) { search.set_transposition_table(&tt); }
+  };
+
+  // the scheduler is destroyed first, so its threads stop before the workers state is freed
+  std::vector<std::unique_ptr<worker>> workers;
+  task_scheduler scheduler;
+  task_group jobs;
+
+  mutable std::mutex mutex;
+  uint64_t generation = 0;  ///< Incremented by `cancel`, the jobs of the older ones are dropped.
+  size_t queued = 0;
+
+  void run(job& current);
+
+ public:
+  /**
+   * Starts the workers.
+   *
+   * @param threads Number of the workers, 0 means all the cores.
+   * @param hash_mb Size of the transposition table of every worker.
+   * @throws std::system_error when the tables can't be allocated.
+   */
+  explicit analysis_pool(unsigned threads = 0, size_t hash_mb = 16);
+
+  /**
+   * Cancels the queued jobs, stops the running ones and waits for the workers.
+   */
+  ~analysis_pool();
+
+  analysis_pool(const analysis_pool&) = delete;
+  analysis_pool& operator=(const analysis_pool&) = delete;
+
+  /**
+   * Queues the position for the analysis.
+   *
+   * Without the stop flag in the limits, the job uses the flag of its worker, so it can be
+   * stopped with `cancel`.
+   *
+   * @param on_done Optional function called with the result by the worker thread.
+   * @return The result, or the exception of the search. The future of an illegal position
+   *   throws `std::invalid_argument`, see `position::validate`. The future of a cancelled job
+   *   throws `std::future_error` with `std::future_errc::broken_promise`.
+   */
+  std::future<search_result> submit(const position& pos,
+                                    const search_limits& limits,
+                                    callback on_done = {});
+
+  /**
+   * Queues the position given as FEN.
+   *
+   * @throws std::invalid_argument when the FEN or its position is invalid, nothing is queued
+   * then.
+   */
+  std::future<search_result> submit(std::string_view fen,
+                                    const search_limits& limits,
+                                    callback on_done = {});
+
+  /**
+   * Analyses all the positions with the same limits and waits for the results.
+   *
+   * @return The results in the order of the positions.
+   * @throws std::invalid_argument when any FEN or its position is invalid, before anything is
+   * queued.
+   */
+  std::vector<search_result> analyse(std::span<const std::string> fens,
+                                     const search_limits& limits);
+
+  /**
+   * Removes all the queued jobs and stops the running ones, which return their results
+   * of the last completed iteration.
+   */
+  void cancel();
+
+  /**
+   * Returns the number of the queued jobs, not counting the running ones.
+   */
+  [[nodiscard]] size_t pending() const;
+
+  /**
+   * Returns the number of the workers.
+   */
+  [[nodiscard]] size_t size() const { return workers.size(); }
+};
+
+}  // namespace slchess
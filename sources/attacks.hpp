@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "chess.hpp"
+
+namespace slchess {
+
+/**
+ * Precalculated attack tables.
+ *
+ * All the tables are calculated at compile time. The step tables are built with the bitboard API,
+ * the sliding pieces use the classical approach on the raw words: for every direction there is
+ * a ray from every square, the ray is cut at the first blocker.
+ */
+namespace attacks {
+
+/// Directions as (file, rank) steps. The first four increase the square index.
+inline constexpr std::array<std::array<int, 2>, 8> directions = {{
+    {1, 0},    // east
+    {0, 1},    // north
+    {1, 1},    // north-east
+    {-1, 1},   // north-west
+    {-1, 0},   // west
+    {0, -1},   // south
+    {-1, -1},  // south-west
+    {1, -1},   // south-east
+}};
+
+namespace detail {
+
+constexpr chessboard step_mask(square_index sq, std::initializer_list<std::array<int, 2>> steps) {
+  chessboard result;
+  for (auto [df, dr] : steps) {
+    int f = static_cast<int>(file_of(sq)) + df;
+    int r = static_cast<int>(rank_of(sq)) + dr;
+    if (f >= 0 && f < 8 && r >= 0 && r < 8) {
+      result.set(File(f), Rank(r));
+    }
+  }
+  return result;
+}
+
+constexpr std::array<chessboard, 64> make_step_table(
+    std::initializer_list<std::array<int, 2>> steps) {
+  std::array<chessboard, 64> result{};
+  for (square_index sq = 0; sq < 64; ++sq) {
+    result[sq] = step_mask(sq, steps);
+  }
+  return result;
+}
+
+constexpr std::array<std::array<uint64_t, 64>, 8> make_rays() {
+  std::array<std::array<uint64_t, 64>, 8> result{};
+  for (size_t d = 0; d < directions.size(); ++d) {
+    for (square_index sq = 0; sq < 64; ++sq) {
+      int f = static_cast<int>(file_of(sq)) + directions[d][0];
+      int r = static_cast<int>(rank_of(sq)) + directions[d][1];
+      while (f >= 0 && f < 8 && r >= 0 && r < 8) {
+        result[d][sq] |= 1ULL << make_square(f, r);
+        f += directions[d][0];
+        r += directions[d][1];
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace detail
+
+// the tables are inline, so the program has one copy of them instead of one per translation unit
+
+inline constexpr auto knight_table = detail::make_step_table(
+    {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}});
+
+inline constexpr auto king_table = detail::make_step_table(
+    {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}});
+
+inline constexpr std::array<std::array<chessboard, 64>, 2> pawn_table = {
+    detail::make_step_table({{-1, 1}, {1, 1}}),
+    detail::make_step_table({{-1, -1}, {1, -1}}),
+};
+
+inline constexpr auto rays = detail::make_rays();
+
+/**
+ * Returns the squares attacked along the direction `d`, up to and including the first blocker.
+ */
+[[nodiscard]] constexpr uint64_t ray_attacks(size_t d, square_index sq, uint64_t occupied) {
+  uint64_t ray = rays[d][sq];
+  uint64_t blockers = ray & occupied;
+  if (blockers != 0) {
+    // for the first four directions the nearest blocker has the lowest index
+    auto blocker = d < 4 ? std::countr_zero(blockers) : 63 - std::countl_zero(blockers);
+    ray ^= rays[d][blocker];
+  }
+  return ray;
+}
+
+[[nodiscard]] constexpr uint64_t bishop_attacks(square_index sq, uint64_t occupied) {
+  return ray_attacks(2, sq, occupied) | ray_attacks(3, sq, occupied) |
+         ray_attacks(6, sq, occupied) | ray_attacks(7, sq, occupied);
+}
+
+[[nodiscard]] constexpr uint64_t rook_attacks(square_index sq, uint64_t occupied) {
+  return ray_attacks(0, sq, occupied) | ray_attacks(1, sq, occupied) |
+         ray_attacks(4, sq, occupied) | ray_attacks(5, sq, occupied);
+}
+
+}  // namespace attacks
+
+[[nodiscard]] constexpr chessboard pawn_attacks(color c, square_index sq) {
+  return attacks::pawn_table[c][sq];
+}
+
+[[nodiscard]] constexpr chessboard knight_attacks(square_index sq) {
+  return attacks::knight_table[sq];
+}
+
+[[nodiscard]] constexpr chessboard king_attacks(square_index sq) {
+  return attacks::king_table[sq];
+}
+
+[[nodiscard]] constexpr chessboard bishop_attacks(square_index sq, const chessboard& occupied) {
+  return chessboard(attacks::bishop_attacks(sq, occupied.to_ullong()));
+}
+
+[[nodiscard]] constexpr chessboard rook_attacks(square_index sq, const chessboard& occupied) {
+  return chessboard(attacks::rook_attacks(sq, occupied.to_ullong()));
+}
+
+[[nodiscard]] constexpr chessboard queen_attacks(square_index sq, const chessboard& occupied) {
+  return bishop_attacks(sq, occupied) | rook_attacks(sq, occupied);
+}
+
+}  // namespace slchess
@@ -0,0 +1,170 @@
+#include "bitbase.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <vector>
+
+#include "attacks.hpp"
+
+namespace slchess {
+
+namespace {
+
+/// The results are flags, so the results of all the moves from a position can be or-ed.
+enum kpk_result : uint8_t { invalid = 0, unknown = 1, draw = 2, win = 4 };
+
+constexpr size_t pawn_squares = 24;
+constexpr size_t position_count = 2 * pawn_squares * 64 * 64;
+
+size_t index(color side, square_index white_king, square_index black_king, square_index pawn) {
+  auto pawn_index = (rank_of(pawn) - 1) * 4 + file_of(pawn);
+  return ((side * pawn_squares + pawn_index) * 64 + white_king) * 64 + black_king;
+}
+
+uint64_t king_moves(square_index sq) {
+  return king_attacks(sq).word(0);
+}
+
+uint64_t pawn_captures(square_index sq) {
+  return pawn_attacks(white, sq).word(0);
+}
+
+uint64_t bit(square_index sq) {
+  return 1ULL << sq;
+}
+
+int distance(square_index a, square_index b) {
+  return std::max(std::abs(static_cast<int>(file_of(a)) - static_cast<int>(file_of(b))),
+                  std::abs(static_cast<int>(rank_of(a)) - static_cast<int>(rank_of(b))));
+}
+
+kpk_result initial_result(color side,
+                          square_index white_king,
+                          square_index black_king,
+                          square_index pawn) {
+  if (white_king == black_king || white_king == pawn || black_king == pawn ||
+      distance(white_king, black_king) <= 1) {
+    return invalid;
+  }
+  // black can't be in check when white moves
+  if (side == white && (pawn_captures(pawn) & bit(black_king)) != 0) {
+    return invalid;
+  }
+
+  if (side == white && rank_of(pawn) == 6) {
+    // the promotion wins when the new queen can't be taken at once
+    auto promotion = static_cast<square_index>(pawn + 8);
+    if (white_king != promotion &&
+        (distance(black_king, promotion) > 1 || distance(white_king, promotion) == 1)) {
+      return win;
+    }
+  }
+  if (side == black) {
+    auto escapes = king_moves(black_king) & ~(king_moves(white_king) | pawn_captures(pawn));
+    if (escapes == 0) {
+      return draw;
+    }
+    if ((king_moves(black_king) & ~king_moves(white_king) & bit(pawn)) != 0) {
+      return draw;
+    }
+  }
+  return unknown;
+}
+
+/**
+ * Returns the result of the position from the results of its moves: white needs one winning move
+ * to win, black needs one drawing move to draw.
+ */
+kpk_result classify(const std::vector<uint8_t>& results,
+                    color side,
+                    square_index white_king,
+                    square_index black_king,
+                    square_index pawn) {
+  uint8_t combined = invalid;
+  if (side == white) {
+    for (auto moves = king_moves(white_king); moves != 0; moves &= moves - 1) {
+      auto to = static_cast<square_index>(std::countr_zero(moves));
+      combined |= results[index(black, to, black_king, pawn)];
+    }
+    // the promotions are decided by the initial results
+    if (rank_of(pawn) < 6) {
+      auto push = static_cast<square_index>(pawn + 8);
+      combined |= results[index(black, white_king, black_king, push)];
+      if (rank_of(pawn) == 1 && push != white_king && push != black_king) {
+        combined |= results[index(black, white_king, black_king, push + 8)];
+      }
+    }
+  } else {
+    for (auto moves = king_moves(black_king); moves != 0; moves &= moves - 1) {
+      auto to = static_cast<square_index>(std::countr_zero(moves));
+      combined |= results[index(white, white_king, to, pawn)];
+    }
+  }
+
+  auto good = side == white ? win : draw;
+  auto bad = side == white ? draw : win;
+  if ((combined & good) != 0) {
+    return good;
+  }
+  return (combined & unknown) != 0 ? unknown : bad;
+}
+
+/// Calls `f(side, white king, black king, pawn)` for every position of the table.
+template <typename F>
+void for_each_position(F&& f) {
+  for (auto side : {white, black}) {
+    for (size_t rank = 1; rank < 7; ++rank) {
+      for (size_t file = 0; file < 4; ++file) {
+        auto pawn = make_square(file, rank);
+        for (square_index white_king = 0; white_king < 64; ++white_king) {
+          for (square_index black_king = 0; black_king < 64; ++black_king) {
+            f(side, white_king, black_king, pawn);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+kpk_bitbase::kpk_bitbase() {
+  std::vector<uint8_t> results(position_count);
+  for_each_position([&](color side, square_index wk, square_index bk, square_index pawn) {
+    results[index(side, wk, bk, pawn)] = initial_result(side, wk, bk, pawn);
+  });
+
+  // every pass decides the positions one move further from the known results
+  for (bool changed = true; changed;) {
+    changed = false;
+    for_each_position([&](color side, square_index wk, square_index bk, square_index pawn) {
+      auto& result = results[index(side, wk, bk, pawn)];
+      if (result == unknown) {
+        result = classify(results, side, wk, bk, pawn);
+        changed |= result != unknown;
+      }
+    });
+  }
+
+  for_each_position([&](color side, square_index wk, square_index bk, square_index pawn) {
+    if (results[index(side, wk, bk, pawn)] == win) {
+      wins[(side * pawn_squares + pawn_index(pawn)) * 64 + wk] |= bit(bk);
+    }
+  });
+}
+
+size_t kpk_bitbase::win_count() const {
+  size_t count = 0;
+  for (auto word : wins) {
+    count += static_cast<size_t>(std::popcount(word));
+  }
+  return count;
+}
+
+const kpk_bitbase& kpk() {
+  static const kpk_bitbase bitbase;
+  return bitbase;
+}
+
+}  // namespace slchess
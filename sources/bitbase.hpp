@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "chess.hpp"
+
+namespace slchess {
+
+/**
+ * The win/draw table of the king and pawn versus king endgame, for white as the side with the
+ * pawn.
+ *
+ * The table is generated by the retrograde analysis when it's created: every position starts as
+ * unknown, invalid, or with the result known at once (a safe promotion, a stalemate, a capture
+ * of the undefended pawn), and then the results are propagated back from the known positions,
+ * until nothing changes. The remaining unknown positions are draws.
+ *
+ * The pawns on the files e-h are mirrored to the files a-d, so there are 24 pawn squares. For
+ * every side to move, pawn square and white king square the table keeps a bitboard of the black
+ * king squares where white wins, so the whole table is 2 * 24 * 64 words, 24 KiB.
+ */
+class kpk_bitbase {
+ private:
+  static constexpr size_t pawn_squares = 24;
+
+  std::array<uint64_t, 2 * pawn_squares * 64> wins{};
+
+  [[nodiscard]] static constexpr size_t pawn_index(square_index pawn) {
+    return (rank_of(pawn) - 1) * 4 + file_of(pawn);
+  }
+
+ public:
+  /**
+   * Generates the table, which takes a few milliseconds.
+   */
+  kpk_bitbase();
+
+  /**
+   * Returns true if white wins.
+   *
+   * @param side_to_move Side to move.
+   * @param white_king Square of the white king.
+   * @param pawn Square of the white pawn, on the ranks 2 to 7.
+   * @param black_king Square of the black king.
+   */
+  [[nodiscard]] bool is_win(color side_to_move,
+                            square_index white_king,
+                            square_index pawn,
+                            square_index black_king) const {
+    if (file_of(pawn) >= 4) {
+      white_king ^= 7;
+      pawn ^= 7;
+      black_king ^= 7;
+    }
+    return (wins[(side_to_move * pawn_squares + pawn_index(pawn)) * 64 + white_king] >>
+            black_king) &
+           1;
+  }
+
+  /**
+   * Returns the number of the positions won by white.
+   */
+  [[nodiscard]] size_t win_count() const;
+};
+
+/**
+ * Returns the table shared by the whole program, generated by the first call.
+ */
+[[nodiscard]] const kpk_bitbase& kpk();
+
+}  // namespace slchess
@@ -1 +1,8 @@
-#include "bitboard.hpp"
\ No newline at end of file
+#include "bitboard.hpp"
+
+namespace slchess {
+
+template class bitboard<8, 8, true>;
+template class bitboard<8, 8, false>;
+
+}  // namespace slchess
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <bitset>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cstdint>
 #include <cstdio>
@@ -10,8 +11,11 @@
 #include <iostream>
 #include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
+#include "stats.hpp"
+
 namespace slchess {
 
 /**
@@ -32,8 +36,8 @@ class File {
   /**
    * Explicit constructor.
    */
-  explicit File(size_t value) : value(value){};
-  [[nodiscard]] operator size_t() const { return value; }
+  constexpr explicit File(size_t value) : value(value){};
+  [[nodiscard]] constexpr operator size_t() const { return value; }
 };
 
 /**
@@ -42,7 +46,9 @@ class File {
  * @param n File value.
  * @return A new File object.
  */
-File operator"" _f(unsigned long long int n) { return File(n); }
+[[nodiscard]] constexpr File operator"" _f(unsigned long long int n) {
+  return File(n);
+}
 
 
 /**
@@ -60,28 +66,73 @@ class Rank {
   size_t value;  ///< Rank value
 
  public:
-  explicit Rank(size_t value) : value(value){};
-  [[nodiscard]] operator size_t() const { return value; }
+  constexpr explicit Rank(size_t value) : value(value){};
+  [[nodiscard]] constexpr operator size_t() const { return value; }
 };
 
-Rank operator"" _r(unsigned long long int n) { return Rank(n); }
+[[nodiscard]] constexpr Rank operator"" _r(unsigned long long int n) {
+  return Rank(n);
+}
 
 /**
  * Class for a field coordinates.
+ *
+ * The square is a single byte: the index `rank * 16 + file` on a 16x16 grid, so it can be copied,
+ * assigned, compared and stored in the tables like a plain number. The squares of the boards up
+ * to 16x16 fit in it, the larger boards are accessed with the (File, Rank) pairs.
+ *
+ * The index doesn't depend on the board size, so it's not the `rank * 8 + file` square index of
+ * the chess engine (`square_index`, see chess.hpp) even for the 8x8 boards. Convert between them
+ * through the `file()` and the `rank()`.
  */
 class Square {
+ private:
+  uint8_t index_ = 0;
+
  public:
-  const File file;  ///< Square file
-  const Rank rank;  ///< Square rank
+  static constexpr size_t max_files = 16;
+  static constexpr size_t max_ranks = 16;
+
+  constexpr Square() = default;
 
-  /// An explicit constructor for the class.
-  explicit Square(File file, Rank rank) : file(file), rank(rank) {}
+  /**
+   * An explicit constructor for the class.
+   *
+   * @throws std::out_of_range when the file or the rank doesn't fit in the 16x16 grid, in the
+   *   constant expressions it's a compilation error.
+   */
+  constexpr explicit Square(File file, Rank rank) {
+    if (file >= max_files) {
+      throw std::out_of_range("Square file is too large.");
+    }
+    if (rank >= max_ranks) {
+      throw std::out_of_range("Square rank is too large.");
+    }
+    index_ = static_cast<uint8_t>(rank * max_files + file);
+  }
+
+  /**
+   * Returns the square with the given `rank * 16 + file` index.
+   */
+  [[nodiscard]] static constexpr Square from_index(uint8_t index) {
+    Square square;
+    square.index_ = index;
+    return square;
+  }
+
+  [[nodiscard]] constexpr uint8_t index() const { return index_; }
+
+  [[nodiscard]] constexpr File file() const { return File(index_ % max_files); }
+
+  [[nodiscard]] constexpr Rank rank() const { return Rank(index_ / max_files); }
 
   /// An implicit operator for converting to the File object.
-  [[nodiscard]] operator File() const { return file; }
+  [[nodiscard]] constexpr operator File() const { return file(); }
 
   /// An implicit operator for converting to the Rank object.
-  [[nodiscard]] operator Rank() const { return rank; }
+  [[nodiscard]] constexpr operator Rank() const { return rank(); }
+
+  [[nodiscard]] constexpr bool operator==(const Square&) const = default;
 };
 
 /**
@@ -101,7 +152,9 @@ class Square {
  * @param rank Rank for the square.
  * @return New Square object for the
  */
-Square operator,(File file, Rank rank) { return Square(file, rank); }
+[[nodiscard]] constexpr Square operator,(File file, Rank rank) {
+  return Square(file, rank);
+}
 
 /**
  * A function for calculating the position in an array for the (file, rank) coordinates.
@@ -120,8 +173,14 @@ Square operator,(File file, Rank rank) { return Square(file, rank); }
  *
  * The main idea is to have a bit for each board field.
  *
- * This implementation is based on the std::bitboard. As a result the memory used for storing an MxN
- * bitboard is MxN rounded to the smallest multiple of `sizeof(unsigned long)`.
+ * The bits are stored in an array of the 64 bit words, so the memory used for storing an MxN
+ * bitboard is MxN rounded up to the multiple of 64 bits. The bit `n` is the bit `n % 64` of
+ * the word `n / 64`. The bits above the `size()` are kept zero by all the operations of the
+ * range checked bitboard. Without the range checks `set` and `reset` write a coordinate past
+ * the `size()` as it is, so such a bit stays set until it's reset, see `capacity()`.
+ *
+ * The whole API is `constexpr`, so the masks and the attack tables can be built at compile time.
+ * The range errors are exceptions, which in a constant expression means a compilation error.
  *
  * The API is heavily inspired by the bitset
  * https://www.cplusplus.com/reference/bitset/bitset/
@@ -144,7 +203,13 @@ Square operator,(File file, Rank rank) { return Square(file, rank); }
 template <size_t files_, size_t ranks_, bool always_check_range_ = true>
 class bitboard {
  private:
-  std::bitset<files_ * ranks_> fields;
+  static constexpr size_t bits = files_ * ranks_;
+  static constexpr size_t word_count = (bits + 63) / 64;
+
+  /// Mask of the bits used in the last word.
+  static constexpr uint64_t last_word_mask = bits % 64 == 0 ? ~0ULL : (1ULL << (bits % 64)) - 1;
+
+  std::array<uint64_t, word_count> fields{};
 
   /**
    * A helper function to calculate the array index for the (file, rank) field.
@@ -156,25 +221,44 @@ class bitboard {
    * @param rank square rank to get the position for.
    * @return Array index for the square(file, rank).
    */
-  [[nodiscard]] size_t make_index(File file, Rank rank) const noexcept(!always_check_range_) {
+  [[nodiscard]] constexpr size_t make_index(File file, Rank rank) const
+      noexcept(!always_check_range_) {
     auto pos = coordinates_to_index(file, rank, files_);
 
     if constexpr (always_check_range_) {
       assert_field_coordinates(file, rank);
+    } else if constexpr (stats::enabled) {
+      if (file >= files_ || rank >= ranks_) {
+        stats::add(stat_counter::range_check_failures);
+      }
     }
 
     return pos;
   }
 
-  void assert_field_coordinates(File file, Rank rank) const {
+  constexpr void assert_field_coordinates(File file, Rank rank) const {
     if (file >= files_) {
+      stats::add(stat_counter::range_check_failures);
       throw std::out_of_range("Requested file is too large.");
     }
     if (rank >= ranks_) {
+      stats::add(stat_counter::range_check_failures);
       throw std::out_of_range("Requested rank is too large.");
     }
   }
 
+  [[nodiscard]] constexpr bool bit(size_t index) const {
+    return (fields[index / 64] >> (index % 64)) & 1;
+  }
+
+  constexpr void assign_bit(size_t index, bool value) {
+    auto mask = 1ULL << (index % 64);
+    fields[index / 64] = value ? fields[index / 64] | mask : fields[index / 64] & ~mask;
+  }
+
+  /// Clears the bits above the `size()`.
+  constexpr void sanitize() { fields[word_count - 1] &= last_word_mask; }
+
  protected:
   /**
    * This is a little bit dangerous function. It returns a reference to the internal fields
@@ -184,21 +268,24 @@ class bitboard {
    * appropriate bits. To use it, create a class inheriting from the `bitboard` and then you will
    * have the access to the function.
    */
-  [[maybe_unused]] auto get_fields() { return &fields; }
+  [[maybe_unused]] constexpr auto get_fields() { return &fields; }
 
  public:
-  bitboard() = default;
-  ~bitboard() = default;
+  constexpr bitboard() = default;
+  constexpr ~bitboard() = default;
 
   /**
    * Constructor converting an unsigned variable to the bitboard.
    *
-   * The number is treated as a stream of bits, which are inserted into the underlying bitset
-   * one by one. Only the `files_ * ranks_` bits are used from the number.
+   * The number is treated as a stream of bits, which are inserted into the first word one by
+   * one. Only the `files_ * ranks_` bits are used from the number.
    *
    * @param value Value to convert to the bitboard.
    */
-  constexpr bitboard(unsigned long long value) noexcept : fields(value) {}
+  constexpr bitboard(unsigned long long value) noexcept {
+    fields[0] = value;
+    sanitize();
+  }
 
   /**
    * Returns the number of the ranks of the bitboard.
@@ -218,31 +305,29 @@ class bitboard {
   /**
    * Returns the number of bits available for the whole board. Basically it's ranks_ * files_.
    */
-  [[nodiscard]] size_t size() const { return fields.size(); }
+  [[nodiscard]] constexpr size_t size() const { return bits; }
 
   /**
    * Returns theoretical maximum number of bits available for the allocated memory.
    *
-   * Currently the implementation is using the std::bitset, which uses an array of `unsigned long`
-   * (the size on my machine is 8B) for the internal bits representation.
-   * For bitset<4> it will use whole `unsigned long` variable. This way the `size()=4` but the
-   * `capacity()=64`. As the size of the `std::bitset` is exactly the size of the internal array,
-   * I can just use `sizeof(std::bitset<4>) * 8` to get the number of available bits.
+   * The bits are stored in the 64 bit words, so for bitboard<2, 3> it will use the whole word.
+   * This way the `size()=6` but the `capacity()=64`.
    *
    * This is extremely useful for testing the bitboard with `always_check_range_=false`.
    * When I have e.g. `bitboard<3,3>` with just 9 bits, there are 8 bytes allocated, so I can set
    * any bit in the range of 0 to 63 and it's memory safe as it won't change any other variable
    * in the memory.
    */
-  [[nodiscard]] size_t capacity() const { return sizeof(fields) * 8; }
+  [[nodiscard]] constexpr size_t capacity() const { return sizeof(fields) * 8; }
 
   /**
    * Sets all the fields of the bitboard to true.
    *
    * @return
    */
-  bitboard& set() noexcept {
-    fields.set();
+  constexpr bitboard& set() noexcept {
+    fields.fill(~0ULL);
+    sanitize();
     return *this;
   }
 
@@ -254,9 +339,8 @@ class bitboard {
    * @param value The value to set
    * @return Reference to the bitboard object.
    */
-  bitboard& set(File file, Rank rank, bool value = true) noexcept(!always_check_range_) {
-    auto index = make_index(file, rank);
-    fields[index] = value;
+  constexpr bitboard& set(File file, Rank rank, bool value = true) noexcept(!always_check_range_) {
+    assign_bit(make_index(file, rank), value);
     return *this;
   }
 
@@ -267,8 +351,8 @@ class bitboard {
    * @param value The value to set
    * @return Reference to the bitboard object.
    */
-  bitboard& set(Square square, bool value = true) noexcept(!always_check_range_) {
-    return set(square, square, value);
+  constexpr bitboard& set(Square square, bool value = true) noexcept(!always_check_range_) {
+    return set(square.file(), square.rank(), value);
   }
 
   /**
@@ -276,8 +360,8 @@ class bitboard {
    *
    * @return Reference to the bitboard object.
    */
-  bitboard& reset() noexcept {
-    fields.reset();
+  constexpr bitboard& reset() noexcept {
+    fields.fill(0);
     return *this;
   }
 
@@ -288,9 +372,8 @@ class bitboard {
    * @param rank  Field rank to set to the required value.
    * @return Reference to the bitboard object.
    */
-  bitboard& reset(File file, Rank rank) noexcept(!always_check_range_) {
-    auto index = make_index(file, rank);
-    fields[index] = false;
+  constexpr bitboard& reset(File file, Rank rank) noexcept(!always_check_range_) {
+    assign_bit(make_index(file, rank), false);
     return *this;
   }
 
@@ -301,7 +384,9 @@ class bitboard {
    * @param value The value to set
    * @return Reference to the bitboard object.
    */
-  bitboard& reset(Square square) noexcept(!always_check_range_) { return reset(square, square); }
+  constexpr bitboard& reset(Square square) noexcept(!always_check_range_) {
+    return reset(square.file(), square.rank());
+  }
 
   /**
    * Gets the value of the given field.
@@ -310,9 +395,8 @@ class bitboard {
    * @param rank  Field rank to set to the required value.
    * @return Value for the field.
    */
-  [[nodiscard]] bool get(File file, Rank rank) const noexcept(!always_check_range_) {
-    auto index = make_index(file, rank);
-    return fields[index];
+  [[nodiscard]] constexpr bool get(File file, Rank rank) const noexcept(!always_check_range_) {
+    return bit(make_index(file, rank));
   }
 
   /**
@@ -321,8 +405,8 @@ class bitboard {
    * @param square Square to set to the required value.
    * @return Value for the field.
    */
-  [[nodiscard]] bool get(Square square) const noexcept(!always_check_range_) {
-    return get(square, square);
+  [[nodiscard]] constexpr bool get(Square square) const noexcept(!always_check_range_) {
+    return get(square.file(), square.rank());
   }
   /**
    * This is the only function here, which always checks the coordinates range,
@@ -332,16 +416,18 @@ class bitboard {
    * @param rank
    * @return
    */
-  [[nodiscard]] bool test(File file, Rank rank) const {
+  [[nodiscard]] constexpr bool test(File file, Rank rank) const {
     auto pos = coordinates_to_index(file, rank, files_);
     assert_field_coordinates(file, rank);
-    return fields[pos];
+    return bit(pos);
   }
 
   /**
    * @see{test}
    */
-  [[nodiscard]] bool test(Square square) const { return test(square, square); }
+  [[nodiscard]] constexpr bool test(Square square) const {
+    return test(square.file(), square.rank());
+  }
 
   /**
    * Class to support [][] operator for the bitboard.
@@ -352,83 +438,270 @@ class bitboard {
     File file;
 
    public:
-    Proxy(bitboard& bitboard, File file) : bb(bitboard), file(file) {}
-    bool operator[](Rank rank) const { return bb.get(file, rank); };
+    constexpr Proxy(bitboard& bitboard, File file) : bb(bitboard), file(file) {}
+    constexpr bool operator[](Rank rank) const { return bb.get(file, rank); };
   };
 
   /**
    * Operator for the double [][] to access the board fields.
    */
-  Proxy operator[](File file) { return Proxy(*this, file); }
+  constexpr Proxy operator[](File file) { return Proxy(*this, file); }
 
   /**
    * Converts the bitboard bits to the unsigned long long.
+   *
+   * @throws std::overflow_error when any bit above the 64th is set, like `std::bitset`.
    */
-  [[nodiscard]] unsigned long long to_ullong() const noexcept { return fields.to_ullong(); }
+  [[nodiscard]] constexpr unsigned long long to_ullong() const {
+    for (size_t n = 1; n < word_count; ++n) {
+      if (fields[n] != 0) {
+        throw std::overflow_error("The bitboard doesn't fit in unsigned long long.");
+      }
+    }
+    return fields[0];
+  }
 
   /**
    * Operator for converting the bitboard bits to the unsigned long long.
    */
-  [[nodiscard]] explicit operator unsigned long long() const noexcept { return to_ullong(); }
+  [[nodiscard]] constexpr explicit operator unsigned long long() const { return to_ullong(); }
 
   /**
    * Operator for converting the bitboard bits to the unsigned long.
    */
-  [[nodiscard]] explicit operator unsigned long() const noexcept { return to_ullong(); }
+  [[nodiscard]] constexpr explicit operator unsigned long() const { return to_ulong(); }
 
   /**
    * Converts the bitboard bits to the unsigned long.
    */
-  [[nodiscard]] unsigned long to_ulong() const noexcept { return fields.to_ulong(); }
+  [[nodiscard]] constexpr unsigned long to_ulong() const {
+    static_assert(sizeof(unsigned long) == sizeof(uint64_t), "unsigned long must be 64 bit.");
+    return to_ullong();
+  }
 
-  /*
+  /**
+   * Returns the number of the 64 bit words needed to store all the bits of the bitboard.
+   *
+   * This is the unit the bulk kernels (e.g. `bitboard_batch`) work with.
+   */
+  [[nodiscard]] static constexpr size_t words() { return word_count; }
 
-   convert one bitboard to another
+  /**
+   * Returns the given 64 bit word of the bitboard.
+   *
+   * Word `n` keeps the bits `[n * 64, n * 64 + 63]`, the lowest bit is the lowest index.
+   * The bits above the `size()` are always zero.
+   *
+   * @param n Word number, must be lower than `words()`.
+   * @return Value of the word.
+   */
+  [[nodiscard]] constexpr uint64_t word(size_t n) const noexcept { return fields[n]; }
 
-   add a nice to_board_string
+  /**
+   * Sets the given 64 bit word of the bitboard.
+   *
+   * The bits which don't fit in the bitboard are silently dropped.
+   *
+   * @param n Word number, must be lower than `words()`.
+   * @param value Value to set.
+   * @return Reference to the bitboard object.
+   */
+  constexpr bitboard& set_word(size_t n, uint64_t value) noexcept {
+    fields[n] = n == word_count - 1 ? value & last_word_mask : value;
+    return *this;
+  }
 
+  /**
+   * Returns the number of the set fields.
    */
+  [[nodiscard]] constexpr size_t count() const noexcept {
+    size_t result = 0;
+    for (auto word : fields) {
+      result += static_cast<size_t>(std::popcount(word));
+    }
+    return result;
+  }
 
-  /*
-bitset& operator&= (const bitset& rhs) noexcept;
-bitset& operator|= (const bitset& rhs) noexcept;
-bitset& operator^= (const bitset& rhs) noexcept;
-bitset& operator<<= (size_t pos) noexcept;
-bitset& operator>>= (size_t pos) noexcept;
-bitset operator~() const noexcept;
-bitset operator<<(size_t pos) const noexcept;
-bitset operator>>(size_t pos) const noexcept;
-bool operator== (const bitset& rhs) const noexcept;
-bool operator!= (const bitset& rhs) const noexcept;
+  constexpr bitboard& operator&=(const bitboard& rhs) noexcept {
+    for (size_t n = 0; n < word_count; ++n) {
+      fields[n] &= rhs.fields[n];
+    }
+    return *this;
+  }
 
-template<size_t N>
-  bitset<N> operator& (const bitset<N>& lhs, const bitset<N>& rhs) noexcept;
-template<size_t N>
-  bitset<N> operator| (const bitset<N>& lhs, const bitset<N>& rhs) noexcept;
-template<size_t N>
-  bitset<N> operator^ (const bitset<N>& lhs, const bitset<N>& rhs) noexcept;
+  constexpr bitboard& operator|=(const bitboard& rhs) noexcept {
+    for (size_t n = 0; n < word_count; ++n) {
+      fields[n] |= rhs.fields[n];
+    }
+    return *this;
+  }
 
-template<class charT, class traits, size_t N>
-  basic_istream<charT, traits>&
-    operator>> (basic_istream<charT,traits>& is, bitset<N>& rhs);
-template<class charT, class traits, size_t N>
-  basic_ostream<charT, traits>&
-    operator<< (basic_ostream<charT,traits>& os, const bitset<N>& rhs);
+  constexpr bitboard& operator^=(const bitboard& rhs) noexcept {
+    for (size_t n = 0; n < word_count; ++n) {
+      fields[n] ^= rhs.fields[n];
+    }
+    return *this;
+  }
+
+  /**
+   * Shifts all the bits towards the higher indices, the bits moved outside the board are lost.
+   *
+   * As the index is `rank * files_ + file`, shifting by `files_` moves everything one rank up.
+   * Shifting by 1 moves everything one file right, wrapping the last file to the next rank.
+   */
+  constexpr bitboard& operator<<=(size_t pos) noexcept {
+    if (pos >= bits) {
+      return reset();
+    }
+    if constexpr (word_count == 1) {
+      fields[0] <<= pos;
+    } else {
+      auto word_shift = pos / 64;
+      auto bit_shift = pos % 64;
+      for (size_t n = word_count; n-- > 0;) {
+        uint64_t value = 0;
+        if (n >= word_shift) {
+          value = fields[n - word_shift] << bit_shift;
+          if (bit_shift != 0 && n > word_shift) {
+            value |= fields[n - word_shift - 1] >> (64 - bit_shift);
+          }
+        }
+        fields[n] = value;
+      }
+    }
+    sanitize();
+    return *this;
+  }
+
+  /**
+   * Shifts all the bits towards the lower indices, the bits moved outside the board are lost.
    */
+  constexpr bitboard& operator>>=(size_t pos) noexcept {
+    if (pos >= bits) {
+      return reset();
+    }
+    if constexpr (word_count == 1) {
+      fields[0] >>= pos;
+    } else {
+      auto word_shift = pos / 64;
+      auto bit_shift = pos % 64;
+      for (size_t n = 0; n < word_count; ++n) {
+        uint64_t value = 0;
+        if (n + word_shift < word_count) {
+          value = fields[n + word_shift] >> bit_shift;
+          if (bit_shift != 0 && n + word_shift + 1 < word_count) {
+            value |= fields[n + word_shift + 1] << (64 - bit_shift);
+          }
+        }
+        fields[n] = value;
+      }
+    }
+    return *this;
+  }
+
+  [[nodiscard]] constexpr bitboard operator~() const noexcept { return bitboard(*this).flip(); }
+
+  [[nodiscard]] constexpr bitboard operator<<(size_t pos) const noexcept {
+    return bitboard(*this) <<= pos;
+  }
+
+  [[nodiscard]] constexpr bitboard operator>>(size_t pos) const noexcept {
+    return bitboard(*this) >>= pos;
+  }
+
+  [[nodiscard]] constexpr bool operator==(const bitboard& rhs) const noexcept {
+    return fields == rhs.fields;
+  }
+
+  [[nodiscard]] constexpr bool operator!=(const bitboard& rhs) const noexcept {
+    return fields != rhs.fields;
+  }
+
+  [[nodiscard]] friend constexpr bitboard operator&(const bitboard& lhs,
+                                                    const bitboard& rhs) noexcept {
+    return bitboard(lhs) &= rhs;
+  }
+
+  [[nodiscard]] friend constexpr bitboard operator|(const bitboard& lhs,
+                                                    const bitboard& rhs) noexcept {
+    return bitboard(lhs) |= rhs;
+  }
+
+  [[nodiscard]] friend constexpr bitboard operator^(const bitboard& lhs,
+                                                    const bitboard& rhs) noexcept {
+    return bitboard(lhs) ^= rhs;
+  }
+
+  /**
+   * Flips all the fields.
+   *
+   * @return Reference to the bitboard object.
+   */
+  constexpr bitboard& flip() noexcept {
+    for (auto& word : fields) {
+      word = ~word;
+    }
+    sanitize();
+    return *this;
+  }
 
   /**
    * Converts the bitboard to a string.
    *
-   * Internally it uses directly the `std::bitset::to_string`.
+   * The fields are written like by `std::bitset::to_string`: the highest index first.
    *
    * @param empty_character Character to be used when a field is empty.
    * @param set_character Character to be used when a field is set.
    * @return String with bitboard representation.
    */
-  [[nodiscard]] std::string to_string(char empty_character = '-',
-                                      char set_character = 'x') const noexcept {
-    std::basic_string x = fields.to_string(empty_character, set_character);
-    return x;
+  [[nodiscard]] constexpr std::string to_string(char empty_character = '-',
+                                                char set_character = 'x') const {
+    std::string result(bits, empty_character);
+    for (size_t n = 0; n < bits; ++n) {
+      if (bit(n)) {
+        result[bits - 1 - n] = set_character;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Returns the length of the `to_board_string` text: a line of `files_` characters and the new
+   * line for every rank.
+   */
+  [[nodiscard]] static constexpr size_t board_string_size() { return (files_ + 1) * ranks_; }
+
+  /**
+   * Writes the `to_board_string` text to the buffer, without allocating.
+   *
+   * @param out Buffer for at least `board_string_size()` characters.
+   * @return Pointer past the last written character.
+   */
+  constexpr char* write_board_string(char* out,
+                                     char empty_character = '-',
+                                     char set_character = 'x') const noexcept {
+    for (size_t rank = ranks_; rank-- > 0;) {
+      for (size_t file = 0; file < files_; ++file) {
+        *out++ = bit(rank * files_ + file) ? set_character : empty_character;
+      }
+      *out++ = '\n';
+    }
+    return out;
+  }
+
+  /**
+   * Converts the bitboard to a string drawn like a board: a line for every rank, the highest rank
+   * first, and the files from the lowest one in every line.
+   *
+   * @param empty_character Character to be used when a field is empty.
+   * @param set_character Character to be used when a field is set.
+   * @return String with a line for every rank, each ending with the new line.
+   */
+  [[nodiscard]] constexpr std::string to_board_string(char empty_character = '-',
+                                                      char set_character = 'x') const {
+    std::string result(board_string_size(), empty_character);
+    write_board_string(result.data(), empty_character, set_character);
+    return result;
   }
 
   /**
@@ -436,21 +709,40 @@ template<class charT, class traits, size_t N>
    *
    * @return True if all fields are set, false otherwise.
    */
-  [[nodiscard]] bool all() const noexcept { return fields.all(); }
+  [[nodiscard]] constexpr bool all() const noexcept {
+    for (size_t n = 0; n + 1 < word_count; ++n) {
+      if (fields[n] != ~0ULL) {
+        return false;
+      }
+    }
+    return (fields[word_count - 1] & last_word_mask) == last_word_mask;
+  }
 
   /**
    * Returns true if any of the fields are set.
    *
    * @return True if any of the fields are set, false otherwise.
    */
-  [[nodiscard]] bool none() const noexcept { return fields.none(); }
+  [[nodiscard]] constexpr bool none() const noexcept { return !any(); }
 
   /**
    * Returns true if none of the fields are set.
    *
    * @return True if none of the fields are set, false otherwise.
    */
-  [[nodiscard]] bool any() const noexcept { return fields.any(); }
+  [[nodiscard]] constexpr bool any() const noexcept {
+    for (auto word : fields) {
+      if (word != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
 };
 
+// The chess board shapes are instantiated once in bitboard.cpp, instead of in every translation
+// unit. The member functions are defined in the class, so they still can be inlined.
+extern template class bitboard<8, 8, true>;
+extern template class bitboard<8, 8, false>;
+
 }  // namespace slchess
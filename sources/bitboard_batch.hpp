@@ -0,0 +1,489 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "bitboard.hpp"
+
+namespace slchess {
+
+/**
+ * Minimal allocator returning memory aligned to the `alignment_` bytes.
+ *
+ * Used for the `bitboard_batch` planes, so the vector kernels can always use aligned loads.
+ */
+template <typename T, size_t alignment_>
+struct aligned_allocator {
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = aligned_allocator<U, alignment_>;
+  };
+
+  aligned_allocator() = default;
+
+  template <typename U>
+  constexpr aligned_allocator(const aligned_allocator<U, alignment_>& /*unused*/) noexcept {}
+
+  [[nodiscard]] T* allocate(size_t n) {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment_)));
+  }
+
+  void deallocate(T* p, size_t /*unused*/) noexcept {
+    ::operator delete(p, std::align_val_t(alignment_));
+  }
+
+  template <typename U>
+  bool operator==(const aligned_allocator<U, alignment_>& /*unused*/) const noexcept {
+    return true;
+  }
+};
+
+/**
+ * A container for a large number of bitboards of the same shape.
+ *
+ * The bitboards are stored in the structure-of-arrays layout: the bitboard of `files_ * ranks_`
+ * bits is split into `words()` 64 bit words and each word number has its own plane. The plane `w`
+ * keeps the word `w` of all the bitboards, one after another. This way an operation on a word of
+ * consecutive bitboards is an operation on consecutive memory, and a 256 bit register processes
+ * 4 bitboards at once (8 with 512 bit registers).
+ *
+ * When compiled with AVX2 enabled (e.g. `-mavx2` or `-march=native` in `COMPILER_FLAGS`) the
+ * kernels use the AVX2 intrinsics, otherwise they are plain loops which the compiler may
+ * vectorize on its own. The results are the same as calling the matching `bitboard` operators
+ * one bitboard at a time.
+ *
+ * The planes are padded to the multiple of `lane_block()` bitboards, the padding is always zero.
+ *
+ * @tparam files_ Number of the files for the bitboards.
+ * @tparam ranks_ Number of the ranks for the bitboards.
+ */
+template <size_t files_, size_t ranks_>
+class bitboard_batch {
+ public:
+  /**
+   * Returns the number of bitboards processed in one block, the planes are padded to it.
+   */
+  [[nodiscard]] static constexpr size_t lane_block() { return 8; }
+
+  /**
+   * Returns the number of the 64 bit words (so also planes) used for one bitboard.
+   */
+  [[nodiscard]] static constexpr size_t words() { return (files_ * ranks_ + 63) / 64; }
+
+ private:
+  static constexpr size_t bits = files_ * ranks_;
+
+  /// Mask of the bits used in the last word of a bitboard.
+  static constexpr uint64_t last_word_mask = bits % 64 == 0 ? ~0ULL : (1ULL << (bits % 64)) - 1;
+
+  size_t count_ = 0;   ///< Number of bitboards.
+  size_t stride_ = 0;  ///< Number of elements in one plane (count_ rounded up to lane_block()).
+
+  std::vector<uint64_t, aligned_allocator<uint64_t, 64>> planes;
+
+  [[nodiscard]] uint64_t* plane_data(size_t w) noexcept { return planes.data() + w * stride_; }
+
+  [[nodiscard]] const uint64_t* plane_data(size_t w) const noexcept {
+    return planes.data() + w * stride_;
+  }
+
+  void assert_same_size(const bitboard_batch& other) const {
+    if (other.count_ != count_) {
+      throw std::invalid_argument("Batches have different sizes.");
+    }
+  }
+
+  void assert_index(size_t n) const {
+    if (n >= count_) {
+      throw std::out_of_range("Requested bitboard is out of the batch range.");
+    }
+  }
+
+  enum class binary_op { op_and, op_or, op_xor, op_andnot };
+
+  template <binary_op op_>
+  [[nodiscard]] static uint64_t apply(uint64_t a, uint64_t b) noexcept {
+    if constexpr (op_ == binary_op::op_and) {
+      return a & b;
+    } else if constexpr (op_ == binary_op::op_or) {
+      return a | b;
+    } else if constexpr (op_ == binary_op::op_xor) {
+      return a ^ b;
+    } else {
+      return a & ~b;
+    }
+  }
+
+#if defined(__AVX2__)
+  template <binary_op op_>
+  [[nodiscard]] static __m256i apply(__m256i a, __m256i b) noexcept {
+    if constexpr (op_ == binary_op::op_and) {
+      return _mm256_and_si256(a, b);
+    } else if constexpr (op_ == binary_op::op_or) {
+      return _mm256_or_si256(a, b);
+    } else if constexpr (op_ == binary_op::op_xor) {
+      return _mm256_xor_si256(a, b);
+    } else {
+      // _mm256_andnot_si256 negates the first argument
+      return _mm256_andnot_si256(b, a);
+    }
+  }
+
+  /**
+   * Popcount of each of the four 64 bit lanes, using the nibble lookup table (Mula's algorithm).
+   */
+  [[nodiscard]] static __m256i popcount_lanes(__m256i v) noexcept {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, low_mask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    __m256i cnt =
+        _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+  }
+#endif
+
+  /**
+   * The kernel for all the binary operations: `dst[i] = op(dst[i], src[i])` for `n` words.
+   */
+  template <binary_op op_>
+  static void binary_kernel(uint64_t* dst, const uint64_t* src, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= n; i += 4) {
+      auto a = _mm256_load_si256(reinterpret_cast<const __m256i*>(dst + i));
+      auto b = _mm256_load_si256(reinterpret_cast<const __m256i*>(src + i));
+      _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), apply<op_>(a, b));
+    }
+#endif
+    for (; i < n; ++i) {
+      dst[i] = apply<op_>(dst[i], src[i]);
+    }
+  }
+
+  /**
+   * The kernel for the binary operations with the same word for all the bitboards.
+   */
+  template <binary_op op_>
+  static void broadcast_kernel(uint64_t* __restrict dst, uint64_t value, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    auto b = _mm256_set1_epi64x(static_cast<long long>(value));
+    for (; i + 4 <= n; i += 4) {
+      auto a = _mm256_load_si256(reinterpret_cast<const __m256i*>(dst + i));
+      _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), apply<op_>(a, b));
+    }
+#endif
+    for (; i < n; ++i) {
+      dst[i] = apply<op_>(dst[i], value);
+    }
+  }
+
+  template <binary_op op_>
+  bitboard_batch& apply_batch(const bitboard_batch& rhs) {
+    assert_same_size(rhs);
+    binary_kernel<op_>(planes.data(), rhs.planes.data(), planes.size());
+    return *this;
+  }
+
+  template <binary_op op_, bool always_check_range_>
+  bitboard_batch& apply_broadcast(const bitboard<files_, ranks_, always_check_range_>& rhs) {
+    for (size_t w = 0; w < words(); ++w) {
+      // the padding must stay zero, so it's not touched here
+      broadcast_kernel<op_>(plane_data(w), rhs.word(w), count_);
+    }
+    return *this;
+  }
+
+  /**
+   * The kernel for the shifts, for the left shift: `dst[i] = main[i] << s | carry[i] >> (64 - s)`.
+   *
+   * The `carry` plane keeps the neighbouring words which bits are moved into `main`, it can be
+   * `nullptr` when there is no such word. `dst` may be the same plane as `main`.
+   */
+  static void shift_kernel(uint64_t* dst,
+                           const uint64_t* main,
+                           const uint64_t* carry,
+                           size_t bit_shift,
+                           bool left,
+                           size_t n) {
+    if (bit_shift == 0) {
+      for (size_t i = 0; i < n; ++i) {
+        dst[i] = main[i];
+      }
+      return;
+    }
+    size_t carry_shift = 64 - bit_shift;
+    size_t i = 0;
+#if defined(__AVX2__)
+    auto main_count = _mm_cvtsi64_si128(static_cast<long long>(bit_shift));
+    auto carry_count = _mm_cvtsi64_si128(static_cast<long long>(carry_shift));
+    for (; i + 4 <= n; i += 4) {
+      auto m = _mm256_load_si256(reinterpret_cast<const __m256i*>(main + i));
+      auto c = carry != nullptr ? _mm256_load_si256(reinterpret_cast<const __m256i*>(carry + i))
+                                : _mm256_setzero_si256();
+      __m256i r = left ? _mm256_or_si256(_mm256_sll_epi64(m, main_count),
+                                         _mm256_srl_epi64(c, carry_count))
+                       : _mm256_or_si256(_mm256_srl_epi64(m, main_count),
+                                         _mm256_sll_epi64(c, carry_count));
+      _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), r);
+    }
+#endif
+    for (; i < n; ++i) {
+      uint64_t c = carry != nullptr ? carry[i] : 0;
+      dst[i] = left ? (main[i] << bit_shift) | (c >> carry_shift)
+                    : (main[i] >> bit_shift) | (c << carry_shift);
+    }
+  }
+
+  void clear_plane(size_t w) noexcept {
+    auto* p = plane_data(w);
+    for (size_t i = 0; i < stride_; ++i) {
+      p[i] = 0;
+    }
+  }
+
+  void mask_last_plane() noexcept {
+    if constexpr (last_word_mask != ~0ULL) {
+      broadcast_kernel<binary_op::op_and>(plane_data(words() - 1), last_word_mask, stride_);
+    }
+  }
+
+ public:
+  bitboard_batch() = default;
+
+  /**
+   * Creates a batch of `count` empty bitboards.
+   */
+  explicit bitboard_batch(size_t count)
+      : count_(count),
+        stride_((count + lane_block() - 1) / lane_block() * lane_block()),
+        planes(stride_ * words(), 0) {}
+
+  /**
+   * Returns the number of bitboards in the batch.
+   */
+  [[nodiscard]] size_t size() const noexcept { return count_; }
+
+  /**
+   * Returns the number of the files of the bitboards.
+   */
+  [[nodiscard]] constexpr auto files() const { return files_; }
+
+  /**
+   * Returns the number of the ranks of the bitboards.
+   */
+  [[nodiscard]] constexpr auto ranks() const { return ranks_; }
+
+  /**
+   * Returns the plane with the word `w` of all the bitboards.
+   *
+   * The span has `size()` elements, the padding is not included.
+   */
+  [[nodiscard]] std::span<const uint64_t> plane(size_t w) const noexcept {
+    return {plane_data(w), count_};
+  }
+
+  /**
+   * Stores the bitboard at the position `n`.
+   */
+  template <bool always_check_range_>
+  void store(size_t n, const bitboard<files_, ranks_, always_check_range_>& bb) {
+    assert_index(n);
+    for (size_t w = 0; w < words(); ++w) {
+      plane_data(w)[n] = bb.word(w);
+    }
+  }
+
+  /**
+   * Returns a copy of the bitboard stored at the position `n`.
+   */
+  template <bool always_check_range_ = true>
+  [[nodiscard]] bitboard<files_, ranks_, always_check_range_> load(size_t n) const {
+    assert_index(n);
+    bitboard<files_, ranks_, always_check_range_> bb;
+    for (size_t w = 0; w < words(); ++w) {
+      bb.set_word(w, plane_data(w)[n]);
+    }
+    return bb;
+  }
+
+  /**
+   * Sets all the bitboards to empty ones.
+   */
+  bitboard_batch& reset() noexcept {
+    for (size_t w = 0; w < words(); ++w) {
+      clear_plane(w);
+    }
+    return *this;
+  }
+
+  /**
+   * `this[i] &= rhs[i]` for every bitboard.
+   */
+  bitboard_batch& operator&=(const bitboard_batch& rhs) {
+    return apply_batch<binary_op::op_and>(rhs);
+  }
+
+  /**
+   * `this[i] |= rhs[i]` for every bitboard.
+   */
+  bitboard_batch& operator|=(const bitboard_batch& rhs) {
+    return apply_batch<binary_op::op_or>(rhs);
+  }
+
+  /**
+   * `this[i] ^= rhs[i]` for every bitboard.
+   */
+  bitboard_batch& operator^=(const bitboard_batch& rhs) {
+    return apply_batch<binary_op::op_xor>(rhs);
+  }
+
+  /**
+   * `this[i] &= ~rhs[i]` for every bitboard.
+   */
+  bitboard_batch& and_not(const bitboard_batch& rhs) {
+    return apply_batch<binary_op::op_andnot>(rhs);
+  }
+
+  /**
+   * `this[i] &= mask` for every bitboard.
+   */
+  template <bool always_check_range_>
+  bitboard_batch& operator&=(const bitboard<files_, ranks_, always_check_range_>& mask) {
+    return apply_broadcast<binary_op::op_and>(mask);
+  }
+
+  /**
+   * `this[i] |= mask` for every bitboard.
+   */
+  template <bool always_check_range_>
+  bitboard_batch& operator|=(const bitboard<files_, ranks_, always_check_range_>& mask) {
+    return apply_broadcast<binary_op::op_or>(mask);
+  }
+
+  /**
+   * `this[i] ^= mask` for every bitboard.
+   */
+  template <bool always_check_range_>
+  bitboard_batch& operator^=(const bitboard<files_, ranks_, always_check_range_>& mask) {
+    return apply_broadcast<binary_op::op_xor>(mask);
+  }
+
+  /**
+   * `this[i] &= ~mask` for every bitboard.
+   */
+  template <bool always_check_range_>
+  bitboard_batch& and_not(const bitboard<files_, ranks_, always_check_range_>& mask) {
+    return apply_broadcast<binary_op::op_andnot>(mask);
+  }
+
+  /**
+   * Shifts every bitboard like `bitboard::operator<<=`, the bits moved outside the board are lost.
+   */
+  bitboard_batch& operator<<=(size_t pos) noexcept {
+    size_t word_shift = pos / 64;
+    size_t bit_shift = pos % 64;
+
+    // going from the highest word, so the source planes are still unchanged when read
+    for (size_t w = words(); w-- > 0;) {
+      if (w < word_shift) {
+        clear_plane(w);
+        continue;
+      }
+      size_t src = w - word_shift;
+      const uint64_t* carry = src > 0 ? plane_data(src - 1) : nullptr;
+      shift_kernel(plane_data(w), plane_data(src), carry, bit_shift, true, stride_);
+    }
+    mask_last_plane();
+    return *this;
+  }
+
+  /**
+   * Shifts every bitboard like `bitboard::operator>>=`, the bits moved outside the board are lost.
+   */
+  bitboard_batch& operator>>=(size_t pos) noexcept {
+    size_t word_shift = pos / 64;
+    size_t bit_shift = pos % 64;
+
+    // going from the lowest word, so the source planes are still unchanged when read
+    for (size_t w = 0; w < words(); ++w) {
+      size_t src = w + word_shift;
+      if (src >= words()) {
+        clear_plane(w);
+        continue;
+      }
+      const uint64_t* carry = src + 1 < words() ? plane_data(src + 1) : nullptr;
+      shift_kernel(plane_data(w), plane_data(src), carry, bit_shift, false, stride_);
+    }
+    return *this;
+  }
+
+  /**
+   * Calculates the number of the set fields of every bitboard.
+   *
+   * @param out Output for the counters, must have at least `size()` elements.
+   */
+  void popcount(std::span<uint32_t> out) const {
+    if (out.size() < count_) {
+      throw std::invalid_argument("Output is too small for the batch.");
+    }
+    for (size_t i = 0; i < count_; ++i) {
+      out[i] = 0;
+    }
+    for (size_t w = 0; w < words(); ++w) {
+      const uint64_t* p = plane_data(w);
+      size_t i = 0;
+#if defined(__AVX2__)
+      alignas(32) uint64_t counts[4];
+      for (; i + 4 <= count_; i += 4) {
+        auto v = _mm256_load_si256(reinterpret_cast<const __m256i*>(p + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(counts), popcount_lanes(v));
+        for (size_t k = 0; k < 4; ++k) {
+          out[i + k] += static_cast<uint32_t>(counts[k]);
+        }
+      }
+#endif
+      for (; i < count_; ++i) {
+        out[i] += static_cast<uint32_t>(std::popcount(p[i]));
+      }
+    }
+  }
+
+  /**
+   * Returns the number of the set fields of all the bitboards together.
+   */
+  [[nodiscard]] uint64_t popcount() const noexcept {
+    uint64_t total = 0;
+    size_t i = 0;
+    // the padding is zero, so the whole planes can be counted
+#if defined(__AVX2__)
+    auto sum = _mm256_setzero_si256();
+    for (; i + 4 <= planes.size(); i += 4) {
+      auto v = _mm256_load_si256(reinterpret_cast<const __m256i*>(planes.data() + i));
+      sum = _mm256_add_epi64(sum, popcount_lanes(v));
+    }
+    alignas(32) uint64_t counts[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(counts), sum);
+    total = counts[0] + counts[1] + counts[2] + counts[3];
+#endif
+    for (; i < planes.size(); ++i) {
+      total += std::popcount(planes[i]);
+    }
+    return total;
+  }
+};
+
+}  // namespace slchess
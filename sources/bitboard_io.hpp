@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "bitboard.hpp"
+
+/**
+ * Bulk serialization of the bitboards, for the debug dumps and the dataset exports.
+ *
+ * There are two formats:
+ *  - hex text: a bitboard is the hexadecimal number of its bits, the field `n` is the bit `n`,
+ *    written with `hex_digits()` lowercase digits, so the highest fields are first like in
+ *    `bitboard::to_string`; the bitboards are separated with the new lines,
+ *  - binary: a bitboard is its `words()` 64 bit words, the lowest word first, every word in the
+ *    little endian byte order on every platform; the bitboards are written back to back.
+ *
+ * The functions writing many bitboards compute the output size up front and write to one buffer
+ * (`std::to_chars` for the digits), so there is no allocation per bitboard. The stream writers
+ * reuse a fixed size buffer, so the memory doesn't grow with the number of the bitboards.
+ */
+
+namespace slchess {
+
+template <typename type_>
+struct is_bitboard : std::false_type {};
+
+template <size_t files_, size_t ranks_, bool always_check_range_>
+struct is_bitboard<bitboard<files_, ranks_, always_check_range_>> : std::true_type {};
+
+/**
+ * A contiguous range of the bitboards, like `std::vector`, `std::array` or `std::span`.
+ */
+template <typename range_>
+concept bitboard_range = std::ranges::contiguous_range<range_>
+                         && is_bitboard<std::ranges::range_value_t<range_>>::value;
+
+namespace detail {
+
+/// Size of the buffer used by the stream writers.
+constexpr size_t stream_buffer_size = 64 * 1024;
+
+/**
+ * Writes the bitboards to the stream through a buffer of about `stream_buffer_size` bytes.
+ *
+ * @param record_size Number of the characters written by `write_record` for a bitboard.
+ * @param write_record Writes a bitboard to the buffer and returns the pointer past it.
+ */
+template <typename range_, typename write_record_>
+void write_buffered(const range_& boards,
+                    std::ostream& out,
+                    size_t record_size,
+                    write_record_ write_record) {
+  const auto per_chunk = std::max<size_t>(1, stream_buffer_size / record_size);
+  const auto count = std::ranges::size(boards);
+  std::vector<char> buffer(std::min(count, per_chunk) * record_size);
+
+  const auto* data = std::ranges::data(boards);
+  for (size_t begin = 0; begin < count; begin += per_chunk) {
+    auto end = std::min(count, begin + per_chunk);
+    char* cursor = buffer.data();
+    for (auto n = begin; n < end; ++n) {
+      cursor = write_record(data[n], cursor);
+    }
+    out.write(buffer.data(), cursor - buffer.data());
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Returns the number of the hex digits of a bitboard.
+ */
+template <typename board_>
+  requires is_bitboard<board_>::value
+[[nodiscard]] constexpr size_t hex_digits() {
+  return (board_().size() + 3) / 4;
+}
+
+/**
+ * Returns the number of the bytes of a bitboard in the binary format.
+ */
+template <typename board_>
+  requires is_bitboard<board_>::value
+[[nodiscard]] constexpr size_t binary_size() {
+  return board_::words() * sizeof(uint64_t);
+}
+
+/**
+ * Writes the bitboard as `hex_digits()` hex digits, without a separator.
+ *
+ * @param out Buffer for at least `hex_digits()` characters.
+ * @return Pointer past the last written character.
+ */
+template <size_t files_, size_t ranks_, bool always_check_range_>
+char* write_hex(const bitboard<files_, ranks_, always_check_range_>& bb, char* out) noexcept {
+  using board = bitboard<files_, ranks_, always_check_range_>;
+  constexpr size_t words = board::words();
+  constexpr size_t last_digits = hex_digits<board>() - (words - 1) * 16;
+
+  for (size_t w = words; w-- > 0;) {
+    // std::to_chars doesn't pad, so the digits are aligned right in the field of the word
+    size_t width = w == words - 1 ? last_digits : 16;
+    char digits[16];
+    auto result = std::to_chars(digits, digits + 16, bb.word(w), 16);
+    auto length = static_cast<size_t>(result.ptr - digits);
+    std::memset(out, '0', width - length);
+    std::memcpy(out + width - length, digits, length);
+    out += width;
+  }
+  return out;
+}
+
+/**
+ * Parses a bitboard written by `write_hex`, the upper case digits are accepted too.
+ *
+ * @throws std::invalid_argument when the text has a wrong length, a character which is not a hex
+ * digit, or a bit outside the board.
+ */
+template <typename board_>
+  requires is_bitboard<board_>::value
+[[nodiscard]] board_ parse_hex(std::string_view text) {
+  constexpr size_t words = board_::words();
+  constexpr size_t last_digits = hex_digits<board_>() - (words - 1) * 16;
+
+  if (text.size() != hex_digits<board_>()) {
+    throw std::invalid_argument("Invalid length of the bitboard hex text.");
+  }
+  board_ result;
+  const char* cursor = text.data();
+  for (size_t w = words; w-- > 0;) {
+    size_t width = w == words - 1 ? last_digits : 16;
+    uint64_t value = 0;
+    auto parsed = std::from_chars(cursor, cursor + width, value, 16);
+    if (parsed.ec != std::errc() || parsed.ptr != cursor + width) {
+      throw std::invalid_argument("Invalid bitboard hex digits.");
+    }
+    result.set_word(w, value);
+    if (result.word(w) != value) {
+      throw std::invalid_argument("The bitboard hex text has bits outside the board.");
+    }
+    cursor += width;
+  }
+  return result;
+}
+
+/**
+ * Converts the bitboards to the hex text, a line for every bitboard.
+ *
+ * The string is allocated once with its final size.
+ */
+template <bitboard_range range_>
+[[nodiscard]] std::string to_hex(const range_& boards) {
+  using board = std::ranges::range_value_t<range_>;
+  constexpr size_t record_size = hex_digits<board>() + 1;
+
+  std::string result(std::ranges::size(boards) * record_size, '\n');
+  char* cursor = result.data();
+  for (const auto& bb : boards) {
+    cursor = write_hex(bb, cursor) + 1;
+  }
+  return result;
+}
+
+/**
+ * Writes the bitboards to the stream as the hex text, a line for every bitboard.
+ */
+template <bitboard_range range_>
+void write_hex(const range_& boards, std::ostream& out) {
+  using board = std::ranges::range_value_t<range_>;
+  detail::write_buffered(boards, out, hex_digits<board>() + 1, [](const board& bb, char* cursor) {
+    cursor = write_hex(bb, cursor);
+    *cursor = '\n';
+    return cursor + 1;
+  });
+}
+
+/**
+ * Parses the bitboards from the hex text, separated with any white space.
+ *
+ * @throws std::invalid_argument when one of the bitboards can't be parsed.
+ */
+template <typename board_>
+  requires is_bitboard<board_>::value
+[[nodiscard]] std::vector<board_> from_hex(std::string_view text) {
+  constexpr std::string_view white_space = " \t\r\n";
+
+  std::vector<board_> result;
+  result.reserve(text.size() / (hex_digits<board_>() + 1));
+  for (auto begin = text.find_first_not_of(white_space); begin != std::string_view::npos;) {
+    auto end = std::min(text.find_first_of(white_space, begin), text.size());
+    result.push_back(parse_hex<board_>(text.substr(begin, end - begin)));
+    begin = text.find_first_not_of(white_space, end);
+  }
+  return result;
+}
+
+/**
+ * Writes the bitboard in the binary format.
+ *
+ * @param out Buffer for at least `binary_size()` bytes.
+ * @return Pointer past the last written byte.
+ */
+template <size_t files_, size_t ranks_, bool always_check_range_>
+char* write_binary(const bitboard<files_, ranks_, always_check_range_>& bb, char* out) noexcept {
+  for (size_t w = 0; w < bb.words(); ++w) {
+    // the compilers turn the byte stores into a single store on the little endian machines
+    auto value = bb.word(w);
+    for (size_t byte = 0; byte < sizeof(uint64_t); ++byte) {
+      *out++ = static_cast<char>((value >> (8 * byte)) & 0xFF);
+    }
+  }
+  return out;
+}
+
+/**
+ * Converts the bitboards to the binary format, the buffer is allocated once.
+ */
+template <bitboard_range range_>
+[[nodiscard]] std::vector<char> to_binary(const range_& boards) {
+  using board = std::ranges::range_value_t<range_>;
+
+  std::vector<char> result(std::ranges::size(boards) * binary_size<board>());
+  char* cursor = result.data();
+  for (const auto& bb : boards) {
+    cursor = write_binary(bb, cursor);
+  }
+  return result;
+}
+
+/**
+ * Writes the bitboards to the stream in the binary format.
+ */
+template <bitboard_range range_>
+void write_binary(const range_& boards, std::ostream& out) {
+  using board = std::ranges::range_value_t<range_>;
+  detail::write_buffered(boards, out, binary_size<board>(), [](const board& bb, char* cursor) {
+    return write_binary(bb, cursor);
+  });
+}
+
+/**
+ * Reads the bitboards from the binary format.
+ *
+ * @throws std::invalid_argument when the size is not a multiple of `binary_size()`, or a bitboard
+ * has a bit outside the board.
+ */
+template <typename board_>
+  requires is_bitboard<board_>::value
+[[nodiscard]] std::vector<board_> from_binary(std::span<const char> data) {
+  constexpr size_t record_size = binary_size<board_>();
+
+  if (data.size() % record_size != 0) {
+    throw std::invalid_argument("The binary bitboard data is not a whole number of bitboards.");
+  }
+  std::vector<board_> result(data.size() / record_size);
+  const auto* cursor = reinterpret_cast<const unsigned char*>(data.data());
+  for (auto& bb : result) {
+    for (size_t w = 0; w < board_::words(); ++w) {
+      uint64_t value = 0;
+      for (size_t byte = 0; byte < sizeof(uint64_t); ++byte) {
+        value |= static_cast<uint64_t>(*cursor++) << (8 * byte);
+      }
+      bb.set_word(w, value);
+      if (bb.word(w) != value) {
+        throw std::invalid_argument("The binary bitboard data has bits outside the board.");
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace slchess
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "bitboard.hpp"
+
+/**
+ * Conversions between the bitboard shapes.
+ *
+ * A rank of a bitboard is a run of `files` consecutive bits, so a rectangle of one bitboard is
+ * copied to another one rank by rank, up to 64 bits at once with a word shift and a mask. This is
+ * O(ranks * files / 64) instead of the O(ranks * files) of copying the fields one by one.
+ */
+
+namespace slchess {
+
+namespace detail {
+
+[[nodiscard]] constexpr uint64_t low_bits_mask(size_t width) {
+  return width >= 64 ? ~0ULL : (1ULL << width) - 1;
+}
+
+/**
+ * Returns `width` (at most 64) bits of the bitboard starting with the bit `index`.
+ */
+template <typename board_>
+[[nodiscard]] constexpr uint64_t read_bits(const board_& bb, size_t index, size_t width) {
+  auto w = index / 64;
+  auto shift = index % 64;
+  auto value = bb.word(w) >> shift;
+  if (shift != 0 && w + 1 < board_::words()) {
+    value |= bb.word(w + 1) << (64 - shift);
+  }
+  return value & low_bits_mask(width);
+}
+
+/**
+ * Adds `width` (at most 64) bits to the bitboard starting with the bit `index`.
+ */
+template <typename board_>
+constexpr void or_bits(board_& bb, size_t index, size_t width, uint64_t value) {
+  auto w = index / 64;
+  auto shift = index % 64;
+  bb.set_word(w, bb.word(w) | value << shift);
+  if (shift != 0 && shift + width > 64) {
+    bb.set_word(w + 1, bb.word(w + 1) | value >> (64 - shift));
+  }
+}
+
+/**
+ * Adds the rectangle of `width` x `height` fields of `from`, with the lower left corner at
+ * (`from_file`, `from_rank`), to `to` with the lower left corner at (`to_file`, `to_rank`).
+ *
+ * The rectangle must fit in both bitboards.
+ */
+template <typename from_board_, typename to_board_>
+constexpr void copy_rectangle(const from_board_& from,
+                              size_t from_file,
+                              size_t from_rank,
+                              to_board_& to,
+                              size_t to_file,
+                              size_t to_rank,
+                              size_t width,
+                              size_t height) {
+  const auto from_files = from.files();
+  const auto to_files = to.files();
+  for (size_t rank = 0; rank < height; ++rank) {
+    auto from_index = (from_rank + rank) * from_files + from_file;
+    auto to_index = (to_rank + rank) * to_files + to_file;
+    for (size_t done = 0; done < width; done += 64) {
+      auto chunk = std::min<size_t>(64, width - done);
+      auto bits = read_bits(from, from_index + done, chunk);
+      if (bits != 0) {
+        or_bits(to, to_index + done, chunk, bits);
+      }
+    }
+  }
+}
+
+/**
+ * Returns the mask of the first `files_` files of every rank of the bitboard.
+ */
+template <typename board_, size_t files_, size_t ranks_>
+[[nodiscard]] constexpr board_ make_board_mask() {
+  board_ mask;
+  for (size_t rank = 0; rank < ranks_; ++rank) {
+    for (size_t done = 0; done < files_; done += 64) {
+      auto chunk = std::min<size_t>(64, files_ - done);
+      or_bits(mask, rank * mask.files() + done, chunk, low_bits_mask(chunk));
+    }
+  }
+  return mask;
+}
+
+}  // namespace detail
+
+/**
+ * Converts the bitboard to another shape, keeping the fields at the same (file, rank).
+ *
+ * The fields which don't fit in the new shape are dropped, the new fields are empty.
+ *
+ * @tparam to_files_ Number of the files of the result.
+ * @tparam to_ranks_ Number of the ranks of the result.
+ * @tparam to_check_range_ The range checking of the result.
+ */
+template <size_t to_files_,
+          size_t to_ranks_,
+          bool to_check_range_ = true,
+          size_t files_,
+          size_t ranks_,
+          bool always_check_range_>
+[[nodiscard]] constexpr bitboard<to_files_, to_ranks_, to_check_range_> resize(
+    const bitboard<files_, ranks_, always_check_range_>& bb) {
+  bitboard<to_files_, to_ranks_, to_check_range_> result;
+  detail::copy_rectangle(
+      bb, 0, 0, result, 0, 0, std::min(files_, to_files_), std::min(ranks_, to_ranks_));
+  return result;
+}
+
+/**
+ * Places the bitboard into a larger one, e.g. an 8x8 board into a 10x10 board with a padding of
+ * one field on every side: `embed<10, 10>(bb, File(1), Rank(1))`.
+ *
+ * @param file File of the result where the first file of `bb` is placed.
+ * @param rank Rank of the result where the first rank of `bb` is placed.
+ * @throws std::out_of_range when the bitboard doesn't fit in the result at the position.
+ */
+template <size_t to_files_,
+          size_t to_ranks_,
+          bool to_check_range_ = true,
+          size_t files_,
+          size_t ranks_,
+          bool always_check_range_>
+[[nodiscard]] constexpr bitboard<to_files_, to_ranks_, to_check_range_> embed(
+    const bitboard<files_, ranks_, always_check_range_>& bb, File file, Rank rank) {
+  if (file + files_ > to_files_) {
+    throw std::out_of_range("The embedded bitboard has too many files.");
+  }
+  if (rank + ranks_ > to_ranks_) {
+    throw std::out_of_range("The embedded bitboard has too many ranks.");
+  }
+  bitboard<to_files_, to_ranks_, to_check_range_> result;
+  detail::copy_rectangle(bb, 0, 0, result, file, rank, files_, ranks_);
+  return result;
+}
+
+/**
+ * Returns the region of the bitboard as a new bitboard, the inverse of `embed`.
+ *
+ * @param file First file of the region.
+ * @param rank First rank of the region.
+ * @throws std::out_of_range when the region is not inside the bitboard.
+ */
+template <size_t to_files_,
+          size_t to_ranks_,
+          bool to_check_range_ = true,
+          size_t files_,
+          size_t ranks_,
+          bool always_check_range_>
+[[nodiscard]] constexpr bitboard<to_files_, to_ranks_, to_check_range_> extract(
+    const bitboard<files_, ranks_, always_check_range_>& bb, File file, Rank rank) {
+  if (file + to_files_ > files_) {
+    throw std::out_of_range("The extracted region has too many files.");
+  }
+  if (rank + to_ranks_ > ranks_) {
+    throw std::out_of_range("The extracted region has too many ranks.");
+  }
+  bitboard<to_files_, to_ranks_, to_check_range_> result;
+  detail::copy_rectangle(bb, file, rank, result, 0, 0, to_files_, to_ranks_);
+  return result;
+}
+
+/**
+ * A bitboard in the sentinel padded layout.
+ *
+ * The board is stored with `padding_` extra files on the right side of every rank. The extra
+ * fields are always empty, so a shift by a rank and at most `padding_` files never moves a field
+ * to a valid field of another rank: the fields moved over the left or the right edge land in
+ * the padding. One mask of the valid fields, computed at compile time, clears them after any
+ * shift, so the moves don't need a wrap mask for every direction like on the plain bitboards.
+ *
+ * @tparam files_ Number of the files of the board.
+ * @tparam ranks_ Number of the ranks of the board.
+ * @tparam padding_ Number of the sentinel files, the largest file distance of a shift.
+ */
+template <size_t files_, size_t ranks_, size_t padding_ = 1>
+class sentinel_bitboard {
+ public:
+  static_assert(padding_ > 0, "The sentinel layout needs at least one padding file.");
+
+  using storage = bitboard<files_ + padding_, ranks_, false>;
+
+ private:
+  storage board_;
+
+  constexpr explicit sentinel_bitboard(const storage& board) : board_(board) {}
+
+ public:
+  /// The valid fields, every padding field is empty.
+  static constexpr storage board_mask = detail::make_board_mask<storage, files_, ranks_>();
+
+  constexpr sentinel_bitboard() = default;
+
+  /**
+   * Converts the plain bitboard to the padded layout.
+   */
+  template <bool always_check_range_>
+  constexpr explicit sentinel_bitboard(const bitboard<files_, ranks_, always_check_range_>& bb)
+      : board_(embed<files_ + padding_, ranks_, false>(bb, File(0), Rank(0))) {}
+
+  /**
+   * Converts the board back to the plain layout.
+   */
+  template <bool to_check_range_ = true>
+  [[nodiscard]] constexpr bitboard<files_, ranks_, to_check_range_> to_bitboard() const {
+    return extract<files_, ranks_, to_check_range_>(board_, File(0), Rank(0));
+  }
+
+  /**
+   * Returns the padded storage, the padding fields are always empty.
+   */
+  [[nodiscard]] constexpr const storage& board() const noexcept { return board_; }
+
+  /**
+   * Moves every field by the given number of files and ranks, the fields moved outside the board
+   * are dropped.
+   *
+   * @throws std::invalid_argument when the file distance is larger than the padding.
+   */
+  [[nodiscard]] constexpr sentinel_bitboard shift(int file_delta, int rank_delta) const {
+    if (static_cast<size_t>(file_delta < 0 ? -file_delta : file_delta) > padding_) {
+      throw std::invalid_argument("The shift has more files than the sentinel padding.");
+    }
+    auto delta = rank_delta * static_cast<int>(files_ + padding_) + file_delta;
+    auto shifted = delta >= 0 ? board_ << static_cast<size_t>(delta)
+                              : board_ >> static_cast<size_t>(-delta);
+    return sentinel_bitboard(shifted & board_mask);
+  }
+
+  [[nodiscard]] constexpr bool get(File file, Rank rank) const {
+    return file < files_ && rank < ranks_ && board_.get(file, rank);
+  }
+
+  constexpr sentinel_bitboard& set(File file, Rank rank) {
+    if (file >= files_ || rank >= ranks_) {
+      throw std::out_of_range("Requested field is outside the board.");
+    }
+    board_.set(file, rank);
+    return *this;
+  }
+
+  [[nodiscard]] constexpr size_t count() const noexcept { return board_.count(); }
+
+  [[nodiscard]] constexpr bool operator==(const sentinel_bitboard& other) const noexcept {
+    return board_ == other.board_;
+  }
+
+  [[nodiscard]] constexpr sentinel_bitboard operator|(const sentinel_bitboard& other) const {
+    return sentinel_bitboard(board_ | other.board_);
+  }
+
+  [[nodiscard]] constexpr sentinel_bitboard operator&(const sentinel_bitboard& other) const {
+    return sentinel_bitboard(board_ & other.board_);
+  }
+
+  [[nodiscard]] constexpr sentinel_bitboard operator^(const sentinel_bitboard& other) const {
+    return sentinel_bitboard(board_ ^ other.board_);
+  }
+};
+
+}  // namespace slchess
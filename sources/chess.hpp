@@ -0,0 +1,122 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "bitboard.hpp"
+
+namespace slchess {
+
+/**
+ * The bitboard used for the chess board.
+ *
+ * The range is not checked, the engine code uses only the square indices calculated with the
+ * `coordinates_to_index`, so the squares are always on the board.
+ */
+using chessboard = bitboard<8, 8, false>;
+
+/**
+ * Index of a chess board square, calculated as `coordinates_to_index(file, rank, 8)`.
+ *
+ * So a1 is 0, h1 is 7, a2 is 8 and h8 is 63.
+ */
+using square_index = uint8_t;
+
+/// Value used when there is no square, e.g. when en passant is not possible.
+constexpr square_index no_square = 64;
+
+enum color : uint8_t { white = 0, black = 1 };
+
+[[nodiscard]] constexpr color operator~(color c) { return color(c ^ 1); }
+
+enum piece_type : uint8_t { pawn = 0, knight, bishop, rook, queen, king, no_piece_type };
+
+/**
+ * Chess piece code.
+ *
+ * The code uses 4 bits: bit 3 is the color, bits 0-2 keep `piece_type + 1`. This way the empty
+ * square is 0 and all the pieces fit in a nibble.
+ */
+enum piece : uint8_t {
+  no_piece = 0,
+  white_pawn = 1,
+  white_knight,
+  white_bishop,
+  white_rook,
+  white_queen,
+  white_king,
+  black_pawn = 9,
+  black_knight,
+  black_bishop,
+  black_rook,
+  black_queen,
+  black_king,
+};
+
+[[nodiscard]] constexpr piece make_piece(color c, piece_type type) {
+  return piece((c << 3) | (type + 1));
+}
+
+[[nodiscard]] constexpr piece_type type_of(piece p) { return piece_type((p & 7) - 1); }
+
+[[nodiscard]] constexpr color color_of(piece p) { return color(p >> 3); }
+
+/**
+ * Castling rights flags.
+ */
+enum castling : uint8_t {
+  no_castling = 0,
+  white_king_side = 1,
+  white_queen_side = 2,
+  black_king_side = 4,
+  black_queen_side = 8,
+  all_castling = 15,
+};
+
+[[nodiscard]] constexpr square_index make_square(size_t file, size_t rank) {
+  return static_cast<square_index>(coordinates_to_index(file, rank, 8));
+}
+
+[[nodiscard]] constexpr size_t file_of(square_index sq) { return sq & 7; }
+
+[[nodiscard]] constexpr size_t rank_of(square_index sq) { return sq >> 3; }
+
+/**
+ * Returns the square as seen by the other side, so a1 becomes a8.
+ */
+[[nodiscard]] constexpr square_index flip_rank(square_index sq) { return sq ^ 56; }
+
+/**
+ * Returns a one square chessboard.
+ */
+[[nodiscard]] constexpr chessboard square_board(square_index sq) {
+  return chessboard(1ULL << sq);
+}
+
+/**
+ * Returns the lowest set square of a non empty chessboard.
+ */
+[[nodiscard]] constexpr square_index lsb(const chessboard& bb) {
+  return static_cast<square_index>(std::countr_zero(bb.to_ullong()));
+}
+
+/**
+ * Calls `f(square_index)` for every set square, from the lowest one.
+ */
+template <typename F>
+constexpr void for_each_square(const chessboard& bb, F&& f) {
+  for (uint64_t bits = bb.to_ullong(); bits != 0; bits &= bits - 1) {
+    f(static_cast<square_index>(std::countr_zero(bits)));
+  }
+}
+
+/**
+ * Returns the square name like "e4".
+ */
+[[nodiscard]] inline std::string square_name(square_index sq) {
+  return {static_cast<char>('a' + file_of(sq)), static_cast<char>('1' + rank_of(sq))};
+}
+
+}  // namespace slchess
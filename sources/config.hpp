@@ -9,3 +9,5 @@
 #define PROJECT_VERSION_MINOR "1"
 #define PROJECT_VERSION_PATCH "0"
 
+// Set with the ENABLE_STATS cmake option.
+#define ENABLE_STATS 0
@@ -0,0 +1,190 @@
+#include "endgame.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bitbase.hpp"
+#include "evaluate.hpp"
+
+namespace slchess {
+
+namespace {
+
+/// Evaluates the endgame from the point of view of the strong side.
+using endgame_function = int (*)(const position& pos, color strong);
+
+struct endgame_entry {
+  uint64_t signature;
+  endgame_function function;
+  color strong;
+};
+
+constexpr size_t signature_bits = 4;
+
+constexpr size_t signature_shift(color c, piece_type type) {
+  return (c * 5 + type) * signature_bits;
+}
+
+/// Returns the signature with the colors swapped.
+constexpr uint64_t mirror_signature(uint64_t signature) {
+  constexpr size_t side_bits = 5 * signature_bits;
+  constexpr uint64_t side_mask = (1ULL << side_bits) - 1;
+  return (signature >> side_bits) | ((signature & side_mask) << side_bits);
+}
+
+int distance(square_index a, square_index b) {
+  return std::max(std::abs(static_cast<int>(file_of(a)) - static_cast<int>(file_of(b))),
+                  std::abs(static_cast<int>(rank_of(a)) - static_cast<int>(rank_of(b))));
+}
+
+/// Returns 0 in the center, 6 in the corners.
+int center_distance(square_index sq) {
+  auto file = static_cast<int>(file_of(sq));
+  auto rank = static_cast<int>(rank_of(sq));
+  return (file < 4 ? 3 - file : file - 4) + (rank < 4 ? 3 - rank : rank - 4);
+}
+
+bool is_dark(square_index sq) {
+  return (file_of(sq) + rank_of(sq)) % 2 == 0;
+}
+
+int material(const position& pos, color side) {
+  int sum = 0;
+  for (auto type : {pawn, knight, bishop, rook, queen}) {
+    sum += piece_values[type] * static_cast<int>(pos.pieces(side, type).count());
+  }
+  return sum;
+}
+
+int evaluate_draw(const position& /*pos*/, color /*strong*/) {
+  return 0;
+}
+
+int evaluate_kpk(const position& pos, color strong) {
+  auto strong_king = pos.king_square(strong);
+  auto weak_king = pos.king_square(~strong);
+  auto pawn_square = lsb(pos.pieces(strong, pawn));
+  // the bitbase has white as the strong side
+  if (strong == black) {
+    strong_king = flip_rank(strong_king);
+    weak_king = flip_rank(weak_king);
+    pawn_square = flip_rank(pawn_square);
+  }
+  auto side = pos.side_to_move() == strong ? white : black;
+  if (!kpk().is_win(side, strong_king, pawn_square, weak_king)) {
+    return 0;
+  }
+  return score_known_win + piece_values[pawn] + 10 * static_cast<int>(rank_of(pawn_square));
+}
+
+/// A lone king against the mating material: the lone king is driven to the edge.
+int evaluate_kxk(const position& pos, color strong) {
+  auto strong_king = pos.king_square(strong);
+  auto weak_king = pos.king_square(~strong);
+  return score_known_win + material(pos, strong) + 20 * center_distance(weak_king) +
+         10 * (7 - distance(strong_king, weak_king));
+}
+
+int evaluate_kbbk(const position& pos, color strong) {
+  int dark_bishops = 0;
+  for_each_square(pos.pieces(strong, bishop),
+                  [&](square_index sq) { dark_bishops += is_dark(sq) ? 1 : 0; });
+  // the bishops on the same color can't mate
+  if (dark_bishops != 1) {
+    return 0;
+  }
+  return evaluate_kxk(pos, strong);
+}
+
+/// The mate is possible only in a corner of the color of the bishop.
+int evaluate_kbnk(const position& pos, color strong) {
+  auto strong_king = pos.king_square(strong);
+  auto weak_king = pos.king_square(~strong);
+  bool dark = is_dark(lsb(pos.pieces(strong, bishop)));
+  auto first_corner = dark ? make_square(0, 0) : make_square(7, 0);
+  auto second_corner = dark ? make_square(7, 7) : make_square(0, 7);
+  auto corner_distance =
+      std::min(distance(weak_king, first_corner), distance(weak_king, second_corner));
+  return score_known_win + material(pos, strong) + 20 * (7 - corner_distance) +
+         10 * (7 - distance(strong_king, weak_king));
+}
+
+std::vector<endgame_entry> make_endgame_table() {
+  const std::pair<const char*, endgame_function> endgames[] = {
+      {"KPK", evaluate_kpk},
+      {"KQK", evaluate_kxk},
+      {"KRK", evaluate_kxk},
+      {"KBBK", evaluate_kbbk},
+      {"KBNK", evaluate_kbnk},
+      {"KK", evaluate_draw},
+      {"KNK", evaluate_draw},
+      {"KBK", evaluate_draw},
+      {"KNNK", evaluate_draw},
+  };
+
+  std::vector<endgame_entry> table;
+  for (const auto& [code, function] : endgames) {
+    auto signature = material_signature(code);
+    table.push_back({signature, function, white});
+    if (mirror_signature(signature) != signature) {
+      table.push_back({mirror_signature(signature), function, black});
+    }
+  }
+  std::sort(table.begin(), table.end(),
+            [](const auto& a, const auto& b) { return a.signature < b.signature; });
+  return table;
+}
+
+}  // namespace
+
+uint64_t material_signature(const position& pos) {
+  uint64_t signature = 0;
+  for (auto c : {white, black}) {
+    for (auto type : {pawn, knight, bishop, rook, queen}) {
+      signature |= static_cast<uint64_t>(pos.pieces(c, type).count()) << signature_shift(c, type);
+    }
+  }
+  return signature;
+}
+
+uint64_t material_signature(std::string_view code) {
+  const std::string_view letters = "PNBRQ";
+  if (code.empty() || code[0] != 'K' || std::count(code.begin(), code.end(), 'K') != 2) {
+    throw std::invalid_argument("Invalid endgame code: " + std::string(code));
+  }
+
+  uint64_t signature = 0;
+  auto side = white;
+  for (size_t n = 1; n < code.size(); ++n) {
+    if (code[n] == 'K') {
+      side = black;
+      continue;
+    }
+    auto type = letters.find(code[n]);
+    if (type == std::string_view::npos) {
+      throw std::invalid_argument("Invalid endgame code: " + std::string(code));
+    }
+    signature += 1ULL << signature_shift(side, static_cast<piece_type>(type));
+  }
+  return signature;
+}
+
+std::optional<int> evaluate_endgame(const position& pos) {
+  static const std::vector<endgame_entry> table = make_endgame_table();
+
+  auto signature = material_signature(pos);
+  auto entry = std::lower_bound(
+      table.begin(), table.end(), signature,
+      [](const endgame_entry& e, uint64_t value) { return e.signature < value; });
+  if (entry == table.end() || entry->signature != signature) {
+    return std::nullopt;
+  }
+  auto score = entry->function(pos, entry->strong);
+  return pos.side_to_move() == entry->strong ? score : -score;
+}
+
+}  // namespace slchess
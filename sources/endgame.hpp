@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "position.hpp"
+
+namespace slchess {
+
+/**
+ * Base of the scores of the won endgames, far above any material balance of the other positions
+ * and far below the mate scores.
+ */
+constexpr int score_known_win = 10000;
+
+/**
+ * The largest number of pieces, the kings included, of the endgames with a special evaluation.
+ */
+constexpr size_t max_endgame_pieces = 5;
+
+/**
+ * Returns the material signature of the position: the number of every piece type, except the
+ * kings, of both sides, 4 bits for each.
+ */
+[[nodiscard]] uint64_t material_signature(const position& pos);
+
+/**
+ * Returns the material signature of the endgame code like "KRK" or "KBNK": the white pieces from
+ * the first 'K', the black pieces from the second one, with the letters P, N, B, R and Q.
+ *
+ * @throws std::invalid_argument when the code is not valid.
+ */
+[[nodiscard]] uint64_t material_signature(std::string_view code);
+
+/**
+ * Evaluates the position with the evaluator of its endgame.
+ *
+ * The evaluators are kept in a table sorted by the material signature:
+ *  - KPK is looked up in the `kpk_bitbase`, so it's exact: a draw is 0, a win is above
+ *    `score_known_win`, higher for the more advanced pawn,
+ *  - KQK, KRK, KBBK and KBNK are wins, scored by the material, the distance of the lone king from
+ *    the edge (from the mating corner for KBNK) and the distance between the kings, so the search
+ *    drives the lone king to the mate,
+ *  - KK, KNK, KBK, KNNK and KBBK with the bishops on the same color are draws.
+ *
+ * @return Score from the point of view of the side to move, or nothing when the endgame has no
+ * special evaluator.
+ */
+[[nodiscard]] std::optional<int> evaluate_endgame(const position& pos);
+
+}  // namespace slchess
@@ -0,0 +1,167 @@
+#include "evaluate.hpp"
+
+#include <algorithm>
+
+#include "endgame.hpp"
+#include "stats.hpp"
+
+namespace slchess {
+
+namespace {
+
+using table = std::array<int, 64>;
+
+// The tables are written as seen from the white side: the first row is the 8th rank.
+
+constexpr table pawn_table = {
+    0,  0,  0,   0,   0,   0,   0,  0,   //
+    50, 50, 50,  50,  50,  50,  50, 50,  //
+    10, 10, 20,  30,  30,  20,  10, 10,  //
+    5,  5,  10,  25,  25,  10,  5,  5,   //
+    0,  0,  0,   20,  20,  0,   0,  0,   //
+    5,  -5, -10, 0,   0,   -10, -5, 5,   //
+    5,  10, 10,  -20, -20, 10,  10, 5,   //
+    0,  0,  0,   0,   0,   0,   0,  0,   //
+};
+
+constexpr table knight_table = {
+    -50, -40, -30, -30, -30, -30, -40, -50,  //
+    -40, -20, 0,   0,   0,   0,   -20, -40,  //
+    -30, 0,   10,  15,  15,  10,  0,   -30,  //
+    -30, 5,   15,  20,  20,  15,  5,   -30,  //
+    -30, 0,   15,  20,  20,  15,  0,   -30,  //
+    -30, 5,   10,  15,  15,  10,  5,   -30,  //
+    -40, -20, 0,   5,   5,   0,   -20, -40,  //
+    -50, -40, -30, -30, -30, -30, -40, -50,  //
+};
+
+constexpr table bishop_table = {
+    -20, -10, -10, -10, -10, -10, -10, -20,  //
+    -10, 0,   0,   0,   0,   0,   0,   -10,  //
+    -10, 0,   5,   10,  10,  5,   0,   -10,  //
+    -10, 5,   5,   10,  10,  5,   5,   -10,  //
+    -10, 0,   10,  10,  10,  10,  0,   -10,  //
+    -10, 10,  10,  10,  10,  10,  10,  -10,  //
+    -10, 5,   0,   0,   0,   0,   5,   -10,  //
+    -20, -10, -10, -10, -10, -10, -10, -20,  //
+};
+
+constexpr table rook_table = {
+    0,  0,  0,  0,  0,  0,  0,  0,   //
+    5,  10, 10, 10, 10, 10, 10, 5,   //
+    -5, 0,  0,  0,  0,  0,  0,  -5,  //
+    -5, 0,  0,  0,  0,  0,  0,  -5,  //
+    -5, 0,  0,  0,  0,  0,  0,  -5,  //
+    -5, 0,  0,  0,  0,  0,  0,  -5,  //
+    -5, 0,  0,  0,  0,  0,  0,  -5,  //
+    0,  0,  0,  5,  5,  0,  0,  0,   //
+};
+
+constexpr table queen_table = {
+    -20, -10, -10, -5, -5, -10, -10, -20,  //
+    -10, 0,   0,   0,  0,  0,   0,   -10,  //
+    -10, 0,   5,   5,  5,  5,   0,   -10,  //
+    -5,  0,   5,   5,  5,  5,   0,   -5,   //
+    0,   0,   5,   5,  5,  5,   0,   -5,   //
+    -10, 5,   5,   5,  5,  5,   0,   -10,  //
+    -10, 0,   5,   0,  0,  0,   0,   -10,  //
+    -20, -10, -10, -5, -5, -10, -10, -20,  //
+};
+
+constexpr table king_middle_game_table = {
+    -30, -40, -40, -50, -50, -40, -40, -30,  //
+    -30, -40, -40, -50, -50, -40, -40, -30,  //
+    -30, -40, -40, -50, -50, -40, -40, -30,  //
+    -30, -40, -40, -50, -50, -40, -40, -30,  //
+    -20, -30, -30, -40, -40, -30, -30, -20,  //
+    -10, -20, -20, -20, -20, -20, -20, -10,  //
+    20,  20,  0,   0,   0,   0,   20,  20,   //
+    20,  30,  10,  0,   0,   10,  30,  20,   //
+};
+
+constexpr table king_end_game_table = {
+    -50, -40, -30, -20, -20, -30, -40, -50,  //
+    -30, -20, -10, 0,   0,   -10, -20, -30,  //
+    -30, -10, 20,  30,  30,  20,  -10, -30,  //
+    -30, -10, 30,  40,  40,  30,  -10, -30,  //
+    -30, -10, 30,  40,  40,  30,  -10, -30,  //
+    -30, -10, 20,  30,  30,  20,  -10, -30,  //
+    -30, -30, 0,   0,   0,   0,   -30, -30,  //
+    -50, -30, -30, -30, -30, -30, -30, -50,  //
+};
+
+constexpr std::array<int, 6> middle_game_values = {82, 337, 365, 477, 1025, 0};
+constexpr std::array<int, 6> end_game_values = {94, 281, 297, 512, 936, 0};
+
+constexpr eval_weights default_weights = {
+    {pawn_table, knight_table, bishop_table, rook_table, queen_table, king_middle_game_table},
+    {pawn_table, knight_table, bishop_table, rook_table, queen_table, king_end_game_table},
+    middle_game_values,
+    end_game_values,
+};
+
+struct score_tables {
+  /// Material and placement score for every piece code and square, from the white side.
+  std::array<table, 16> middle_game{};
+  std::array<table, 16> end_game{};
+};
+
+constexpr score_tables make_score_tables(const eval_weights& weights) {
+  score_tables result;
+  for (auto type : {pawn, knight, bishop, rook, queen, king}) {
+    const auto& middle_game_table = weights.middle_game_tables[type];
+    const auto& end_game_table = weights.end_game_tables[type];
+    for (square_index sq = 0; sq < 64; ++sq) {
+      // the tables start from the 8th rank, so for white the square has to be flipped
+      auto white_piece = make_piece(white, type);
+      auto black_piece = make_piece(black, type);
+      result.middle_game[white_piece][sq] =
+          weights.middle_game_values[type] + middle_game_table[flip_rank(sq)];
+      result.end_game[white_piece][sq] =
+          weights.end_game_values[type] + end_game_table[flip_rank(sq)];
+      result.middle_game[black_piece][sq] =
+          -(weights.middle_game_values[type] + middle_game_table[sq]);
+      result.end_game[black_piece][sq] = -(weights.end_game_values[type] + end_game_table[sq]);
+    }
+  }
+  return result;
+}
+
+constexpr score_tables tables = make_score_tables(default_weights);
+
+}  // namespace
+
+const eval_weights& default_eval_weights() {
+  return default_weights;
+}
+
+int game_phase(const position& pos) {
+  int phase = 0;
+  for (auto type : {knight, bishop, rook, queen}) {
+    phase += phase_weights[type] * static_cast<int>(pos.pieces(type).count());
+  }
+  return std::min(phase, max_phase);
+}
+
+int evaluate(const position& pos) {
+  stats::add(stat_counter::eval_calls);
+  if (pos.pieces().count() <= max_endgame_pieces) {
+    if (auto score = evaluate_endgame(pos)) {
+      return *score;
+    }
+  }
+
+  int middle_game = 0;
+  int end_game = 0;
+  for_each_square(pos.pieces(), [&](square_index sq) {
+    auto p = pos.piece_on(sq);
+    middle_game += tables.middle_game[p][sq];
+    end_game += tables.end_game[p][sq];
+  });
+
+  int phase = game_phase(pos);
+  int score = (middle_game * phase + end_game * (max_phase - phase)) / max_phase;
+  return pos.side_to_move() == white ? score : -score;
+}
+
+}  // namespace slchess
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+
+#include "position.hpp"
+
+namespace slchess {
+
+/**
+ * Material values in centipawns, used for the move ordering.
+ */
+constexpr std::array<int, 7> piece_values = {100, 320, 330, 500, 900, 0, 0};
+
+/**
+ * Game phase weights of the pieces, the starting position has `max_phase`.
+ */
+constexpr std::array<int, 6> phase_weights = {0, 1, 1, 2, 4, 0};
+
+constexpr int max_phase = 24;
+
+/**
+ * The weights of the tapered evaluation, indexed by the piece type.
+ *
+ * The score of a piece is its value plus its piece-square table entry, separately for the middle
+ * game and the end game. The tables are written as seen from the white side: the first 8 entries
+ * are the 8th rank, and they are mirrored for black.
+ */
+struct eval_weights {
+  std::array<std::array<int, 64>, 6> middle_game_tables{};
+  std::array<std::array<int, 64>, 6> end_game_tables{};
+  std::array<int, 6> middle_game_values{};
+  std::array<int, 6> end_game_values{};
+};
+
+/**
+ * Returns the weights used by `evaluate`.
+ */
+[[nodiscard]] const eval_weights& default_eval_weights();
+
+/**
+ * Returns the game phase of the position: `max_phase` for the middle game, 0 for the pawn ending.
+ */
+[[nodiscard]] int game_phase(const position& pos);
+
+/**
+ * Evaluates the position statically.
+ *
+ * It's a tapered evaluation of the material and piece-square tables: the middle game and the
+ * end game scores are mixed according to the game phase.
+ *
+ * The endgames with a special evaluator (see `evaluate_endgame`) are evaluated by it instead.
+ *
+ * @return Score in centipawns from the point of view of the side to move.
+ */
+[[nodiscard]] int evaluate(const position& pos);
+
+}  // namespace slchess
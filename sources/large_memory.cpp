@@ -0,0 +1,179 @@
+#include "large_memory.hpp"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace slchess {
+
+namespace {
+
+/**
+ * Returns the mask of the online NUMA nodes, from the list like "0-1,3" in the sysfs.
+ */
+uint64_t online_nodes() {
+  std::ifstream input("/sys/devices/system/node/online");
+  std::string list;
+  if (!(input >> list)) {
+    return 1;
+  }
+  uint64_t mask = 0;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t used = 0;
+    auto first = std::stoul(list.substr(pos), &used);
+    auto last = first;
+    pos += used;
+    if (pos < list.size() && list[pos] == '-') {
+      last = std::stoul(list.substr(pos + 1), &used);
+      pos += used + 1;
+    }
+    for (auto node = first; node <= last && node < 64; ++node) {
+      mask |= 1ULL << node;
+    }
+    ++pos;  // the comma
+  }
+  return mask != 0 ? mask : 1;
+}
+
+/**
+ * Sets the NUMA policy of the not yet touched pages. Errors are ignored, the memory
+ * is usable with the default policy anyway.
+ */
+void set_numa_policy(void* address, size_t size, numa_policy policy, int node) {
+  if (policy == numa_policy::local) {
+    return;
+  }
+  uint64_t mask = policy == numa_policy::bind ? 1ULL << (node & 63) : online_nodes();
+  if (policy == numa_policy::interleave && std::popcount(mask) < 2) {
+    return;
+  }
+  int mode = policy == numa_policy::bind ? MPOL_BIND : MPOL_INTERLEAVE;
+  ::syscall(SYS_mbind, address, size, mode, &mask, 64, 0);
+}
+
+}  // namespace
+
+unsigned numa_nodes() { return static_cast<unsigned>(std::popcount(online_nodes())); }
+
+large_buffer::large_buffer(size_t size, numa_policy policy, int node) : size_(size) {
+  if (size == 0) {
+    return;
+  }
+
+  if (size >= huge_page_size) {
+    mapped_size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+    void* address = ::mmap(nullptr,
+                           mapped_size,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                           -1,
+                           0);
+    if (address != MAP_FAILED) {
+      data_ = address;
+      pages_ = page_kind::explicit_huge;
+    } else {
+      // there are no free explicit huge pages, so the transparent ones are used: an aligned
+      // range is cut out of a bigger mapping
+      address = ::mmap(nullptr,
+                       mapped_size + huge_page_size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS,
+                       -1,
+                       0);
+      if (address == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "Can't map the memory");
+      }
+      auto start = reinterpret_cast<uintptr_t>(address);
+      auto aligned = (start + huge_page_size - 1) / huge_page_size * huge_page_size;
+      if (aligned != start) {
+        ::munmap(address, aligned - start);
+      }
+      ::munmap(reinterpret_cast<void*>(aligned + mapped_size), start + huge_page_size - aligned);
+      data_ = reinterpret_cast<void*>(aligned);
+      pages_ = ::madvise(data_, mapped_size, MADV_HUGEPAGE) == 0 ? page_kind::transparent_huge
+                                                                 : page_kind::normal;
+    }
+  } else {
+    mapped_size = size;
+    data_ = ::mmap(
+        nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data_ == MAP_FAILED) {
+      data_ = nullptr;
+      throw std::system_error(errno, std::generic_category(), "Can't map the memory");
+    }
+  }
+
+  // the pages are not touched yet, so the policy applies to all of them
+  set_numa_policy(data_, mapped_size, policy, node);
+}
+
+large_buffer::~large_buffer() { release(); }
+
+large_buffer::large_buffer(large_buffer&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mapped_size(std::exchange(other.mapped_size, 0)),
+      pages_(std::exchange(other.pages_, page_kind::normal)) {}
+
+large_buffer& large_buffer::operator=(large_buffer&& other) noexcept {
+  if (this != &other) {
+    release();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    mapped_size = std::exchange(other.mapped_size, 0);
+    pages_ = std::exchange(other.pages_, page_kind::normal);
+  }
+  return *this;
+}
+
+void large_buffer::release() {
+  if (data_ != nullptr) {
+    ::munmap(data_, mapped_size);
+    data_ = nullptr;
+  }
+}
+
+void large_buffer::clear(unsigned threads) {
+  if (data_ == nullptr) {
+    return;
+  }
+  threads = threads != 0 ? threads : std::thread::hardware_concurrency();
+  // there is no point in splitting the memory smaller than a huge page
+  threads = static_cast<unsigned>(
+      std::clamp<size_t>(threads, 1, std::max<size_t>(size_ / huge_page_size, 1)));
+
+  auto* bytes = static_cast<char*>(data_);
+  auto chunk = ((size_ + threads - 1) / threads + 63) / 64 * 64;
+  auto clear_part = [&](unsigned n) {
+    auto first = std::min(size_, n * chunk);
+    auto last = std::min(size_, first + chunk);
+    std::memset(bytes + first, 0, last - first);
+  };
+
+  if (threads == 1) {
+    clear_part(0);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (unsigned n = 0; n < threads; ++n) {
+    workers.emplace_back(clear_part, n);
+  }
+  for (auto& t : workers) {
+    t.join();
+  }
+}
+
+}  // namespace slchess
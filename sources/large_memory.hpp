@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace slchess {
+
+/**
+ * How the pages of a large buffer are placed on the NUMA nodes.
+ */
+enum class numa_policy {
+  local,       ///< The default policy: a page goes to the node of the thread touching it first.
+  interleave,  ///< The pages are spread round robin over all the online nodes.
+  bind,        ///< All the pages are put on one node.
+};
+
+/**
+ * Kind of the pages backing a large buffer.
+ */
+enum class page_kind {
+  normal,
+  transparent_huge,  ///< Normal mapping aligned to the huge page with `MADV_HUGEPAGE` advice.
+  explicit_huge,     ///< `MAP_HUGETLB` mapping from the preallocated huge pages pool.
+};
+
+/**
+ * Zero initialized memory for the large engine tables, like the transposition table.
+ *
+ * The memory is mapped with `mmap` directly. When the size is at least one huge page (2MB),
+ * the explicit huge pages are tried first, and when there are none available, the mapping is
+ * aligned to the huge page size and advised as a transparent huge page candidate. That reduces
+ * the TLB misses of the random accesses to the table a lot.
+ *
+ * On the machines with many NUMA nodes the pages can be interleaved over all the nodes, so all
+ * the threads have the same average latency, or bound to one node. On a single node machine
+ * the policy doesn't change anything.
+ */
+class large_buffer {
+ public:
+  static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+ private:
+  void* data_ = nullptr;
+  size_t size_ = 0;
+  size_t mapped_size = 0;
+  page_kind pages_ = page_kind::normal;
+
+  void release();
+
+ public:
+  /**
+   * Creates an empty buffer.
+   */
+  large_buffer() = default;
+
+  /**
+   * Maps the memory, its content is zeroed by the kernel.
+   *
+   * @param size Size in bytes.
+   * @param policy NUMA placement of the pages.
+   * @param node Node used with the `numa_policy::bind`.
+   * @throws std::system_error when the memory can't be mapped.
+   */
+  explicit large_buffer(size_t size, numa_policy policy = numa_policy::interleave, int node = 0);
+  ~large_buffer();
+
+  large_buffer(large_buffer&& other) noexcept;
+  large_buffer& operator=(large_buffer&& other) noexcept;
+  large_buffer(const large_buffer&) = delete;
+  large_buffer& operator=(const large_buffer&) = delete;
+
+  /**
+   * Zeroes the memory using many threads.
+   *
+   * Every thread clears its own contiguous part, so a big table is cleared in a fraction of
+   * the time needed by one thread.
+   *
+   * @param threads Number of the threads, 0 means all the cores.
+   */
+  void clear(unsigned threads = 0);
+
+  [[nodiscard]] void* data() const { return data_; }
+
+  [[nodiscard]] size_t size() const { return size_; }
+
+  [[nodiscard]] page_kind pages() const { return pages_; }
+};
+
+/**
+ * Returns the number of the online NUMA nodes, at least 1.
+ */
+[[nodiscard]] unsigned numa_nodes();
+
+}  // namespace slchess
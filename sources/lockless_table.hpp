@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace slchess {
+
+namespace detail {
+
+/**
+ * Returns the high 64 bits of the 128 bit product, from the four 32 bit partial products.
+ */
+[[nodiscard]] constexpr uint64_t multiply_high_portable(uint64_t a, uint64_t b) {
+  auto a_low = a & 0xffffffff;
+  auto a_high = a >> 32;
+  auto b_low = b & 0xffffffff;
+  auto b_high = b >> 32;
+  auto low_low = a_low * b_low;
+  auto high_low = a_high * b_low;
+  auto low_high = a_low * b_high;
+  auto high_high = a_high * b_high;
+  auto middle = (low_low >> 32) + (high_low & 0xffffffff) + low_high;
+  return high_high + (high_low >> 32) + (middle >> 32);
+}
+
+}  // namespace detail
+
+/**
+ * Returns the high 64 bits of the 128 bit product, a single instruction on the 64 bit targets.
+ */
+[[nodiscard]] constexpr uint64_t multiply_high(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+  return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+  return detail::multiply_high_portable(a, b);
+#endif
+}
+
+/**
+ * An entry of a lockless hash table: the data and the key xor-ed with the data.
+ *
+ * The words are read and written separately without any locks, so the table can be shared by
+ * many threads, or by many processes through a shared memory mapping. A torn entry (two writers
+ * of the same entry at once) doesn't match its key and is treated as missing. The zero data
+ * marks an empty entry, so the stored data must never be zero.
+ */
+struct lockless_entry {
+  uint64_t key_xor_data;
+  uint64_t data;
+
+  [[nodiscard]] uint64_t load_data() const { return load(data); }
+
+  /**
+   * Returns true if the entry with the data, read by `load_data`, belongs to the key.
+   */
+  [[nodiscard]] bool matches(uint64_t key, uint64_t entry_data) const {
+    return entry_data != 0 && (load(key_xor_data) ^ entry_data) == key;
+  }
+
+  void save(uint64_t key, uint64_t new_data) {
+    std::atomic_ref(key_xor_data).store(key ^ new_data, std::memory_order_relaxed);
+    std::atomic_ref(data).store(new_data, std::memory_order_relaxed);
+  }
+
+ private:
+  [[nodiscard]] static uint64_t load(const uint64_t& word) {
+    return std::atomic_ref(const_cast<uint64_t&>(word)).load(std::memory_order_relaxed);
+  }
+};
+
+static_assert(sizeof(lockless_entry) == 16, "lockless_entry must be two words.");
+
+/**
+ * The lockless entries split into the buckets of four entries, one cache line each. A key is
+ * looked up only in its own bucket, chosen by the high bits of `key * buckets`, so any number
+ * of buckets works without a division.
+ *
+ * It doesn't own the memory, so it's used for the memory of any kind, e.g. the huge pages of
+ * the transposition table or the memory mapped file of the analysis cache.
+ */
+class lockless_table {
+ public:
+  static constexpr size_t bucket_size = 4;
+
+  /**
+   * The entry chosen for storing a key.
+   */
+  struct slot {
+    lockless_entry* entry;
+    uint64_t data;  ///< Data of the entry, zero when it's empty.
+    bool same_key;  ///< The entry already belongs to the key.
+  };
+
+ private:
+  lockless_entry* entries = nullptr;
+  uint64_t buckets = 0;
+
+ public:
+  lockless_table() = default;
+
+  /**
+   * @param memory Memory of the zero initialized entries, `count * bucket_size` of them.
+   * @param count Number of the buckets, at least one.
+   */
+  lockless_table(void* memory, uint64_t count)
+      : entries(static_cast<lockless_entry*>(memory)), buckets(count) {}
+
+  [[nodiscard]] lockless_entry* bucket(uint64_t key) const {
+    return entries + multiply_high(key, buckets) * bucket_size;
+  }
+
+  /**
+   * Returns the data stored for the key, or zero when it's missing.
+   */
+  [[nodiscard]] uint64_t probe(uint64_t key) const {
+    auto* first = bucket(key);
+    for (auto* e = first; e != first + bucket_size; ++e) {
+      auto data = e->load_data();
+      if (e->matches(key, data)) {
+        return data;
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * Chooses the entry of the bucket for storing the key: the entry of the same key, or the first
+   * empty entry, or the entry with the lowest `value(data)`.
+   */
+  template <typename F>
+  [[nodiscard]] slot find_slot(uint64_t key, F&& value) const {
+    auto* first = bucket(key);
+    slot replaced{first, 0, false};
+    int replaced_value = 0;
+    for (auto* e = first; e != first + bucket_size; ++e) {
+      auto data = e->load_data();
+      if (data == 0 || e->matches(key, data)) {
+        return {e, data, data != 0};
+      }
+      int entry_value = value(data);
+      if (e == first || entry_value < replaced_value) {
+        replaced = {e, data, false};
+        replaced_value = entry_value;
+      }
+    }
+    return replaced;
+  }
+
+  /**
+   * Returns the entry `n` of the table, for sampling the table.
+   */
+  [[nodiscard]] const lockless_entry& entry(size_t n) const { return entries[n]; }
+
+  [[nodiscard]] uint64_t bucket_count() const { return buckets; }
+
+  [[nodiscard]] size_t capacity() const { return buckets * bucket_size; }
+};
+
+}  // namespace slchess
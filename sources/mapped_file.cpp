@@ -0,0 +1,48 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+namespace slchess {
+
+mapped_file::mapped_file(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), "Can't open " + path);
+  }
+
+  struct stat info {};
+  if (::fstat(fd, &info) != 0) {
+    auto error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(), "Can't stat " + path);
+  }
+  size_ = static_cast<size_t>(info.st_size);
+
+  // mmap doesn't accept the zero length, an empty file is just an empty view
+  if (size_ > 0) {
+    void* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED) {
+      auto error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "Can't map " + path);
+    }
+    // the files are read mostly from the beginning to the end
+    ::madvise(address, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(address);
+  }
+  ::close(fd);
+}
+
+mapped_file::~mapped_file() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+}  // namespace slchess
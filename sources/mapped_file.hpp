@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace slchess {
+
+/**
+ * A read only memory mapped file.
+ *
+ * The content is available as a `std::string_view`, so it can be parsed without copying
+ * it to the memory first. The pages are loaded by the kernel when they are read.
+ */
+class mapped_file {
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+
+ public:
+  /**
+   * Maps the whole file.
+   *
+   * @throws std::system_error when the file can't be opened or mapped.
+   */
+  explicit mapped_file(const std::string& path);
+  ~mapped_file();
+
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  [[nodiscard]] std::string_view view() const { return {data_, size_}; }
+
+  [[nodiscard]] size_t size() const { return size_; }
+};
+
+}  // namespace slchess
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "chess.hpp"
+
+namespace slchess {
+
+/**
+ * A chess move packed in 16 bits.
+ *
+ * The bits 0-5 keep the origin square, 6-11 the target square and 12-15 the move flags.
+ * The flags tell if the move is a capture, a promotion (and to which piece), castling,
+ * en passant or a pawn double push, so the move can be made without looking at the board.
+ *
+ * The default constructed move (a1a1) is used as "no move".
+ */
+class move {
+ public:
+  enum flag : uint8_t {
+    quiet = 0,
+    double_push = 1,
+    king_castle = 2,
+    queen_castle = 3,
+    capture = 4,
+    en_passant = 5,
+    knight_promotion = 8,
+    bishop_promotion = 9,
+    rook_promotion = 10,
+    queen_promotion = 11,
+    knight_promotion_capture = 12,
+    bishop_promotion_capture = 13,
+    rook_promotion_capture = 14,
+    queen_promotion_capture = 15,
+  };
+
+ private:
+  uint16_t data = 0;
+
+ public:
+  constexpr move() = default;
+
+  constexpr move(square_index from, square_index to, flag f = quiet)
+      : data(static_cast<uint16_t>(from | (to << 6) | (f << 12))) {}
+
+  /**
+   * Creates the move from the raw 16 bit representation.
+   */
+  [[nodiscard]] static constexpr move from_raw(uint16_t raw) {
+    move m;
+    m.data = raw;
+    return m;
+  }
+
+  [[nodiscard]] constexpr uint16_t raw() const { return data; }
+
+  [[nodiscard]] constexpr square_index from() const { return data & 63; }
+
+  [[nodiscard]] constexpr square_index to() const { return (data >> 6) & 63; }
+
+  [[nodiscard]] constexpr flag flags() const { return flag(data >> 12); }
+
+  [[nodiscard]] constexpr bool is_capture() const { return (flags() & capture) != 0; }
+
+  [[nodiscard]] constexpr bool is_promotion() const { return (flags() & 8) != 0; }
+
+  [[nodiscard]] constexpr bool is_castling() const {
+    return flags() == king_castle || flags() == queen_castle;
+  }
+
+  /**
+   * Returns the piece type the pawn is promoted to, valid only for promotions.
+   */
+  [[nodiscard]] constexpr piece_type promotion_type() const {
+    return piece_type(knight + (flags() & 3));
+  }
+
+  [[nodiscard]] constexpr bool is_none() const { return data == 0; }
+
+  [[nodiscard]] constexpr bool operator==(const move& rhs) const = default;
+
+  /**
+   * Returns the move in the UCI notation, e.g. "e2e4" or "e7e8q".
+   */
+  [[nodiscard]] std::string to_uci() const {
+    if (is_none()) {
+      return "0000";
+    }
+    auto result = square_name(from()) + square_name(to());
+    if (is_promotion()) {
+      result += "nbrq"[promotion_type() - knight];
+    }
+    return result;
+  }
+};
+
+/**
+ * A fixed size list of moves, large enough for any legal chess position.
+ */
+class move_list {
+ public:
+  static constexpr size_t max_moves = 256;
+
+ private:
+  std::array<move, max_moves> moves;
+  size_t count = 0;
+
+ public:
+  void push_back(move m) { moves[count++] = m; }
+
+  void clear() { count = 0; }
+
+  [[nodiscard]] size_t size() const { return count; }
+
+  [[nodiscard]] bool empty() const { return count == 0; }
+
+  [[nodiscard]] move& operator[](size_t n) { return moves[n]; }
+
+  [[nodiscard]] const move& operator[](size_t n) const { return moves[n]; }
+
+  [[nodiscard]] move* begin() { return moves.data(); }
+
+  [[nodiscard]] move* end() { return moves.data() + count; }
+
+  [[nodiscard]] const move* begin() const { return moves.data(); }
+
+  [[nodiscard]] const move* end() const { return moves.data() + count; }
+};
+
+}  // namespace slchess
@@ -0,0 +1,194 @@
+#include "move_picker.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "evaluate.hpp"
+#include "movegen.hpp"
+
+namespace slchess {
+
+namespace {
+
+/**
+ * MVV-LVA: the most valuable victim first, then the least valuable attacker.
+ */
+int capture_score(const position& pos, move m) {
+  auto attacker = type_of(pos.piece_on(m.from()));
+  int score = -piece_values[attacker];
+  if (m.is_capture()) {
+    auto victim = m.flags() == move::en_passant ? pawn : type_of(pos.piece_on(m.to()));
+    score += piece_values[victim] * 16;
+  }
+  if (m.is_promotion()) {
+    score += piece_values[m.promotion_type()] * 16;
+  }
+  return score;
+}
+
+}  // namespace
+
+move history_tables::countermove(const position& pos, move previous) const {
+  if (previous.is_none()) {
+    return {};
+  }
+  return countermoves[countermove_index(pos.piece_on(previous.to()), previous.to())];
+}
+
+void history_tables::clear() {
+  history.fill(0);
+  killers.fill({});
+  countermoves.fill({});
+}
+
+void history_tables::new_search() {
+  for (auto& score : history) {
+    score /= 2;
+  }
+  killers.fill({});
+}
+
+void history_tables::update(const position& pos,
+                            move best,
+                            std::span<const move> tried,
+                            int depth,
+                            int ply,
+                            move previous) {
+  auto side = pos.side_to_move();
+  int bonus = std::min(depth * depth, 1200);
+  // the update is smaller near the limit, so the scores never leave the range
+  auto add = [&](move m, int value) {
+    auto& score = history[history_index(side, m)];
+    score += value - score * std::abs(value) / history_max;
+  };
+  add(best, bonus);
+  for (auto m : tried) {
+    add(m, -bonus);
+  }
+
+  if (killers[ply][0] != best) {
+    killers[ply][1] = killers[ply][0];
+    killers[ply][0] = best;
+  }
+  if (!previous.is_none()) {
+    countermoves[countermove_index(pos.piece_on(previous.to()), previous.to())] = best;
+  }
+}
+
+move_picker::move_picker(const position& node,
+                         move hash,
+                         const history_tables& history,
+                         int ply,
+                         move previous)
+    : pos(node), tables(history), current(stage::hash_move), captures_only(false) {
+  if (is_pseudo_legal(pos, hash)) {
+    hash_move = hash;
+  }
+
+  // the refutations are quiet moves from other positions, so they are checked here
+  size_t count = 0;
+  auto add_refutation = [&](move m) {
+    if (!m.is_capture() && !m.is_promotion() && m != hash_move &&
+        std::find(refutations.begin(), refutations.begin() + count, m) ==
+            refutations.begin() + count &&
+        is_pseudo_legal(pos, m)) {
+      refutations[count++] = m;
+    }
+  };
+  add_refutation(tables.killers[ply][0]);
+  add_refutation(tables.killers[ply][1]);
+  add_refutation(tables.countermove(pos, previous));
+}
+
+move_picker::move_picker(const position& node, const history_tables& history)
+    : pos(node),
+      tables(history),
+      current(stage::init_captures),
+      captures_only(!node.in_check()) {}
+
+bool move_picker::is_refutation(move m) const {
+  return std::find(refutations.begin(), refutations.end(), m) != refutations.end();
+}
+
+move move_picker::pick_best() {
+  // selection sort step, most nodes use only a few moves of the list
+  size_t best = index;
+  for (size_t n = index + 1; n < moves.size(); ++n) {
+    if (scores[n] > scores[best]) {
+      best = n;
+    }
+  }
+  std::swap(moves[index], moves[best]);
+  std::swap(scores[index], scores[best]);
+  return moves[index++];
+}
+
+move move_picker::next() {
+  while (true) {
+    switch (current) {
+      case stage::hash_move:
+        current = stage::init_captures;
+        if (!hash_move.is_none()) {
+          return hash_move;
+        }
+        break;
+
+      case stage::init_captures:
+        moves.clear();
+        generate<gen_type::captures>(pos, moves);
+        for (size_t n = 0; n < moves.size(); ++n) {
+          scores[n] = capture_score(pos, moves[n]);
+        }
+        index = 0;
+        current = stage::captures;
+        break;
+
+      case stage::captures:
+        while (index < moves.size()) {
+          auto m = pick_best();
+          if (m != hash_move) {
+            return m;
+          }
+        }
+        current = captures_only ? stage::done : stage::refutations;
+        break;
+
+      case stage::refutations:
+        while (refutation_index < refutations.size()) {
+          auto m = refutations[refutation_index++];
+          if (!m.is_none()) {
+            return m;
+          }
+        }
+        current = stage::init_quiets;
+        break;
+
+      case stage::init_quiets: {
+        moves.clear();
+        generate<gen_type::quiets>(pos, moves);
+        auto side = pos.side_to_move();
+        for (size_t n = 0; n < moves.size(); ++n) {
+          scores[n] = tables.history_score(side, moves[n]);
+        }
+        index = 0;
+        current = stage::quiets;
+        break;
+      }
+
+      case stage::quiets:
+        while (index < moves.size()) {
+          auto m = pick_best();
+          if (m != hash_move && !is_refutation(m)) {
+            return m;
+          }
+        }
+        current = stage::done;
+        break;
+
+      case stage::done:
+        return {};
+    }
+  }
+}
+
+}  // namespace slchess
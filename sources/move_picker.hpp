@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "move.hpp"
+#include "position.hpp"
+
+namespace slchess {
+
+constexpr int max_ply = 128;
+
+/**
+ * The move ordering statistics of one search thread: the history, killer and countermove
+ * tables.
+ *
+ * The tables are flat arrays indexed with the square indices, so an update or a lookup is one
+ * multiply-add and one memory access. They are not shared, every searcher has its own tables.
+ */
+struct history_tables {
+  /// The history scores are kept in the range [-history_max, history_max].
+  static constexpr int history_max = 16384;
+
+  std::array<int, 2 * 64 * 64> history{};             ///< [color][from][to]
+  std::array<std::array<move, 2>, max_ply> killers{};  ///< [ply][slot]
+  std::array<move, 16 * 64> countermoves{};           ///< [piece][to] of the previous move
+
+  [[nodiscard]] static constexpr size_t history_index(color side, move m) {
+    return coordinates_to_index(m.to(), side * 64 + m.from(), 64);
+  }
+
+  [[nodiscard]] static constexpr size_t countermove_index(piece p, square_index to) {
+    return coordinates_to_index(to, p, 64);
+  }
+
+  [[nodiscard]] int history_score(color side, move m) const {
+    return history[history_index(side, m)];
+  }
+
+  /**
+   * Returns the move which refuted the previous move the last time, or "no move".
+   */
+  [[nodiscard]] move countermove(const position& pos, move previous) const;
+
+  /**
+   * Removes all the statistics, e.g. before a new game.
+   */
+  void clear();
+
+  /**
+   * Prepares the tables for the next search: the killers are removed, as they are relative
+   * to the root, and the history scores are halved, so the new statistics count more.
+   */
+  void new_search();
+
+  /**
+   * Updates the tables after the quiet move caused a beta cutoff.
+   *
+   * The move gets the history bonus and becomes the killer of the ply and the countermove of
+   * the previous move; the quiet moves searched before it get the history penalty.
+   *
+   * @param pos Position of the cutoff.
+   * @param best Quiet move which caused the cutoff.
+   * @param tried Quiet moves searched before the best one.
+   * @param previous Move which led to the position, "no move" at the root.
+   */
+  void update(const position& pos,
+              move best,
+              std::span<const move> tried,
+              int depth,
+              int ply,
+              move previous);
+};
+
+/**
+ * Returns the moves of the position in the order of the search, generating them lazily.
+ *
+ * The moves are returned in the stages: the hash move, the captures and the promotions
+ * (MVV-LVA), the killers, the countermove and the quiet moves by the history score. The captures
+ * are generated only when the hash move didn't cause a cutoff, and the quiet moves only when no
+ * capture did, so most of the cut nodes never generate their quiet moves.
+ *
+ * There is no exchange evaluation, so the losing captures are not moved behind the quiet moves:
+ * guessing them from the piece values alone cost more nodes than it saved.
+ *
+ * The returned moves are pseudo legal, every move is returned once.
+ */
+class move_picker {
+ public:
+  enum class stage : uint8_t {
+    hash_move,
+    init_captures,
+    captures,
+    refutations,
+    init_quiets,
+    quiets,
+    done,
+  };
+
+ private:
+  const position& pos;
+  const history_tables& tables;
+  stage current;
+  bool captures_only;
+  move hash_move;
+  std::array<move, 3> refutations{};  ///< Two killers and the countermove.
+  size_t refutation_index = 0;
+
+  move_list moves;
+  std::array<int, move_list::max_moves> scores;  ///< Set for the moves when they are generated.
+  size_t index = 0;
+
+  [[nodiscard]] bool is_refutation(move m) const;
+  move pick_best();
+
+ public:
+  /**
+   * Creates the picker for the main search.
+   *
+   * @param hash Move from the transposition table or the previous iteration, it's checked.
+   * @param previous Move which led to the position, for the countermove.
+   */
+  move_picker(const position& node,
+              move hash,
+              const history_tables& history,
+              int ply,
+              move previous);
+
+  /**
+   * Creates the picker for the quiescence search: only the captures and the promotions, or all
+   * the moves when the side to move is in check.
+   */
+  move_picker(const position& node, const history_tables& history);
+
+  /**
+   * Returns the next move, or "no move" when all of them were returned.
+   */
+  move next();
+
+  [[nodiscard]] stage current_stage() const { return current; }
+};
+
+}  // namespace slchess
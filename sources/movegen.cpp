@@ -0,0 +1,351 @@
+#include "movegen.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace slchess {
+
+namespace {
+
+template <gen_type type_>
+constexpr bool with_captures = type_ != gen_type::quiets;
+
+template <gen_type type_>
+constexpr bool with_quiets = type_ != gen_type::captures;
+
+void add_promotions(move_list& moves, square_index from, square_index to, bool capture) {
+  auto base = capture ? move::knight_promotion_capture : move::knight_promotion;
+  // the queen first, it's almost always the best one
+  for (int n = 3; n >= 0; --n) {
+    moves.push_back(move(from, to, move::flag(base + n)));
+  }
+}
+
+template <gen_type type_>
+void generate_pawn_moves(const position& pos, move_list& moves) {
+  auto us = pos.side_to_move();
+  auto occupied = pos.pieces();
+  auto enemies = pos.pieces(~us);
+  int up = us == white ? 8 : -8;
+  size_t start_rank = us == white ? 1 : 6;
+  size_t last_rank = us == white ? 7 : 0;
+
+  for_each_square(pos.pieces(us, pawn), [&](square_index from) {
+    auto to = static_cast<square_index>(from + up);
+    bool promotion = rank_of(to) == last_rank;
+
+    if (!occupied.get(File(file_of(to)), Rank(rank_of(to)))) {
+      if (promotion) {
+        if constexpr (with_captures<type_>) {
+          add_promotions(moves, from, to, false);
+        }
+      } else if constexpr (with_quiets<type_>) {
+        moves.push_back(move(from, to));
+        auto double_to = static_cast<square_index>(to + up);
+        if (rank_of(from) == start_rank &&
+            !occupied.get(File(file_of(double_to)), Rank(rank_of(double_to)))) {
+          moves.push_back(move(from, double_to, move::double_push));
+        }
+      }
+    }
+
+    if constexpr (with_captures<type_>) {
+      for_each_square(pawn_attacks(us, from) & enemies, [&](square_index target) {
+        if (promotion) {
+          add_promotions(moves, from, target, true);
+        } else {
+          moves.push_back(move(from, target, move::capture));
+        }
+      });
+      auto ep = pos.en_passant();
+      if (ep != no_square && (pawn_attacks(us, from) & square_board(ep)).any()) {
+        moves.push_back(move(from, ep, move::en_passant));
+      }
+    }
+  });
+}
+
+template <gen_type type_>
+void add_piece_moves(move_list& moves,
+                     square_index from,
+                     const chessboard& targets,
+                     const chessboard& enemies) {
+  if constexpr (with_captures<type_>) {
+    for_each_square(targets & enemies,
+                    [&](square_index to) { moves.push_back(move(from, to, move::capture)); });
+  }
+  if constexpr (with_quiets<type_>) {
+    for_each_square(targets & ~enemies, [&](square_index to) { moves.push_back(move(from, to)); });
+  }
+}
+
+void generate_castling(const position& pos, move_list& moves) {
+  auto us = pos.side_to_move();
+  auto rights = pos.castling_rights();
+  auto occupied = pos.pieces();
+  size_t rank = us == white ? 0 : 7;
+  auto king_from = make_square(4, rank);
+  auto king_side = us == white ? white_king_side : black_king_side;
+  auto queen_side = us == white ? white_queen_side : black_queen_side;
+
+  if ((rights & (king_side | queen_side)) == 0 || pos.piece_on(king_from) != make_piece(us, king) ||
+      pos.is_attacked(king_from, ~us)) {
+    return;
+  }
+
+  auto empty = [&](size_t file) { return !occupied.get(File(file), Rank(rank)); };
+  auto safe = [&](size_t file) { return !pos.is_attacked(make_square(file, rank), ~us); };
+  auto rook_on = [&](size_t file) {
+    return pos.piece_on(make_square(file, rank)) == make_piece(us, rook);
+  };
+
+  if ((rights & king_side) != 0 && rook_on(7) && empty(5) && empty(6) && safe(5) && safe(6)) {
+    moves.push_back(move(king_from, make_square(6, rank), move::king_castle));
+  }
+  if ((rights & queen_side) != 0 && rook_on(0) && empty(1) && empty(2) && empty(3) && safe(3) &&
+      safe(2)) {
+    moves.push_back(move(king_from, make_square(2, rank), move::queen_castle));
+  }
+}
+
+}  // namespace
+
+template <gen_type type_>
+void generate(const position& pos, move_list& moves) {
+  auto us = pos.side_to_move();
+  auto occupied = pos.pieces();
+  auto enemies = pos.pieces(~us);
+  auto targets = ~pos.pieces(us);
+
+  generate_pawn_moves<type_>(pos, moves);
+
+  for_each_square(pos.pieces(us, knight), [&](square_index from) {
+    add_piece_moves<type_>(moves, from, knight_attacks(from) & targets, enemies);
+  });
+  for_each_square(pos.pieces(us, bishop), [&](square_index from) {
+    add_piece_moves<type_>(moves, from, bishop_attacks(from, occupied) & targets, enemies);
+  });
+  for_each_square(pos.pieces(us, rook), [&](square_index from) {
+    add_piece_moves<type_>(moves, from, rook_attacks(from, occupied) & targets, enemies);
+  });
+  for_each_square(pos.pieces(us, queen), [&](square_index from) {
+    add_piece_moves<type_>(moves, from, queen_attacks(from, occupied) & targets, enemies);
+  });
+
+  auto king_from = pos.king_square(us);
+  add_piece_moves<type_>(moves, king_from, king_attacks(king_from) & targets, enemies);
+
+  if constexpr (with_quiets<type_>) {
+    generate_castling(pos, moves);
+  }
+}
+
+template void generate<gen_type::captures>(const position&, move_list&);
+template void generate<gen_type::quiets>(const position&, move_list&);
+template void generate<gen_type::all>(const position&, move_list&);
+
+bool is_pseudo_legal(const position& pos, move m) {
+  auto us = pos.side_to_move();
+  auto from = m.from();
+  auto to = m.to();
+  auto moving = pos.piece_on(from);
+  auto target = pos.piece_on(to);
+  if (m.is_none() || moving == no_piece || color_of(moving) != us ||
+      (target != no_piece && color_of(target) == us)) {
+    return false;
+  }
+
+  if (m.is_castling()) {
+    move_list castling;
+    generate_castling(pos, castling);
+    return std::find(castling.begin(), castling.end(), m) != castling.end();
+  }
+
+  auto type = type_of(moving);
+  if (type != pawn) {
+    if (m.flags() != (target != no_piece ? move::capture : move::quiet)) {
+      return false;
+    }
+    auto occupied = pos.pieces();
+    chessboard attacks = type == knight   ? knight_attacks(from)
+                         : type == bishop ? bishop_attacks(from, occupied)
+                         : type == rook   ? rook_attacks(from, occupied)
+                         : type == queen  ? queen_attacks(from, occupied)
+                                          : king_attacks(from);
+    return (attacks & square_board(to)).any();
+  }
+
+  if (m.flags() == move::en_passant) {
+    return to == pos.en_passant() && (pawn_attacks(us, from) & square_board(to)).any();
+  }
+  size_t last_rank = us == white ? 7 : 0;
+  if (m.is_capture() != (target != no_piece) || m.is_promotion() != (rank_of(to) == last_rank) ||
+      m.flags() == 6 || m.flags() == 7) {
+    return false;
+  }
+  if (m.is_capture()) {
+    return (pawn_attacks(us, from) & square_board(to)).any();
+  }
+
+  int up = us == white ? 8 : -8;
+  if (m.flags() == move::double_push) {
+    size_t start_rank = us == white ? 1 : 6;
+    return rank_of(from) == start_rank && to == from + 2 * up &&
+           pos.piece_on(static_cast<square_index>(from + up)) == no_piece;
+  }
+  return to == from + up;
+}
+
+bool is_legal(const position& pos, move m) {
+  auto us = pos.side_to_move();
+  position next = pos;
+  next.make_move(m);
+  return !next.is_attacked(next.king_square(us), ~us);
+}
+
+void generate_legal(const position& pos, move_list& moves) {
+  move_list pseudo;
+  generate<gen_type::all>(pos, pseudo);
+  moves.clear();
+  for (auto m : pseudo) {
+    if (is_legal(pos, m)) {
+      moves.push_back(m);
+    }
+  }
+}
+
+move parse_uci_move(const position& pos, std::string_view uci) {
+  move_list moves;
+  generate_legal(pos, moves);
+  for (auto m : moves) {
+    if (m.to_uci() == uci) {
+      return m;
+    }
+  }
+  return {};
+}
+
+move parse_san(const position& pos, std::string_view san) {
+  while (!san.empty() && std::string_view("+#!?").find(san.back()) != std::string_view::npos) {
+    san.remove_suffix(1);
+  }
+
+  move_list moves;
+  if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+    auto flag = san.size() == 3 ? move::king_castle : move::queen_castle;
+    generate<gen_type::quiets>(pos, moves);
+    for (auto m : moves) {
+      if (m.flags() == flag && is_legal(pos, m)) {
+        return m;
+      }
+    }
+    return {};
+  }
+
+  constexpr std::string_view piece_letters = "PNBRQK";
+  auto type = pawn;
+  if (!san.empty() && piece_letters.find(san.front()) != std::string_view::npos &&
+      san.front() != 'P') {
+    type = piece_type(piece_letters.find(san.front()));
+    san.remove_prefix(1);
+  }
+
+  auto promotion = no_piece_type;
+  if (san.size() >= 2 && piece_letters.find(san.back()) != std::string_view::npos) {
+    promotion = piece_type(piece_letters.find(san.back()));
+    san.remove_suffix(san[san.size() - 2] == '=' ? 2 : 1);
+  }
+
+  if (san.size() < 2) {
+    return {};
+  }
+  auto target_file = san[san.size() - 2];
+  auto target_rank = san[san.size() - 1];
+  if (target_file < 'a' || target_file > 'h' || target_rank < '1' || target_rank > '8') {
+    return {};
+  }
+  auto target = make_square(target_file - 'a', target_rank - '1');
+  san.remove_suffix(2);
+
+  // what's left is the optional disambiguation and the capture sign
+  int from_file = -1;
+  int from_rank = -1;
+  for (char c : san) {
+    if (c >= 'a' && c <= 'h') {
+      from_file = c - 'a';
+    } else if (c >= '1' && c <= '8') {
+      from_rank = c - '1';
+    } else if (c != 'x' && c != ':') {
+      return {};
+    }
+  }
+
+  generate<gen_type::all>(pos, moves);
+  move found;
+  for (auto m : moves) {
+    if (m.to() != target || type_of(pos.piece_on(m.from())) != type ||
+        (from_file >= 0 && file_of(m.from()) != static_cast<size_t>(from_file)) ||
+        (from_rank >= 0 && rank_of(m.from()) != static_cast<size_t>(from_rank)) ||
+        (m.is_promotion() ? m.promotion_type() != promotion : promotion != no_piece_type) ||
+        m.is_castling() || !is_legal(pos, m)) {
+      continue;
+    }
+    if (!found.is_none()) {
+      return {};
+    }
+    found = m;
+  }
+  return found;
+}
+
+uint64_t perft(const position& pos, int depth) {
+  move_list moves;
+  generate_legal(pos, moves);
+  if (depth <= 1) {
+    return depth == 1 ? moves.size() : 1;
+  }
+  uint64_t nodes = 0;
+  for (auto m : moves) {
+    position next = pos;
+    next.make_move(m);
+    nodes += perft(next, depth - 1);
+  }
+  return nodes;
+}
+
+namespace {
+
+void split_perft(const position& pos,
+                 int depth,
+                 int serial_depth,
+                 task_scheduler& scheduler,
+                 task_group& group,
+                 std::atomic<uint64_t>& nodes) {
+  if (depth <= serial_depth) {
+    nodes.fetch_add(perft(pos, depth), std::memory_order_relaxed);
+    return;
+  }
+  move_list moves;
+  generate_legal(pos, moves);
+  for (auto m : moves) {
+    position next = pos;
+    next.make_move(m);
+    scheduler.submit(group, [next, depth, serial_depth, &scheduler, &group, &nodes] {
+      split_perft(next, depth - 1, serial_depth, scheduler, group, nodes);
+    });
+  }
+}
+
+}  // namespace
+
+uint64_t perft(const position& pos, int depth, task_scheduler& scheduler, int serial_depth) {
+  std::atomic<uint64_t> nodes = 0;
+  task_group group;
+  scheduler.submit(group, [&] {
+    split_perft(pos, depth, std::max(serial_depth, 1), scheduler, group, nodes);
+  });
+  scheduler.wait(group);
+  return nodes.load();
+}
+
+}  // namespace slchess
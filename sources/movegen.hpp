@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "move.hpp"
+#include "position.hpp"
+#include "task_scheduler.hpp"
+
+namespace slchess {
+
+/**
+ * Which moves should be generated.
+ *
+ * The captures include all the promotions, so the quiescence search sees them too.
+ * The quiets are all the other moves, including castling.
+ */
+enum class gen_type { captures, quiets, all };
+
+/**
+ * Generates the pseudo legal moves and appends them to the list.
+ *
+ * The moves may leave the own king in check, all the other rules are checked (castling is not
+ * generated through or out of check).
+ */
+template <gen_type type_>
+void generate(const position& pos, move_list& moves);
+
+extern template void generate<gen_type::captures>(const position&, move_list&);
+extern template void generate<gen_type::quiets>(const position&, move_list&);
+extern template void generate<gen_type::all>(const position&, move_list&);
+
+/**
+ * Returns true if the pseudo legal move doesn't leave the own king in check.
+ */
+[[nodiscard]] bool is_legal(const position& pos, move m);
+
+/**
+ * Returns true if the move would be generated in the position by `generate<gen_type::all>`.
+ *
+ * It's much cheaper than generating the moves, so the moves which don't come from the move
+ * generator (e.g. from the transposition table or the killer moves) are checked with it.
+ */
+[[nodiscard]] bool is_pseudo_legal(const position& pos, move m);
+
+/**
+ * Generates all the legal moves, the list is cleared first.
+ */
+void generate_legal(const position& pos, move_list& moves);
+
+/**
+ * Finds the legal move for the UCI notation like "e2e4" or "e7e8q".
+ *
+ * @return The move, or the "no move" if it's not a legal move in the position.
+ */
+[[nodiscard]] move parse_uci_move(const position& pos, std::string_view uci);
+
+/**
+ * Finds the legal move for the SAN notation like "Nbd7", "exd8=Q+" or "O-O".
+ *
+ * The check and annotation suffixes ("+", "#", "!", "?") are ignored, the castling can be also
+ * written with zeros.
+ *
+ * @return The move, or the "no move" if it's not a legal move or it's ambiguous.
+ */
+[[nodiscard]] move parse_san(const position& pos, std::string_view san);
+
+/**
+ * Counts the leaf nodes of the legal move tree of the given depth.
+ */
+[[nodiscard]] uint64_t perft(const position& pos, int depth);
+
+/**
+ * Counts the leaf nodes in parallel.
+ *
+ * Every node above the last `serial_depth` plies becomes a task for each of its moves, so
+ * the workers steal whole subtrees, and the subtrees of `serial_depth` are counted serially.
+ */
+[[nodiscard]] uint64_t perft(const position& pos,
+                             int depth,
+                             task_scheduler& scheduler,
+                             int serial_depth = 4);
+
+}  // namespace slchess
@@ -0,0 +1,61 @@
+#include "packed_position.hpp"
+
+namespace slchess {
+
+position_fields fields_of(const position& pos) {
+  position_fields fields;
+  for (square_index sq = 0; sq < 64; ++sq) {
+    fields.board[sq] = pos.piece_on(sq);
+  }
+  fields.side = pos.side_to_move();
+  fields.castling_rights = pos.castling_rights();
+  fields.en_passant = pos.en_passant();
+  fields.halfmove_clock = static_cast<uint16_t>(pos.halfmove_clock());
+  fields.fullmove_number = static_cast<uint16_t>(pos.fullmove_number());
+  return fields;
+}
+
+position to_position(const position_fields& fields) {
+  position pos;
+  for (square_index sq = 0; sq < 64; ++sq) {
+    if (fields.board[sq] != no_piece) {
+      pos.put_piece(fields.board[sq], sq);
+    }
+  }
+  pos.set_state(fields.side,
+                fields.castling_rights,
+                fields.en_passant,
+                fields.halfmove_clock,
+                fields.fullmove_number);
+  pos.validate();
+  return pos;
+}
+
+size_t encode_positions(std::span<const position> positions,
+                        std::vector<uint8_t>& out,
+                        bool with_clocks) {
+  // the records are written straight to the output, which is shrunk to the real size at the end
+  auto start = out.size();
+  out.resize(start + positions.size() * max_packed_position_size);
+  auto size = start;
+  for (const auto& pos : positions) {
+    auto record = std::span(out).subspan(size).first<max_packed_position_size>();
+    size += encode_position(fields_of(pos), record, with_clocks);
+  }
+  out.resize(size);
+  return size - start;
+}
+
+std::vector<position> decode_positions(std::span<const uint8_t> in) {
+  std::vector<position> positions;
+  // a middlegame position takes about 25 bytes, it's only a hint for the allocation
+  positions.reserve(in.size() / 25);
+  while (!in.empty()) {
+    size_t used = 0;
+    positions.push_back(to_position(decode_position(in, used)));
+    in = in.subspan(used);
+  }
+  return positions;
+}
+
+}  // namespace slchess
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "chess.hpp"
+#include "position.hpp"
+
+namespace slchess {
+
+/**
+ * All the fields of a position kept by the packed encoding.
+ *
+ * It's a plain aggregate, so the positions can be encoded and decoded in the constant
+ * expressions too. Use `fields_of` and `to_position` to convert it from and to the `position`.
+ */
+struct position_fields {
+  std::array<piece, 64> board{};
+  color side = white;
+  uint8_t castling_rights = no_castling;
+  square_index en_passant = no_square;
+  uint16_t halfmove_clock = 0;
+  uint16_t fullmove_number = 1;
+
+  constexpr bool operator==(const position_fields&) const = default;
+};
+
+/// Size of the longest packed position: 64 pieces with the clocks.
+constexpr size_t max_packed_position_size = 8 + 32 + 1 + 4;
+
+namespace packed {
+
+/// Nibble code of the pawn which can be captured en passant. It's not used by the `piece`.
+constexpr uint8_t en_passant_pawn = 7;
+
+/// Bit of the state byte set when the clocks follow it.
+constexpr uint8_t clocks_flag = 1 << 5;
+
+/**
+ * Writes the 4 bit codes of the pieces on the occupied squares, from a1 to h8, the lower nibble
+ * first. This layout is shared by `encode_position` and the training samples.
+ *
+ * @param occupancy Bitboard of the occupied squares.
+ * @param code Returns the code of the piece on the occupied square.
+ * @param out Buffer for `(popcount(occupancy) + 1) / 2` bytes.
+ * @return Number of the bytes written.
+ */
+template <typename F>
+constexpr size_t write_piece_codes(uint64_t occupancy, F&& code, std::span<uint8_t> out) {
+  size_t n = 0;
+  for (uint64_t bits = occupancy; bits != 0; bits &= bits - 1, ++n) {
+    auto value = static_cast<uint8_t>(code(static_cast<square_index>(std::countr_zero(bits))) & 15);
+    if (n % 2 == 0) {
+      out[n / 2] = value;
+    } else {
+      out[n / 2] |= static_cast<uint8_t>(value << 4);
+    }
+  }
+  return (n + 1) / 2;
+}
+
+/**
+ * Calls `f(square, code)` for every occupied square with the code written by
+ * `write_piece_codes`.
+ */
+template <typename F>
+constexpr void read_piece_codes(uint64_t occupancy, std::span<const uint8_t> in, F&& f) {
+  size_t n = 0;
+  for (uint64_t bits = occupancy; bits != 0; bits &= bits - 1, ++n) {
+    f(static_cast<square_index>(std::countr_zero(bits)),
+      static_cast<uint8_t>((in[n / 2] >> (4 * (n % 2))) & 15));
+  }
+}
+
+}  // namespace packed
+
+/**
+ * Encodes the position into a variable length binary record.
+ *
+ * The record is:
+ *
+ * - the occupancy bitboard, 8 bytes, little-endian,
+ * - the 4 bit piece codes of the occupied squares from a1 to h8, the lower nibble first,
+ *   rounded up to the whole bytes,
+ * - the state byte: bit 0 is the side to move, bits 1-4 are the castling rights, bit 5 is set
+ *   when the clocks follow,
+ * - optionally the halfmove clock and the fullmove number, 2 bytes each, little-endian.
+ *
+ * The en passant square is not stored separately: the pawn which can be captured is stored with
+ * the `packed::en_passant_pawn` code. So a position with 32 pieces takes 25 bytes without the
+ * clocks and 29 bytes with them.
+ *
+ * The record without the clocks is the same for the same positions, so it can be used as
+ * an exact hash table key.
+ *
+ * @param out Buffer for the record.
+ * @param with_clocks Whether the clocks should be stored.
+ * @return Number of the bytes written.
+ * @throws std::invalid_argument when there is no pawn to capture on the en passant square.
+ */
+constexpr size_t encode_position(const position_fields& fields,
+                                 std::span<uint8_t, max_packed_position_size> out,
+                                 bool with_clocks = true) {
+  auto en_passant_pawn = no_square;
+  if (fields.en_passant != no_square) {
+    en_passant_pawn = fields.en_passant ^ 8;
+    if (en_passant_pawn >= 64 || fields.board[en_passant_pawn] != make_piece(~fields.side, pawn)) {
+      throw std::invalid_argument("En passant square without the pawn to capture.");
+    }
+  }
+
+  uint64_t occupancy = 0;
+  for (size_t sq = 0; sq < 64; ++sq) {
+    if (fields.board[sq] != no_piece) {
+      occupancy |= 1ULL << sq;
+    }
+  }
+  for (size_t n = 0; n < 8; ++n) {
+    out[n] = static_cast<uint8_t>(occupancy >> (8 * n));
+  }
+
+  size_t size = 8;
+  size += packed::write_piece_codes(
+      occupancy,
+      [&](square_index sq) {
+        return sq == en_passant_pawn ? packed::en_passant_pawn
+                                     : static_cast<uint8_t>(fields.board[sq]);
+      },
+      out.subspan(size));
+
+  out[size++] = static_cast<uint8_t>(fields.side | ((fields.castling_rights & all_castling) << 1) |
+                                     (with_clocks ? packed::clocks_flag : 0));
+  if (with_clocks) {
+    for (uint16_t value : {fields.halfmove_clock, fields.fullmove_number}) {
+      out[size++] = static_cast<uint8_t>(value);
+      out[size++] = static_cast<uint8_t>(value >> 8);
+    }
+  }
+  return size;
+}
+
+/**
+ * Decodes the position from the beginning of the record written by `encode_position`.
+ *
+ * The positions without the clocks get the halfmove clock 0 and the fullmove number 1.
+ *
+ * The record is checked for the piece codes, one king of each color, no pawns on the first and
+ * the last rank and the en passant pawn on the fourth rank of its side. The checks which need
+ * the attacks (the side not to move in check) are done by `to_position`.
+ *
+ * @param in Data starting with the record, it can be longer than the record.
+ * @param used Set to the size of the record.
+ * @throws std::invalid_argument when the data is too short or it's not a valid record.
+ */
+constexpr position_fields decode_position(std::span<const uint8_t> in, size_t& used) {
+  if (in.size() < 9) {
+    throw std::invalid_argument("Packed position is too short.");
+  }
+  uint64_t occupancy = 0;
+  for (size_t n = 0; n < 8; ++n) {
+    occupancy |= static_cast<uint64_t>(in[n]) << (8 * n);
+  }
+  auto count = static_cast<size_t>(std::popcount(occupancy));
+  size_t state = 8 + (count + 1) / 2;
+  if (in.size() <= state) {
+    throw std::invalid_argument("Packed position is too short.");
+  }
+
+  position_fields fields;
+  fields.side = color(in[state] & 1);
+  fields.castling_rights = (in[state] >> 1) & all_castling;
+
+  std::array<int, 2> kings{};
+  packed::read_piece_codes(occupancy, in.subspan(8), [&](square_index sq, uint8_t code) {
+    if (code == packed::en_passant_pawn) {
+      // the pawn has just moved two squares, to the fourth rank of its side
+      if (fields.en_passant != no_square) {
+        throw std::invalid_argument("Packed position has two en passant pawns.");
+      }
+      if (rank_of(sq) != (fields.side == white ? 4U : 3U)) {
+        throw std::invalid_argument("Packed position has an en passant pawn on a wrong rank.");
+      }
+      fields.en_passant = sq ^ 8;
+      code = make_piece(~fields.side, pawn);
+    } else if ((code & 7) == 0 || (code & 7) > 6) {
+      throw std::invalid_argument("Packed position has an invalid piece code.");
+    }
+    auto p = piece(code);
+    if (type_of(p) == pawn && (rank_of(sq) == 0 || rank_of(sq) == 7)) {
+      throw std::invalid_argument("Packed position has a pawn on the first or the last rank.");
+    }
+    if (type_of(p) == king) {
+      ++kings[color_of(p)];
+    }
+    fields.board[sq] = p;
+  });
+  if (kings[white] != 1 || kings[black] != 1) {
+    throw std::invalid_argument("Packed position must have exactly one king of each color.");
+  }
+
+  used = state + 1;
+  if ((in[state] & packed::clocks_flag) != 0) {
+    if (in.size() < used + 4) {
+      throw std::invalid_argument("Packed position is too short.");
+    }
+    fields.halfmove_clock = static_cast<uint16_t>(in[used] | (in[used + 1] << 8));
+    fields.fullmove_number = static_cast<uint16_t>(in[used + 2] | (in[used + 3] << 8));
+    used += 4;
+  }
+  return fields;
+}
+
+/**
+ * Returns the fields of the position for the encoding.
+ */
+[[nodiscard]] position_fields fields_of(const position& pos);
+
+/**
+ * Creates the position from the decoded fields.
+ *
+ * @throws std::invalid_argument when the position is not legal, see `position::validate`.
+ */
+[[nodiscard]] position to_position(const position_fields& fields);
+
+/**
+ * Encodes the positions one after another and appends them to the `out`.
+ *
+ * @return Number of the appended bytes.
+ */
+size_t encode_positions(std::span<const position> positions,
+                        std::vector<uint8_t>& out,
+                        bool with_clocks = true);
+
+/**
+ * Decodes all the positions written by `encode_positions`.
+ *
+ * @throws std::invalid_argument when the data is not a valid sequence of the records, or when
+ * a position is not legal.
+ */
+[[nodiscard]] std::vector<position> decode_positions(std::span<const uint8_t> in);
+
+}  // namespace slchess
@@ -0,0 +1,214 @@
+#include "pgn.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace slchess {
+
+namespace {
+
+bool is_blank(std::string_view line) {
+  return std::all_of(
+      line.begin(), line.end(), [](unsigned char c) { return std::isspace(c) != 0; });
+}
+
+std::string_view trim_left(std::string_view text) {
+  auto first = text.find_first_not_of(" \t\r\n");
+  return first == std::string_view::npos ? std::string_view() : text.substr(first);
+}
+
+bool is_result(std::string_view token) {
+  return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+}  // namespace
+
+std::vector<std::string_view> split_games(std::string_view text) {
+  std::vector<std::string_view> games;
+  size_t start = std::string_view::npos;
+  bool in_movetext = false;
+
+  for (size_t pos = 0; pos < text.size();) {
+    auto end = text.find('\n', pos);
+    if (end == std::string_view::npos) {
+      end = text.size();
+    }
+    auto line = trim_left(text.substr(pos, end - pos));
+
+    if (!line.empty() && line.front() == '[') {
+      if (start == std::string_view::npos || in_movetext) {
+        if (start != std::string_view::npos) {
+          games.push_back(text.substr(start, pos - start));
+        }
+        start = pos;
+        in_movetext = false;
+      }
+    } else if (!is_blank(line)) {
+      if (start == std::string_view::npos) {
+        start = pos;
+      }
+      in_movetext = true;
+    }
+    pos = end + 1;
+  }
+
+  if (start != std::string_view::npos) {
+    games.push_back(text.substr(start));
+  }
+  return games;
+}
+
+pgn_game::pgn_game(std::string_view text) {
+  // the tags are all the lines starting with '[' before the first movetext line
+  size_t pos = 0;
+  while (pos < text.size()) {
+    auto end = text.find('\n', pos);
+    if (end == std::string_view::npos) {
+      end = text.size();
+    }
+    auto line = trim_left(text.substr(pos, end - pos));
+    if (!line.empty() && line.front() != '[') {
+      break;
+    }
+    pos = end + 1;
+  }
+  pos = std::min(pos, text.size());
+  tags_ = text.substr(0, pos);
+  movetext_ = text.substr(pos);
+}
+
+std::string_view pgn_game::tag(std::string_view name) const {
+  for (size_t pos = tags_.find('['); pos != std::string_view::npos; pos = tags_.find('[', pos)) {
+    ++pos;
+    auto line = trim_left(tags_.substr(pos));
+    if (line.substr(0, name.size()) != name || line.size() <= name.size() ||
+        std::isspace(static_cast<unsigned char>(line[name.size()])) == 0) {
+      continue;
+    }
+    auto open = line.find('"');
+    if (open == std::string_view::npos) {
+      continue;
+    }
+    // skip the escaped quotes
+    auto close = open + 1;
+    while (close < line.size() && line[close] != '"') {
+      close += line[close] == '\\' ? 2 : 1;
+    }
+    if (close >= line.size()) {
+      continue;
+    }
+    return line.substr(open + 1, close - open - 1);
+  }
+  return {};
+}
+
+void movetext_tokenizer::skip_until(char end) {
+  auto found = text.find(end, pos);
+  pos = found == std::string_view::npos ? text.size() : found + 1;
+}
+
+void movetext_tokenizer::skip_variation() {
+  // the variations can be nested and can have comments with parentheses
+  int depth = 1;
+  while (pos < text.size() && depth > 0) {
+    char c = text[pos++];
+    if (c == '(') {
+      ++depth;
+    } else if (c == ')') {
+      --depth;
+    } else if (c == '{') {
+      skip_until('}');
+    } else if (c == ';') {
+      skip_until('\n');
+    }
+  }
+}
+
+std::string_view movetext_tokenizer::next() {
+  while (pos < text.size()) {
+    char c = text[pos];
+    if (std::isspace(static_cast<unsigned char>(c)) != 0) {
+      ++pos;
+    } else if (c == '{') {
+      ++pos;
+      skip_until('}');
+    } else if (c == ';' || c == '%') {
+      skip_until('\n');
+    } else if (c == '(') {
+      ++pos;
+      skip_variation();
+    } else if (c == ')') {
+      ++pos;
+    } else if (c == '$') {
+      // numeric annotation glyph
+      ++pos;
+      while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos])) != 0) {
+        ++pos;
+      }
+    } else {
+      auto end = text.find_first_of(" \t\r\n{}();", pos);
+      if (end == std::string_view::npos) {
+        end = text.size();
+      }
+      auto token = text.substr(pos, end - pos);
+      pos = end;
+
+      if (is_result(token)) {
+        pos = text.size();
+        return {};
+      }
+      // the move number can be glued to the move, like "12.e4" or "12...e5"
+      auto number_end = token.find_first_not_of("0123456789");
+      if (number_end != 0 && number_end != std::string_view::npos && token[number_end] == '.') {
+        auto move_start = token.find_first_not_of('.', number_end);
+        token = move_start == std::string_view::npos ? std::string_view()
+                                                     : token.substr(move_start);
+      }
+      if (token.empty() || std::isdigit(static_cast<unsigned char>(token.front())) != 0) {
+        continue;
+      }
+      return token;
+    }
+  }
+  return {};
+}
+
+pgn_replay_stats replay_games(const std::vector<std::string_view>& games,
+                              unsigned threads,
+                              const pgn_visitor& visitor) {
+  task_scheduler scheduler(threads);
+  return replay_games(games, scheduler, visitor);
+}
+
+pgn_replay_stats replay_games(const std::vector<std::string_view>& games,
+                              task_scheduler& scheduler,
+                              const pgn_visitor& visitor) {
+  // the games are replayed in ranges, so a task isn't created for every game
+  constexpr size_t grain = 64;
+  std::vector<pgn_replay_stats> stats(scheduler.size());
+
+  scheduler.parallel_for(games.size(), grain, [&](size_t first, size_t last) {
+    auto id = static_cast<unsigned>(scheduler.worker_index());
+    auto& local = stats[id];
+    auto on_move = [&](const position& pos, move m) {
+      visitor(id, pos, m);
+      ++local.moves;
+    };
+    for (auto n = first; n < last; ++n) {
+      ++local.games;
+      if (!replay_game(games[n], on_move)) {
+        ++local.errors;
+      }
+    }
+  });
+
+  pgn_replay_stats total;
+  for (const auto& s : stats) {
+    total.games += s.games;
+    total.moves += s.moves;
+    total.errors += s.errors;
+  }
+  return total;
+}
+
+}  // namespace slchess
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "move.hpp"
+#include "movegen.hpp"
+#include "position.hpp"
+#include "task_scheduler.hpp"
+
+namespace slchess {
+
+/**
+ * Splits the PGN text into games.
+ *
+ * A new game starts with a tag line (a line starting with `[`) which follows the movetext of
+ * the previous game. The returned views point into the `text`, nothing is copied.
+ */
+[[nodiscard]] std::vector<std::string_view> split_games(std::string_view text);
+
+/**
+ * A view of one PGN game: the tag pairs section and the movetext.
+ *
+ * All the returned values point into the game text, so they are valid as long as the text is.
+ */
+class pgn_game {
+ private:
+  std::string_view tags_;
+  std::string_view movetext_;
+
+ public:
+  explicit pgn_game(std::string_view text);
+
+  /**
+   * Returns the value of the tag, e.g. `tag("White")`, or an empty view if there is no such tag.
+   *
+   * The escaped characters in the value are not unescaped.
+   */
+  [[nodiscard]] std::string_view tag(std::string_view name) const;
+
+  [[nodiscard]] std::string_view movetext() const { return movetext_; }
+};
+
+/**
+ * Splits the movetext into the SAN moves.
+ *
+ * The comments, variations, move numbers and the NAGs are skipped. The game termination marker
+ * ends the movetext. The returned tokens point into the movetext.
+ */
+class movetext_tokenizer {
+ private:
+  std::string_view text;
+  size_t pos = 0;
+
+  void skip_until(char end);
+  void skip_variation();
+
+ public:
+  explicit movetext_tokenizer(std::string_view movetext) : text(movetext) {}
+
+  /**
+   * Returns the next move, or an empty view when there are no more moves.
+   */
+  [[nodiscard]] std::string_view next();
+};
+
+/**
+ * Replays the game, calling `on_move(position, move)` for every move before it's made.
+ *
+ * The game starts from the position from the `FEN` tag, if there is one.
+ *
+ * @return True if all the moves were legal, false if the replay was stopped on an invalid move.
+ */
+template <typename F>
+bool replay_game(std::string_view text, F&& on_move) {
+  pgn_game game(text);
+  position pos;
+  try {
+    auto fen = game.tag("FEN");
+    pos = fen.empty() ? position::start() : position::from_fen(fen);
+  } catch (const std::invalid_argument&) {
+    return false;
+  }
+
+  movetext_tokenizer tokens(game.movetext());
+  for (auto token = tokens.next(); !token.empty(); token = tokens.next()) {
+    auto m = parse_san(pos, token);
+    if (m.is_none()) {
+      return false;
+    }
+    on_move(static_cast<const position&>(pos), m);
+    pos.make_move(m);
+  }
+  return true;
+}
+
+/**
+ * Statistics of replaying many games.
+ */
+struct pgn_replay_stats {
+  uint64_t games = 0;
+  uint64_t moves = 0;
+  uint64_t errors = 0;  ///< Number of games stopped on an invalid move.
+};
+
+/**
+ * Function called for every move of every game.
+ *
+ * The `worker` is the number of the thread calling the function, it's lower than the number of
+ * threads, so the callers can keep their results per thread without any locking.
+ */
+using pgn_visitor = std::function<void(unsigned worker, const position& pos, move m)>;
+
+/**
+ * Replays the games in parallel.
+ *
+ * @param games Games split with `split_games`.
+ * @param threads Number of the threads, 0 means all the cores.
+ * @param visitor Function called for every move, from many threads at once.
+ */
+pgn_replay_stats replay_games(const std::vector<std::string_view>& games,
+                              unsigned threads,
+                              const pgn_visitor& visitor);
+
+/**
+ * Replays the games on the workers of the scheduler, the `worker` is the worker index.
+ */
+pgn_replay_stats replay_games(const std::vector<std::string_view>& games,
+                              task_scheduler& scheduler,
+                              const pgn_visitor& visitor);
+
+/**
+ * A memory mapped PGN file split into games.
+ */
+class pgn_file {
+ private:
+  mapped_file file;
+  std::vector<std::string_view> games_;
+
+ public:
+  /**
+   * @throws std::system_error when the file can't be mapped.
+   */
+  explicit pgn_file(const std::string& path) : file(path), games_(split_games(file.view())) {}
+
+  [[nodiscard]] const std::vector<std::string_view>& games() const { return games_; }
+};
+
+}  // namespace slchess
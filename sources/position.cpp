@@ -0,0 +1,301 @@
+#include "position.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "zobrist.hpp"
+
+namespace slchess {
+
+namespace {
+
+constexpr std::string_view piece_chars = " PNBRQK  pnbrqk";
+
+/**
+ * Castling rights left after a move touching the square, e.g. moving from or to h1 loses
+ * the white king side castling.
+ */
+constexpr std::array<uint8_t, 64> make_castling_masks() {
+  std::array<uint8_t, 64> result{};
+  for (auto& mask : result) {
+    mask = all_castling;
+  }
+  result[make_square(0, 0)] = all_castling & ~white_queen_side;
+  result[make_square(7, 0)] = all_castling & ~white_king_side;
+  result[make_square(4, 0)] = all_castling & ~(white_king_side | white_queen_side);
+  result[make_square(0, 7)] = all_castling & ~black_queen_side;
+  result[make_square(7, 7)] = all_castling & ~black_king_side;
+  result[make_square(4, 7)] = all_castling & ~(black_king_side | black_queen_side);
+  return result;
+}
+
+constexpr auto castling_masks = make_castling_masks();
+
+/// The first and the last rank, where no pawn can be.
+constexpr uint64_t back_ranks = 0xff000000000000ffULL;
+
+}  // namespace
+
+position position::from_fen(std::string_view fen) {
+  std::istringstream input{std::string(fen)};
+  std::string placement, side_field, castling_field, en_passant_field;
+  unsigned halfmove = 0;
+  unsigned fullmove = 1;
+
+  if (!(input >> placement >> side_field >> castling_field >> en_passant_field)) {
+    throw std::invalid_argument("FEN must have at least four fields.");
+  }
+  if (!(input >> halfmove)) {
+    halfmove = 0;
+  } else if (!(input >> fullmove)) {
+    fullmove = 1;
+  }
+
+  position pos;
+
+  size_t file = 0;
+  size_t rank = 7;
+  for (char c : placement) {
+    if (c == '/') {
+      if (file != 8 || rank == 0) {
+        throw std::invalid_argument("FEN has wrong number of squares in a rank.");
+      }
+      file = 0;
+      --rank;
+    } else if (c >= '1' && c <= '8') {
+      file += c - '0';
+    } else {
+      auto code = piece_chars.find(c);
+      if (code == std::string_view::npos || c == ' ' || file >= 8) {
+        throw std::invalid_argument("FEN has an invalid piece placement.");
+      }
+      pos.put_piece(piece(code), make_square(file, rank));
+      ++file;
+    }
+    if (file > 8) {
+      throw std::invalid_argument("FEN has wrong number of squares in a rank.");
+    }
+  }
+  if (rank != 0 || file != 8) {
+    throw std::invalid_argument("FEN has wrong number of ranks.");
+  }
+  if (side_field != "w" && side_field != "b") {
+    throw std::invalid_argument("FEN has an invalid side to move.");
+  }
+
+  uint8_t rights = no_castling;
+  if (castling_field != "-") {
+    for (char c : castling_field) {
+      switch (c) {
+        case 'K': rights |= white_king_side; break;
+        case 'Q': rights |= white_queen_side; break;
+        case 'k': rights |= black_king_side; break;
+        case 'q': rights |= black_queen_side; break;
+        default: throw std::invalid_argument("FEN has invalid castling rights.");
+      }
+    }
+  }
+
+  square_index en_passant = no_square;
+  if (en_passant_field != "-") {
+    if (en_passant_field.size() != 2 || en_passant_field[0] < 'a' || en_passant_field[0] > 'h' ||
+        (en_passant_field[1] != '3' && en_passant_field[1] != '6')) {
+      throw std::invalid_argument("FEN has an invalid en passant square.");
+    }
+    en_passant = make_square(en_passant_field[0] - 'a', en_passant_field[1] - '1');
+  }
+
+  pos.set_state(side_field == "w" ? white : black, rights, en_passant, halfmove, fullmove);
+  pos.validate();
+  return pos;
+}
+
+std::string position::to_fen() const {
+  std::string result;
+  for (size_t rank = 8; rank-- > 0;) {
+    int empty = 0;
+    for (size_t file = 0; file < 8; ++file) {
+      auto p = board[make_square(file, rank)];
+      if (p == no_piece) {
+        ++empty;
+        continue;
+      }
+      if (empty > 0) {
+        result += static_cast<char>('0' + empty);
+        empty = 0;
+      }
+      result += piece_chars[p];
+    }
+    if (empty > 0) {
+      result += static_cast<char>('0' + empty);
+    }
+    if (rank > 0) {
+      result += '/';
+    }
+  }
+
+  result += side == white ? " w " : " b ";
+
+  if (castling_rights_ == no_castling) {
+    result += '-';
+  } else {
+    if ((castling_rights_ & white_king_side) != 0) result += 'K';
+    if ((castling_rights_ & white_queen_side) != 0) result += 'Q';
+    if ((castling_rights_ & black_king_side) != 0) result += 'k';
+    if ((castling_rights_ & black_queen_side) != 0) result += 'q';
+  }
+
+  result += ' ';
+  result += en_passant_ == no_square ? "-" : square_name(en_passant_);
+  result += ' ' + std::to_string(halfmove_clock_) + ' ' + std::to_string(fullmove_number_);
+  return result;
+}
+
+chessboard position::attackers_to(square_index sq, const chessboard& occupied) const {
+  auto diagonal = by_type[bishop] | by_type[queen];
+  auto straight = by_type[rook] | by_type[queen];
+  return (pawn_attacks(black, sq) & pieces(white, pawn)) |
+         (pawn_attacks(white, sq) & pieces(black, pawn)) | (knight_attacks(sq) & by_type[knight]) |
+         (king_attacks(sq) & by_type[king]) | (bishop_attacks(sq, occupied) & diagonal) |
+         (rook_attacks(sq, occupied) & straight);
+}
+
+bool position::is_attacked(square_index sq, color by) const {
+  const auto& theirs = by_color[by];
+  if ((pawn_attacks(~by, sq) & by_type[pawn] & theirs).any() ||
+      (knight_attacks(sq) & by_type[knight] & theirs).any() ||
+      (king_attacks(sq) & by_type[king] & theirs).any()) {
+    return true;
+  }
+  auto occupied = pieces();
+  return (bishop_attacks(sq, occupied) & (by_type[bishop] | by_type[queen]) & theirs).any() ||
+         (rook_attacks(sq, occupied) & (by_type[rook] | by_type[queen]) & theirs).any();
+}
+
+void position::put_piece(piece p, square_index sq) {
+  board[sq] = p;
+  by_type[type_of(p)] |= square_board(sq);
+  by_color[color_of(p)] |= square_board(sq);
+  key_ ^= zobrist::piece_key(p, sq);
+}
+
+void position::remove_piece(square_index sq) {
+  auto p = board[sq];
+  board[sq] = no_piece;
+  by_type[type_of(p)] &= ~square_board(sq);
+  by_color[color_of(p)] &= ~square_board(sq);
+  key_ ^= zobrist::piece_key(p, sq);
+}
+
+void position::move_piece(square_index from, square_index to) {
+  auto p = board[from];
+  remove_piece(from);
+  put_piece(p, to);
+}
+
+void position::set_state(color side_to_move,
+                         uint8_t castling_rights,
+                         square_index en_passant,
+                         unsigned halfmove_clock,
+                         unsigned fullmove_number) {
+  key_ ^= zobrist::castling_key(castling_rights_) ^ zobrist::en_passant_key(en_passant_);
+  if (side == black) {
+    key_ ^= zobrist::side_key();
+  }
+
+  side = side_to_move;
+  castling_rights_ = castling_rights & all_castling;
+  en_passant_ = en_passant;
+  halfmove_clock_ = static_cast<uint16_t>(halfmove_clock);
+  fullmove_number_ = static_cast<uint16_t>(fullmove_number);
+
+  key_ ^= zobrist::castling_key(castling_rights_) ^ zobrist::en_passant_key(en_passant_);
+  if (side == black) {
+    key_ ^= zobrist::side_key();
+  }
+}
+
+void position::validate() const {
+  if (pieces(white, king).count() != 1 || pieces(black, king).count() != 1) {
+    throw std::invalid_argument("Position must have exactly one king of each color.");
+  }
+  if ((by_type[pawn].to_ullong() & back_ranks) != 0) {
+    throw std::invalid_argument("Position has a pawn on the first or the last rank.");
+  }
+  if (is_attacked(king_square(~side), side)) {
+    throw std::invalid_argument("Side not to move is in check.");
+  }
+  if (en_passant_ != no_square) {
+    // the pawn which has just moved two squares is in front of the target square
+    if (rank_of(en_passant_) != (side == white ? 5U : 2U) ||
+        board[en_passant_] != no_piece || board[en_passant_ ^ 8] != make_piece(~side, pawn)) {
+      throw std::invalid_argument("Position has an invalid en passant square.");
+    }
+  }
+}
+
+void position::make_move(move m) {
+  auto from = m.from();
+  auto to = m.to();
+  auto us = side;
+  auto them = ~side;
+  auto moving_type = type_of(board[from]);
+
+  key_ ^= zobrist::castling_key(castling_rights_) ^ zobrist::en_passant_key(en_passant_);
+  en_passant_ = no_square;
+  ++halfmove_clock_;
+
+  if (m.is_capture()) {
+    // the captured pawn is one rank behind the en passant target square
+    remove_piece(m.flags() == move::en_passant ? to ^ 8 : to);
+    halfmove_clock_ = 0;
+  }
+  if (moving_type == pawn) {
+    halfmove_clock_ = 0;
+  }
+
+  move_piece(from, to);
+
+  if (m.is_promotion()) {
+    remove_piece(to);
+    put_piece(make_piece(us, m.promotion_type()), to);
+  } else if (m.flags() == move::king_castle) {
+    move_piece(to + 1, to - 1);
+  } else if (m.flags() == move::queen_castle) {
+    move_piece(to - 2, to + 1);
+  } else if (m.flags() == move::double_push) {
+    // the en passant square is set only when it can be used, so equal positions have equal keys
+    square_index target = (from + to) / 2;
+    if ((pawn_attacks(us, target) & pieces(them, pawn)).any()) {
+      en_passant_ = target;
+    }
+  }
+
+  castling_rights_ &= castling_masks[from] & castling_masks[to];
+  key_ ^= zobrist::castling_key(castling_rights_) ^ zobrist::en_passant_key(en_passant_);
+
+  if (us == black) {
+    ++fullmove_number_;
+  }
+  side = them;
+  key_ ^= zobrist::side_key();
+}
+
+void position::make_null_move() {
+  key_ ^= zobrist::en_passant_key(en_passant_) ^ zobrist::side_key();
+  en_passant_ = no_square;
+  ++halfmove_clock_;
+  if (side == black) {
+    ++fullmove_number_;
+  }
+  side = ~side;
+}
+
+bool position::insufficient_material() const {
+  if ((by_type[pawn] | by_type[rook] | by_type[queen]).any()) {
+    return false;
+  }
+  return (by_type[knight] | by_type[bishop]).count() <= 1;
+}
+
+}  // namespace slchess
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "attacks.hpp"
+#include "chess.hpp"
+#include "move.hpp"
+
+namespace slchess {
+
+/**
+ * A chess position.
+ *
+ * The pieces are kept twice: as bitboards (one for each piece type and one for each color) for
+ * the move generation, and as an array of the piece codes for checking what is on a square.
+ *
+ * The position is small and cheap to copy, so there is no "unmake move": the search makes
+ * a copy of the position and calls `make_move` on the copy.
+ */
+class position {
+ public:
+  static constexpr std::string_view start_fen =
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+ private:
+  std::array<piece, 64> board{};
+  std::array<chessboard, 6> by_type;
+  std::array<chessboard, 2> by_color;
+
+  color side = white;
+  uint8_t castling_rights_ = no_castling;
+  square_index en_passant_ = no_square;
+  uint16_t halfmove_clock_ = 0;
+  uint16_t fullmove_number_ = 1;
+  uint64_t key_ = 0;
+
+  void move_piece(square_index from, square_index to);
+
+ public:
+  /**
+   * Creates an empty board with white to move.
+   */
+  position() = default;
+
+  /**
+   * Creates the position from the FEN string.
+   *
+   * @throws std::invalid_argument when the FEN string is not valid, or when the position is not
+   * legal (see `validate`).
+   */
+  [[nodiscard]] static position from_fen(std::string_view fen);
+
+  /**
+   * Returns the starting position.
+   */
+  [[nodiscard]] static position start() { return from_fen(start_fen); }
+
+  /**
+   * Returns the position as a FEN string.
+   */
+  [[nodiscard]] std::string to_fen() const;
+
+  [[nodiscard]] piece piece_on(square_index sq) const { return board[sq]; }
+
+  [[nodiscard]] chessboard pieces() const { return by_color[white] | by_color[black]; }
+
+  [[nodiscard]] chessboard pieces(color c) const { return by_color[c]; }
+
+  [[nodiscard]] chessboard pieces(piece_type type) const { return by_type[type]; }
+
+  [[nodiscard]] chessboard pieces(color c, piece_type type) const {
+    return by_color[c] & by_type[type];
+  }
+
+  [[nodiscard]] color side_to_move() const { return side; }
+
+  [[nodiscard]] uint8_t castling_rights() const { return castling_rights_; }
+
+  /**
+   * Returns the en passant target square, or `no_square`.
+   */
+  [[nodiscard]] square_index en_passant() const { return en_passant_; }
+
+  [[nodiscard]] unsigned halfmove_clock() const { return halfmove_clock_; }
+
+  [[nodiscard]] unsigned fullmove_number() const { return fullmove_number_; }
+
+  /**
+   * Returns the Zobrist hash of the position.
+   */
+  [[nodiscard]] uint64_t key() const { return key_; }
+
+  [[nodiscard]] square_index king_square(color c) const { return lsb(pieces(c, king)); }
+
+  /**
+   * Returns all the pieces (of both colors) attacking the square.
+   *
+   * @param sq Attacked square.
+   * @param occupied Occupancy used for the sliding pieces.
+   */
+  [[nodiscard]] chessboard attackers_to(square_index sq, const chessboard& occupied) const;
+
+  /**
+   * Returns true if any piece of the color `by` attacks the square.
+   */
+  [[nodiscard]] bool is_attacked(square_index sq, color by) const;
+
+  /**
+   * Returns true if the side to move is in check.
+   */
+  [[nodiscard]] bool in_check() const { return is_attacked(king_square(side), ~side); }
+
+  /**
+   * Puts the piece on an empty square.
+   */
+  void put_piece(piece p, square_index sq);
+
+  /**
+   * Removes the piece from the square, the square must not be empty.
+   */
+  void remove_piece(square_index sq);
+
+  /**
+   * Sets the side to move, the castling rights and the en passant square.
+   */
+  void set_state(color side_to_move,
+                 uint8_t castling_rights,
+                 square_index en_passant,
+                 unsigned halfmove_clock = 0,
+                 unsigned fullmove_number = 1);
+
+  /**
+   * Checks the rules the move generation and the search rely on: exactly one king of each
+   * color, no pawns on the first and the last rank, the side not to move not in check, and the
+   * en passant square on the sixth rank of the side to move, empty, with the pawn of the other
+   * side in front of it.
+   *
+   * The positions from the users (FEN, the packed records, the training samples) are checked
+   * with it, as an illegal position can crash the move generation.
+   *
+   * @throws std::invalid_argument when the position is not legal.
+   */
+  void validate() const;
+
+  /**
+   * Makes a pseudo legal move. The move is not checked, it can leave the king in check.
+   */
+  void make_move(move m);
+
+  /**
+   * Passes the move to the other side.
+   */
+  void make_null_move();
+
+  /**
+   * Returns true if there is not enough material left for any side to mate.
+   */
+  [[nodiscard]] bool insufficient_material() const;
+};
+
+}  // namespace slchess
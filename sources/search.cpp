@@ -0,0 +1,384 @@
+#include "search.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <string>
+
+#include "evaluate.hpp"
+#include "movegen.hpp"
+#include "stats.hpp"
+#include "telemetry.hpp"
+
+namespace slchess {
+
+namespace {
+
+/**
+ * The mate scores are stored in the transposition table as the distance from the node, not
+ * from the root, so they are valid when the node is reached by a different path.
+ */
+int score_to_tt(int score, int ply) {
+  if (score >= score_mate - max_ply) {
+    return score + ply;
+  }
+  if (score <= -score_mate + max_ply) {
+    return score - ply;
+  }
+  return score;
+}
+
+int score_from_tt(int score, int ply) {
+  if (score >= score_mate - max_ply) {
+    return score - ply;
+  }
+  if (score <= -score_mate + max_ply) {
+    return score + ply;
+  }
+  return score;
+}
+
+std::string pv_string(const std::vector<move>& pv) {
+  std::string text;
+  for (auto m : pv) {
+    text += (text.empty() ? "" : " ") + m.to_uci();
+  }
+  return text;
+}
+
+}  // namespace
+
+void searcher::set_game_history(std::vector<uint64_t> history) {
+  keys = std::move(history);
+  game_keys = keys.size();
+}
+
+bool searcher::is_repetition(const position& pos) const {
+  // the last key is the current position, only the same side to move positions are checked,
+  // and not further than the last irreversible move
+  auto distance = std::min<size_t>(pos.halfmove_clock(), keys.size() - 1);
+  for (size_t back = 2; back <= distance; back += 2) {
+    if (keys[keys.size() - 1 - back] == pos.key()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void searcher::count_node() {
+  ++nodes;
+  if (node_limit != 0 && nodes >= node_limit) {
+    stopped = true;
+  }
+  // the flag is written by other threads, so it's read rarely to keep its cache line local
+  if ((nodes & (stop_poll_interval - 1)) == 0 && stop_flag != nullptr &&
+      stop_flag->load(std::memory_order_relaxed)) {
+    stopped = true;
+  }
+}
+
+int searcher::quiescence(const position& pos, int alpha, int beta, int ply) {
+  count_node();
+  stats::add(stat_counter::quiescence_nodes);
+  pv_length[ply] = ply;
+
+  bool in_check = pos.in_check();
+  if (ply >= max_ply - 1) {
+    return in_check ? 0 : evaluate(pos);
+  }
+
+  int best = -score_infinite;
+  if (!in_check) {
+    best = evaluate(pos);
+    if (best >= beta) {
+      return best;
+    }
+    alpha = std::max(alpha, best);
+  }
+
+  move_picker picker(pos, history);
+  int legal = 0;
+  for (auto m = picker.next(); !m.is_none(); m = picker.next()) {
+    if (!is_legal(pos, m)) {
+      continue;
+    }
+    ++legal;
+    position next = pos;
+    next.make_move(m);
+    int score = -quiescence(next, -beta, -alpha, ply + 1);
+    if (stopped) {
+      return 0;
+    }
+    if (score > best) {
+      best = score;
+      if (score > alpha) {
+        alpha = score;
+        if (alpha >= beta) {
+          break;
+        }
+      }
+    }
+  }
+
+  if (in_check && legal == 0) {
+    return -score_mate + ply;
+  }
+  return best;
+}
+
+int searcher::negamax(
+    const position& pos, int depth, int alpha, int beta, int ply, move previous) {
+  pv_length[ply] = ply;
+
+  if (ply > 0 && (pos.halfmove_clock() >= 100 || pos.insufficient_material() ||
+                  is_repetition(pos))) {
+    return 0;
+  }
+
+  bool in_check = pos.in_check();
+  if (in_check) {
+    ++depth;
+  }
+  if (depth <= 0 || ply >= max_ply - 1) {
+    return quiescence(pos, alpha, beta, ply);
+  }
+
+  count_node();
+  stats::add(stat_counter::nodes);
+
+  move tt_move;
+  if (tt != nullptr) {
+    if (auto entry = tt->probe(pos.key())) {
+      tt_move = entry->best_move;
+      int score = score_from_tt(entry->score, ply);
+      if (ply > 0 && entry->depth >= depth &&
+          (entry->type == bound::exact || (entry->type == bound::lower && score >= beta) ||
+           (entry->type == bound::upper && score <= alpha))) {
+        return score;
+      }
+    }
+  }
+
+  // the move of the previous iteration is used when the table doesn't have one
+  if (tt_move.is_none() && static_cast<size_t>(ply) < previous_pv.size()) {
+    tt_move = previous_pv[ply];
+  }
+  move_picker picker(pos, tt_move, history, ply, previous);
+
+  int original_alpha = alpha;
+  int best = -score_infinite;
+  move best_move;
+  int legal = 0;
+  move_list quiets_tried;
+  for (auto m = picker.next(); !m.is_none(); m = picker.next()) {
+    if (!is_legal(pos, m) ||
+        (ply == 0 && std::find(excluded_root_moves.begin(), excluded_root_moves.end(), m) !=
+                         excluded_root_moves.end())) {
+      continue;
+    }
+    ++legal;
+    position next = pos;
+    next.make_move(m);
+    keys.push_back(next.key());
+    int score = -negamax(next, depth - 1, -beta, -alpha, ply + 1, m);
+    keys.pop_back();
+    if (stopped) {
+      return 0;
+    }
+
+    if (score > best) {
+      best = score;
+      if (score > alpha) {
+        alpha = score;
+        best_move = m;
+        pv_table[ply][ply] = m;
+        for (int n = ply + 1; n < pv_length[ply + 1]; ++n) {
+          pv_table[ply][n] = pv_table[ply + 1][n];
+        }
+        pv_length[ply] = std::max(pv_length[ply + 1], ply + 1);
+        if (alpha >= beta) {
+          stats::add_cutoff(static_cast<size_t>(legal - 1));
+          if (!m.is_capture() && !m.is_promotion()) {
+            history.update(pos, m, {quiets_tried.begin(), quiets_tried.end()}, depth, ply,
+                           previous);
+          }
+          break;
+        }
+      }
+    }
+    if (!m.is_capture() && !m.is_promotion()) {
+      quiets_tried.push_back(m);
+    }
+  }
+
+  if (legal == 0) {
+    return in_check ? -score_mate + ply : 0;
+  }
+
+  // the root result without the excluded moves isn't the result of the position
+  if (tt != nullptr && (ply > 0 || excluded_root_moves.empty())) {
+    auto type = best >= beta ? bound::lower : best > original_alpha ? bound::exact : bound::upper;
+    tt->store(pos.key(), best_move, score_to_tt(best, ply), depth, type);
+  }
+  return best;
+}
+
+search_result searcher::search(const position& pos, const search_limits& limits) {
+  keys.resize(game_keys);
+  keys.push_back(pos.key());
+  nodes = 0;
+  stopped = false;
+  previous_pv.clear();
+  auto start = std::chrono::steady_clock::now();
+  auto elapsed = [&start] {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+  auto& stop = limits.stop != nullptr ? *limits.stop : own_stop;
+  own_stop.store(false, std::memory_order_relaxed);
+
+  search_result result;
+  if (cache != nullptr && limits.depth > 0 && limits.multi_pv <= 1) {
+    if (auto cached = cache->probe(pos.key()); cached && cached->depth >= limits.depth) {
+      // the move is checked, so a key collision can't return an illegal move
+      move_list moves;
+      generate_legal(pos, moves);
+      bool legal = cached->best_move.is_none()
+                       ? moves.size() == 0
+                       : std::find(moves.begin(), moves.end(), cached->best_move) != moves.end();
+      if (legal) {
+        result.best_move = cached->best_move;
+        result.score = cached->score;
+        result.depth = cached->depth;
+        if (!result.best_move.is_none()) {
+          result.pv.push_back(result.best_move);
+        }
+        result.lines = {{result.score, result.pv}};
+        if (telemetry::enabled()) {
+          telemetry::event("search")
+              .field("best_move", result.best_move.to_uci())
+              .field("depth", result.depth)
+              .field("score", result.score)
+              .field("cached", true)
+              .log();
+        }
+        return result;
+      }
+    }
+  }
+
+  if (tt != nullptr) {
+    tt->new_search();
+  }
+  history.new_search();
+  int max_depth = limits.depth > 0 ? std::min(limits.depth, max_ply - 1) : max_ply - 1;
+
+  std::optional<time_manager> timing;
+  std::optional<stop_timer> timer;
+  if (limits.time.is_limited()) {
+    int ply = static_cast<int>(pos.fullmove_number() - 1) * 2 + pos.side_to_move();
+    timing.emplace(limits.time, ply);
+    timer.emplace(start + timing->maximum(), stop);
+    if (telemetry::enabled()) {
+      telemetry::event("time")
+          .field("remaining_ms", static_cast<int64_t>(limits.time.remaining.count()))
+          .field("increment_ms", static_cast<int64_t>(limits.time.increment.count()))
+          .field("moves_to_go", limits.time.moves_to_go)
+          .field("optimum_ms", static_cast<int64_t>(timing->optimum().count()))
+          .field("maximum_ms", static_cast<int64_t>(timing->maximum().count()))
+          .log();
+    }
+  }
+
+  move_list root_moves;
+  generate_legal(pos, root_moves);
+  auto line_count = std::min(static_cast<size_t>(std::max(limits.multi_pv, 1)),
+                             std::max<size_t>(root_moves.size(), 1));
+  std::vector<pv_line> lines;
+
+  for (int depth = 1; depth <= max_depth; ++depth) {
+    // the first iteration is always completed, so there is always a move to return
+    node_limit = depth > 1 ? limits.nodes : 0;
+    stop_flag = depth > 1 ? &stop : nullptr;
+    lines.clear();
+    excluded_root_moves.clear();
+    for (size_t line = 0; line < line_count && !stopped; ++line) {
+      int score = negamax(pos, depth, -score_infinite, score_infinite, 0, move());
+      if (!stopped) {
+        lines.push_back({score, {pv_table[0].begin(), pv_table[0].begin() + pv_length[0]}});
+        if (!lines.back().pv.empty()) {
+          excluded_root_moves.push_back(lines.back().pv.front());
+        }
+      }
+    }
+    excluded_root_moves.clear();
+    if (stopped) {
+      break;
+    }
+
+    int score = lines.front().score;
+    result.score = score;
+    result.depth = depth;
+    result.pv = lines.front().pv;
+    result.best_move = result.pv.empty() ? move() : result.pv.front();
+    result.lines = lines;
+    previous_pv = result.pv;
+    result.nodes = nodes;
+    if (on_iteration) {
+      on_iteration(result, std::chrono::duration_cast<milliseconds>(
+                               std::chrono::steady_clock::now() - start));
+    }
+
+    if (telemetry::enabled()) {
+      auto seconds = elapsed();
+      telemetry::event("iteration")
+          .field("depth", depth)
+          .field("score", score)
+          .field("nodes", nodes)
+          .field("time_ms", static_cast<int64_t>(seconds * 1000))
+          .field("nps", static_cast<uint64_t>(static_cast<double>(nodes) / std::max(seconds, 1e-6)))
+          .field("hashfull", tt != nullptr ? tt->hashfull() : 0)
+          .field("pv", pv_string(result.pv))
+          .log();
+    }
+
+    if (result.pv.empty() || (limits.nodes != 0 && nodes >= limits.nodes) ||
+        stop.load(std::memory_order_relaxed)) {
+      break;
+    }
+    if (timing) {
+      auto used =
+          std::chrono::duration_cast<milliseconds>(std::chrono::steady_clock::now() - start);
+      if (!timing->next_iteration(result.best_move, score, used)) {
+        if (telemetry::enabled()) {
+          telemetry::event("time_stop")
+              .field("depth", depth)
+              .field("elapsed_ms", static_cast<int64_t>(used.count()))
+              .field("budget_ms", static_cast<int64_t>(timing->budget().count()))
+              .log();
+        }
+        break;
+      }
+    }
+  }
+  stop_flag = nullptr;
+
+  result.nodes = nodes;
+  if (cache != nullptr) {
+    cache->store(pos.key(), result.best_move, result.score, result.depth);
+  }
+  if (telemetry::enabled()) {
+    telemetry::event("search")
+        .field("best_move", result.best_move.to_uci())
+        .field("depth", result.depth)
+        .field("score", result.score)
+        .field("nodes", nodes)
+        .field("time_ms", static_cast<int64_t>(elapsed() * 1000))
+        .field("depth_limit", limits.depth)
+        .field("node_limit", limits.nodes)
+        .field("stopped", stopped)
+        .log();
+  }
+  return result;
+}
+
+}  // namespace slchess
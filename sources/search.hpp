@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "analysis_cache.hpp"
+#include "move.hpp"
+#include "move_picker.hpp"
+#include "position.hpp"
+#include "time_manager.hpp"
+#include "transposition_table.hpp"
+
+namespace slchess {
+
+constexpr int score_mate = 32000;
+constexpr int score_infinite = 32001;
+
+/// The stop flag is read every this many nodes, it's a power of two.
+constexpr uint64_t stop_poll_interval = 1024;
+
+/**
+ * Returns true if the score means a forced mate for any side.
+ */
+[[nodiscard]] constexpr bool is_mate_score(int score) {
+  return score >= score_mate - max_ply || score <= -score_mate + max_ply;
+}
+
+/**
+ * Limits for one search. The zero value means "no limit".
+ */
+struct search_limits {
+  int depth = 0;       ///< Maximum depth of the iterative deepening.
+  uint64_t nodes = 0;  ///< Maximum number of nodes.
+  time_control time{};  ///< Clock of the side to move.
+  int multi_pv = 1;     ///< Number of the best lines searched, each with the exact score.
+
+  /// Flag set by another thread to stop the search. It's also set when the time runs out, so
+  /// the caller clears it before the next search.
+  std::atomic<bool>* stop = nullptr;
+};
+
+/**
+ * One of the best lines of the multi-PV search.
+ */
+struct pv_line {
+  int score = 0;
+  std::vector<move> pv;
+};
+
+/**
+ * Result of the last completed iteration of the search.
+ */
+struct search_result {
+  move best_move;
+  int score = 0;  ///< Score in centipawns from the point of view of the side to move.
+  int depth = 0;
+  uint64_t nodes = 0;
+  std::vector<move> pv;
+
+  /// The best lines from the best one, `multi_pv` of them if there are enough legal moves.
+  /// The first one is the same as `score` and `pv`.
+  std::vector<pv_line> lines;
+};
+
+/**
+ * Alpha-beta search with iterative deepening and the quiescence search.
+ *
+ * One object is meant to be used by one thread, and reused between the searches.
+ */
+class searcher {
+ private:
+  /// Keys of the positions from the game and the current search path, for repetitions.
+  std::vector<uint64_t> keys;
+  size_t game_keys = 0;
+
+  std::array<std::array<move, max_ply>, max_ply> pv_table{};
+  std::array<int, max_ply> pv_length{};
+  std::vector<move> previous_pv;
+  /// Root moves skipped by the search, the best moves of the previous multi-PV lines.
+  std::vector<move> excluded_root_moves;
+
+  uint64_t nodes = 0;
+  uint64_t node_limit = 0;
+  std::atomic<bool>* stop_flag = nullptr;
+  std::atomic<bool> own_stop{false};
+  bool stopped = false;
+
+  analysis_cache* cache = nullptr;
+  transposition_table* tt = nullptr;
+  std::function<void(const search_result&, milliseconds)> on_iteration;
+
+  history_tables history;
+
+  int negamax(const position& pos, int depth, int alpha, int beta, int ply, move previous);
+  int quiescence(const position& pos, int alpha, int beta, int ply);
+
+  [[nodiscard]] bool is_repetition(const position& pos) const;
+  void count_node();
+
+ public:
+  /**
+   * Sets the keys of the positions which happened in the game before the searched one,
+   * from the oldest. They are used for detecting repetitions.
+   */
+  void set_game_history(std::vector<uint64_t> history);
+
+  /**
+   * Sets the persistent cache of the search results, or disables it with `nullptr`.
+   *
+   * A search with the depth limit returns the cached result at once when it has at least
+   * the same depth. All the completed searches store their results in the cache.
+   */
+  void set_analysis_cache(analysis_cache* analysis) { cache = analysis; }
+
+  /**
+   * Sets the transposition table, or disables it with `nullptr`.
+   *
+   * The table can be shared by many searchers running at once.
+   */
+  void set_transposition_table(transposition_table* table) { tt = table; }
+
+  /**
+   * Removes the move ordering statistics, e.g. before a new game.
+   */
+  void clear_history() { history.clear(); }
+
+  /**
+   * Sets the function called after every completed iteration with its result and the time
+   * since the search start, e.g. for the UCI "info" lines. It's called by the searching thread.
+   */
+  void set_iteration_callback(std::function<void(const search_result&, milliseconds)> callback) {
+    on_iteration = std::move(callback);
+  }
+
+  /**
+   * Searches the position.
+   *
+   * When there is no legal move, the returned best move is "no move" and the score is
+   * the mate or the stalemate score.
+   *
+   * With the time limit the think time is allocated by the `time_manager`, and a `stop_timer`
+   * sets the stop flag at the maximum time. The search reads the flag only every
+   * `stop_poll_interval` nodes, and never reads the clock inside an iteration. The first
+   * iteration is always completed, so there is always a move to return.
+   *
+   * With `multi_pv` every iteration searches the root once per line, every time without
+   * the best moves of the previous lines. An iteration is used only when all its lines are
+   * completed.
+   */
+  search_result search(const position& pos, const search_limits& limits);
+};
+
+}  // namespace slchess
@@ -2,7 +2,383 @@
 // Created by szymon on 17.09.2020.
 //
 
-int main() {
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
+#include "analysis_cache.hpp"
+#include "analysis_pool.hpp"
+#include "config.hpp"
+#include "movegen.hpp"
+#include "pgn.hpp"
+#include "position.hpp"
+#include "search.hpp"
+#include "stats.hpp"
+#include "task_scheduler.hpp"
+#include "telemetry.hpp"
+#include "training_data.hpp"
+#include "uci.hpp"
+
+using namespace slchess;
+
+namespace {
+
+void print_usage() {
+  std::cout << PROJECT_NAME << " " << PROJECT_VERSION << "\n\n"
+            << "Usage:\n"
+            << "  slchess perft <depth> [threads N] [fen]\n"
+            << "  slchess gensfen [depth N] [count N] [threads N] [random_plies N] [max_plies N]\n"
+            << "                  [seed N] [output PATH]\n"
+            << "  slchess pgn <file> [threads N]\n"
+            << "  slchess analyse <depth> [cache PATH] [hash MB] [multipv N] [log PATH] [fen]\n"
+            << "  slchess batch <file> [depth N] [multipv N] [threads N] [hash MB]\n"
+            << "  slchess bench [depth N]\n"
+            << "  slchess uci\n";
+}
+
+int run_perft(const std::vector<std::string>& args) {
+  if (args.empty()) {
+    throw std::invalid_argument("perft requires the depth");
+  }
+  int depth = std::stoi(args[0]);
+  size_t first = 1;
+  unsigned threads = 1;
+  if (args.size() > 2 && args[1] == "threads") {
+    threads = static_cast<unsigned>(std::stoul(args[2]));
+    first = 3;
+  }
+  std::string fen(position::start_fen);
+  if (args.size() > first) {
+    fen.clear();
+    for (size_t n = first; n < args.size(); ++n) {
+      fen += (n > first ? " " : "") + args[n];
+    }
+  }
+  auto pos = position::from_fen(fen);
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t nodes = 0;
+  if (threads == 1) {
+    nodes = perft(pos, depth);
+  } else {
+    task_scheduler scheduler(threads);
+    nodes = perft(pos, depth, scheduler);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "nodes " << nodes << " time " << elapsed.count() << "s nps "
+            << static_cast<uint64_t>(nodes / std::max(elapsed.count(), 1e-9)) << "\n";
+  return 0;
+}
+
+int run_gensfen(const std::vector<std::string>& args) {
+  gensfen_options options;
+  for (size_t n = 0; n + 1 < args.size(); n += 2) {
+    const auto& name = args[n];
+    const auto& value = args[n + 1];
+    if (name == "depth") {
+      options.depth = std::stoi(value);
+    } else if (name == "count") {
+      options.count = std::stoull(value);
+    } else if (name == "threads") {
+      options.threads = static_cast<unsigned>(std::stoul(value));
+    } else if (name == "random_plies") {
+      options.random_plies = std::stoi(value);
+    } else if (name == "max_plies") {
+      options.max_plies = std::stoi(value);
+    } else if (name == "seed") {
+      options.seed = std::stoull(value);
+    } else if (name == "output") {
+      options.output = value;
+    } else {
+      throw std::invalid_argument("unknown gensfen option: " + name);
+    }
+  }
+  if (args.size() % 2 != 0) {
+    throw std::invalid_argument("gensfen option without a value: " + args.back());
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t written = 0;
+  try {
+    written = gensfen(options);
+  } catch (const std::runtime_error& e) {
+    // the file is incomplete, so it must not be mistaken for a finished run
+    std::cerr << "gensfen failed: " << e.what() << "\n";
+    return 1;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "positions " << written << " time " << elapsed.count() << "s positions/s "
+            << static_cast<uint64_t>(written / std::max(elapsed.count(), 1e-9)) << "\n";
+  return 0;
+}
+
+int run_pgn(const std::vector<std::string>& args) {
+  if (args.empty()) {
+    throw std::invalid_argument("pgn requires the file name");
+  }
+  unsigned threads = 0;
+  if (args.size() == 3 && args[1] == "threads") {
+    threads = static_cast<unsigned>(std::stoul(args[2]));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  pgn_file file(args[0]);
+
+  // the first moves statistics, kept per worker so there is no locking
+  auto start_key = position::start().key();
+  unsigned workers = threads != 0 ? threads : std::max(std::thread::hardware_concurrency(), 1U);
+  std::vector<std::unordered_map<uint16_t, uint64_t>> first_moves(workers);
+
+  auto count_first_moves = [&](unsigned worker, const position& pos, move m) {
+    if (pos.key() == start_key) {
+      ++first_moves[worker][m.raw()];
+    }
+  };
+  auto stats = replay_games(file.games(), workers, count_first_moves);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::multimap<uint64_t, std::string, std::greater<>> sorted;
+  std::unordered_map<uint16_t, uint64_t> total;
+  for (const auto& counts : first_moves) {
+    for (auto [m, count] : counts) {
+      total[m] += count;
+    }
+  }
+  for (auto [m, count] : total) {
+    sorted.emplace(count, move::from_raw(m).to_uci());
+  }
+
+  std::cout << "games " << stats.games << " moves " << stats.moves << " errors " << stats.errors
+            << " time " << elapsed.count() << "s games/s "
+            << static_cast<uint64_t>(stats.games / std::max(elapsed.count(), 1e-9)) << "\n";
+  for (const auto& [count, name] : sorted) {
+    std::cout << name << " " << count << "\n";
+  }
+  return 0;
+}
+
+/// Positions of the bench, from the opening to the endgame.
+constexpr std::array<std::string_view, 8> bench_positions = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1",
+};
+
+int run_bench(const std::vector<std::string>& args) {
+  int depth = 8;
+  if (args.size() == 2 && args[0] == "depth") {
+    depth = std::stoi(args[1]);
+  }
+
+  // the search and the move generation are measured, as both are the engine hot paths, but they
+  // are timed and reported separately, as a perft node is much cheaper than a search node
+  uint64_t search_nodes = 0;
+  uint64_t perft_nodes = 0;
+  std::chrono::duration<double> search_time{0};
+  std::chrono::duration<double> perft_time{0};
+  transposition_table tt(16);
+  for (auto fen : bench_positions) {
+    auto pos = position::from_fen(fen);
+    tt.clear();
+    searcher search;
+    search.set_transposition_table(&tt);
+    auto start = std::chrono::steady_clock::now();
+    auto result = search.search(pos, {depth, 0});
+    auto searched = std::chrono::steady_clock::now();
+    search_nodes += result.nodes;
+    search_time += searched - start;
+    perft_nodes += perft(pos, 3);
+    perft_time += std::chrono::steady_clock::now() - searched;
+    std::cout << fen << ": bestmove " << result.best_move.to_uci() << " score " << result.score
+              << "\n";
+  }
+
+  std::cout << "nodes " << search_nodes << " time " << search_time.count() << "s nps "
+            << static_cast<uint64_t>(search_nodes / std::max(search_time.count(), 1e-9)) << "\n";
+  std::cout << "perft nodes " << perft_nodes << " time " << perft_time.count() << "s nps "
+            << static_cast<uint64_t>(perft_nodes / std::max(perft_time.count(), 1e-9)) << "\n";
+  return 0;
+}
+
+int run_analyse(const std::vector<std::string>& args) {
+  if (args.empty()) {
+    throw std::invalid_argument("analyse requires the depth");
+  }
+  int depth = std::stoi(args[0]);
+  size_t fen_start = 1;
+  size_t hash = 16;
+  int multi_pv = 1;
+  std::unique_ptr<analysis_cache> cache;
+  for (; fen_start + 1 < args.size(); fen_start += 2) {
+    if (args[fen_start] == "cache") {
+      // 1M entries take 16MB
+      cache = std::make_unique<analysis_cache>(args[fen_start + 1], 1 << 20);
+    } else if (args[fen_start] == "hash") {
+      hash = std::stoull(args[fen_start + 1]);
+    } else if (args[fen_start] == "multipv") {
+      multi_pv = std::stoi(args[fen_start + 1]);
+    } else if (args[fen_start] == "log") {
+      telemetry::start(args[fen_start + 1]);
+    } else {
+      break;
+    }
+  }
+  std::string fen(position::start_fen);
+  if (args.size() > fen_start) {
+    fen.clear();
+    for (size_t n = fen_start; n < args.size(); ++n) {
+      fen += (n > fen_start ? " " : "") + args[n];
+    }
+  }
+
+  transposition_table tt(hash);
+  searcher search;
+  search.set_analysis_cache(cache.get());
+  search.set_transposition_table(&tt);
+  auto start = std::chrono::steady_clock::now();
+  search_limits limits;
+  limits.depth = depth;
+  limits.multi_pv = multi_pv;
+  auto result = search.search(position::from_fen(fen), limits);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "depth " << result.depth << " nodes " << result.nodes << " time "
+            << elapsed.count() << "s\n";
+  for (const auto& line : result.lines) {
+    std::cout << "score " << line.score << " pv";
+    for (auto m : line.pv) {
+      std::cout << " " << m.to_uci();
+    }
+    std::cout << "\n";
+  }
+  if constexpr (stats::enabled) {
+    std::cout << stats::format(stats::collect());
+  }
+  telemetry::stop();
+  return 0;
 }
 
+int run_batch(const std::vector<std::string>& args) {
+  if (args.empty()) {
+    throw std::invalid_argument("batch requires the file name");
+  }
+  search_limits limits;
+  limits.depth = 8;
+  unsigned threads = 0;
+  size_t hash = 16;
+  for (size_t n = 1; n + 1 < args.size(); n += 2) {
+    const auto& name = args[n];
+    const auto& value = args[n + 1];
+    if (name == "depth") {
+      limits.depth = std::stoi(value);
+    } else if (name == "multipv") {
+      limits.multi_pv = std::stoi(value);
+    } else if (name == "threads") {
+      threads = static_cast<unsigned>(std::stoul(value));
+    } else if (name == "hash") {
+      hash = std::stoull(value);
+    } else {
+      throw std::invalid_argument("unknown batch option: " + name);
+    }
+  }
+
+  std::ifstream input(args[0]);
+  if (!input) {
+    throw std::runtime_error("Can't open the positions file: " + args[0]);
+  }
+  std::vector<std::string> fens;
+  for (std::string line; std::getline(input, line);) {
+    if (!line.empty()) {
+      fens.push_back(line);
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  analysis_pool pool(threads, hash);
+  auto results = pool.analyse(fens, limits);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  uint64_t nodes = 0;
+  for (size_t n = 0; n < fens.size(); ++n) {
+    nodes += results[n].nodes;
+    for (const auto& line : results[n].lines) {
+      std::cout << fens[n] << ": score " << line.score << " pv";
+      for (auto m : line.pv) {
+        std::cout << " " << m.to_uci();
+      }
+      std::cout << "\n";
+    }
+  }
+  std::cout << "positions " << fens.size() << " nodes " << nodes << " time " << elapsed.count()
+            << "s positions/s "
+            << static_cast<uint64_t>(static_cast<double>(fens.size()) /
+                                     std::max(elapsed.count(), 1e-9))
+            << "\n";
+  return 0;
+}
+
+int run_uci() {
+  uci_engine engine(std::cin, std::cout);
+  engine.run();
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+  if (args.empty()) {
+    print_usage();
+    return 0;
+  }
+
+  auto command = args.front();
+  args.erase(args.begin());
+
+  try {
+    if (command == "perft") {
+      return run_perft(args);
+    }
+    if (command == "gensfen") {
+      return run_gensfen(args);
+    }
+    if (command == "pgn") {
+      return run_pgn(args);
+    }
+    if (command == "analyse") {
+      return run_analyse(args);
+    }
+    if (command == "bench") {
+      return run_bench(args);
+    }
+    if (command == "batch") {
+      return run_batch(args);
+    }
+    if (command == "uci") {
+      return run_uci();
+    }
+    print_usage();
+    return 1;
+  } catch (const std::exception& e) {
+    std::cerr << "error: " << e.what() << "\n";
+    return 1;
+  }
+}
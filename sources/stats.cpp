@@ -0,0 +1,86 @@
+#include "stats.hpp"
+
+#include <deque>
+#include <mutex>
+#include <sstream>
+
+namespace slchess::stats {
+
+namespace {
+
+/**
+ * All the blocks ever registered. They are never removed, so the counts of the finished threads
+ * are kept, and the deque never moves the existing blocks.
+ */
+struct registry {
+  std::mutex mutex;
+  std::deque<thread_block> blocks;
+};
+
+registry& blocks_registry() {
+  static registry instance;
+  return instance;
+}
+
+uint64_t load(const uint64_t& counter) {
+  return std::atomic_ref(const_cast<uint64_t&>(counter)).load(std::memory_order_relaxed);
+}
+
+constexpr std::array<const char*, stat_counters> counter_names = {
+    "nodes",
+    "quiescence_nodes",
+    "tt_probes",
+    "tt_hits",
+    "tt_collisions",
+    "eval_calls",
+    "range_check_failures",
+};
+
+}  // namespace
+
+thread_block& local_block() {
+  thread_local thread_block* block = [] {
+    auto& instance = blocks_registry();
+    std::lock_guard lock(instance.mutex);
+    return &instance.blocks.emplace_back();
+  }();
+  return *block;
+}
+
+snapshot collect() {
+  auto& instance = blocks_registry();
+  std::lock_guard lock(instance.mutex);
+  snapshot result;
+  for (const auto& block : instance.blocks) {
+    for (size_t n = 0; n < stat_counters; ++n) {
+      result.counters[n] += load(block.counters[n]);
+    }
+    for (size_t n = 0; n < cutoff_slots; ++n) {
+      result.cutoffs[n] += load(block.cutoffs[n]);
+    }
+  }
+  return result;
+}
+
+void reset() {
+  auto& instance = blocks_registry();
+  std::lock_guard lock(instance.mutex);
+  for (auto& block : instance.blocks) {
+    block = thread_block();
+  }
+}
+
+std::string format(const snapshot& values) {
+  std::ostringstream output;
+  for (size_t n = 0; n < stat_counters; ++n) {
+    output << counter_names[n] << " " << values.counters[n] << "\n";
+  }
+  output << "cutoffs";
+  for (auto count : values.cutoffs) {
+    output << " " << count;
+  }
+  output << "\n";
+  return output.str();
+}
+
+}  // namespace slchess::stats
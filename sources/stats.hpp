@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "config.hpp"
+
+namespace slchess {
+
+/**
+ * The hot path events counted by the statistics.
+ */
+enum class stat_counter : size_t {
+  nodes,                 ///< Nodes of the main search.
+  quiescence_nodes,      ///< Nodes of the quiescence search.
+  tt_probes,             ///< Transposition table lookups.
+  tt_hits,               ///< Transposition table lookups which found the position.
+  tt_collisions,         ///< Stored entries which replaced an entry of another position.
+  eval_calls,            ///< Calls of the static evaluation.
+  range_check_failures,  ///< Bitboard coordinates out of the board range.
+};
+
+constexpr size_t stat_counters = 7;
+
+/// The beta cutoffs are counted by the index of the move, the later moves share the last slot.
+constexpr size_t cutoff_slots = 16;
+
+/**
+ * The hot path statistics, enabled with the `ENABLE_STATS` cmake option.
+ *
+ * Every thread counts the events in its own cache line aligned block, so the threads don't
+ * share any cache lines and the counting doesn't need any atomic read-modify-write
+ * instructions. The blocks are summed only when the statistics are collected.
+ *
+ * When the statistics are disabled (the default), all the counting functions are empty
+ * because of the `if constexpr`, so they are removed completely by the compiler.
+ */
+namespace stats {
+
+constexpr bool enabled = ENABLE_STATS != 0;
+
+/**
+ * Counters of one thread.
+ */
+struct alignas(64) thread_block {
+  std::array<uint64_t, stat_counters> counters{};
+  std::array<uint64_t, cutoff_slots> cutoffs{};
+};
+
+/**
+ * Sum of the counters of all the threads.
+ */
+struct snapshot {
+  std::array<uint64_t, stat_counters> counters{};
+  std::array<uint64_t, cutoff_slots> cutoffs{};
+
+  [[nodiscard]] uint64_t operator[](stat_counter counter) const {
+    return counters[static_cast<size_t>(counter)];
+  }
+};
+
+/**
+ * Returns the block of the current thread, registering it on the first use.
+ */
+thread_block& local_block();
+
+namespace detail {
+
+/**
+ * Increments the counter owned by the current thread.
+ *
+ * Only the owner writes the counter, so a relaxed load and store is enough, and they compile to
+ * plain moves. The atomic access makes reading the counters from other threads well defined.
+ */
+inline void increment(uint64_t& counter, uint64_t value) {
+  std::atomic_ref ref(counter);
+  ref.store(ref.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+}  // namespace detail
+
+/**
+ * Counts the event.
+ */
+inline void add([[maybe_unused]] stat_counter counter, [[maybe_unused]] uint64_t value = 1) {
+  if constexpr (enabled) {
+    detail::increment(local_block().counters[static_cast<size_t>(counter)], value);
+  }
+}
+
+/**
+ * Counts the beta cutoff made by the move with the given index in the move list.
+ */
+inline void add_cutoff([[maybe_unused]] size_t move_index) {
+  if constexpr (enabled) {
+    detail::increment(local_block().cutoffs[std::min(move_index, cutoff_slots - 1)], 1);
+  }
+}
+
+/**
+ * Sums the counters of all the threads. It can be called while the threads are counting.
+ */
+[[nodiscard]] snapshot collect();
+
+/**
+ * Zeroes the counters of all the threads. It must not be called while the threads are counting.
+ */
+void reset();
+
+/**
+ * Returns the statistics formatted as text, one counter per line.
+ */
+[[nodiscard]] std::string format(const snapshot& values);
+
+}  // namespace stats
+
+}  // namespace slchess
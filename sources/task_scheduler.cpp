@@ -0,0 +1,184 @@
+#include "task_scheduler.hpp"
+
+#include <utility>
+
+namespace slchess {
+
+namespace {
+
+/// The scheduler and the index of the worker running on this thread.
+thread_local const task_scheduler* current_scheduler = nullptr;
+thread_local unsigned current_index = 0;
+
+/// Number of the checks for new tasks before an idle worker goes to sleep.
+constexpr int idle_spins = 64;
+
+}  // namespace
+
+task_scheduler::task_scheduler(unsigned threads) {
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  for (unsigned n = 0; n < threads; ++n) {
+    queues.push_back(std::make_unique<worker_queue>());
+  }
+  for (unsigned n = 0; n < threads; ++n) {
+    this->threads.emplace_back(&task_scheduler::run, this, n);
+  }
+}
+
+task_scheduler::~task_scheduler() {
+  {
+    std::lock_guard lock(sleep_mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+size_t task_scheduler::worker_index() const {
+  return current_scheduler == this ? current_index : size();
+}
+
+void task_scheduler::submit(task_group& group, task work) {
+  group.pending.fetch_add(1, std::memory_order_relaxed);
+  auto index = current_scheduler == this
+                   ? current_index
+                   : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+  {
+    auto& queue = *queues[index];
+    std::lock_guard lock(queue.mutex);
+    queue.items.push_back({std::move(work), &group});
+  }
+  // both counters are sequentially consistent, so either the sleeping worker sees the task,
+  // or this thread sees the sleeper and wakes it
+  queued.fetch_add(1);
+  if (sleepers.load() > 0) {
+    std::lock_guard lock(sleep_mutex);
+    wake.notify_one();
+  }
+}
+
+void task_scheduler::wait(task_group& group) {
+  if (current_scheduler == this) {
+    while (group.pending.load(std::memory_order_acquire) != 0) {
+      if (!run_one(current_index)) {
+        std::this_thread::yield();
+      }
+    }
+  } else {
+    std::unique_lock lock(sleep_mutex);
+    finished.wait(lock, [&group] { return group.pending.load(std::memory_order_acquire) == 0; });
+  }
+
+  std::exception_ptr error;
+  {
+    std::lock_guard lock(group.mutex);
+    error = std::exchange(group.error, nullptr);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+bool task_scheduler::pop(unsigned index, item& work) {
+  auto& queue = *queues[index];
+  std::lock_guard lock(queue.mutex);
+  if (queue.items.empty()) {
+    return false;
+  }
+  work = std::move(queue.items.back());
+  queue.items.pop_back();
+  return true;
+}
+
+bool task_scheduler::steal(unsigned thief, item& work) {
+  std::vector<item> stolen;
+  for (size_t n = 1; n < queues.size() && stolen.empty(); ++n) {
+    auto& victim = *queues[(thief + n) % queues.size()];
+    std::lock_guard lock(victim.mutex);
+    auto count = (victim.items.size() + 1) / 2;
+    for (size_t taken = 0; taken < count; ++taken) {
+      stolen.push_back(std::move(victim.items.front()));
+      victim.items.pop_front();
+    }
+  }
+  if (stolen.empty()) {
+    return false;
+  }
+
+  // the oldest task is run at once, the others are kept in the same order in the own queue
+  work = std::move(stolen.front());
+  if (stolen.size() > 1) {
+    auto& own = *queues[thief];
+    std::lock_guard lock(own.mutex);
+    for (size_t n = 1; n < stolen.size(); ++n) {
+      own.items.push_back(std::move(stolen[n]));
+    }
+  }
+  return true;
+}
+
+bool task_scheduler::run_one(unsigned index) {
+  if (queued.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  item work;
+  if (!pop(index, work) && !steal(index, work)) {
+    return false;
+  }
+  queued.fetch_sub(1, std::memory_order_relaxed);
+  execute(work);
+  return true;
+}
+
+void task_scheduler::execute(item& work) {
+  auto& group = *work.group;
+  try {
+    work.run();
+  } catch (...) {
+    std::lock_guard lock(group.mutex);
+    if (!group.error) {
+      group.error = std::current_exception();
+    }
+  }
+  work.run = nullptr;
+
+  // the group can be destroyed by its waiter right after the last decrement, so it's not
+  // touched anymore, the waiters are woken with the scheduler's mutex
+  if (group.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    { std::lock_guard lock(sleep_mutex); }
+    finished.notify_all();
+  }
+}
+
+void task_scheduler::run(unsigned index) {
+  current_scheduler = this;
+  current_index = index;
+  while (true) {
+    if (run_one(index)) {
+      continue;
+    }
+
+    bool found = false;
+    for (int spin = 0; spin < idle_spins && !found; ++spin) {
+      std::this_thread::yield();
+      found = queued.load(std::memory_order_relaxed) > 0;
+    }
+    if (found) {
+      continue;
+    }
+
+    std::unique_lock lock(sleep_mutex);
+    sleepers.fetch_add(1);
+    wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+    sleepers.fetch_sub(1);
+    if (stopping && queued.load() == 0) {
+      return;
+    }
+  }
+}
+
+}  // namespace slchess
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace slchess {
+
+/**
+ * A set of tasks which can be waited for together.
+ *
+ * The group must live until `task_scheduler::wait` returns.
+ */
+class task_group {
+ private:
+  friend class task_scheduler;
+
+  std::atomic<size_t> pending{0};
+  std::mutex mutex;
+  std::exception_ptr error;
+
+ public:
+  task_group() = default;
+  task_group(const task_group&) = delete;
+  task_group& operator=(const task_group&) = delete;
+};
+
+/**
+ * A work stealing thread pool for the short tasks: perft subtrees, games, positions.
+ *
+ * Every worker has its own queue in its own cache line. A task submitted by a worker goes to
+ * the back of its queue and the worker takes its tasks from the back, so the recently split
+ * work is done while it's in the cache. A task submitted by another thread goes to the queues
+ * in turns. An idle worker steals half of the tasks from the front of another queue, where
+ * the oldest and usually the largest tasks are, so a few steals are enough to balance the load,
+ * and the queues are locked only by their owners most of the time.
+ *
+ * The workers sleep when there is no work, so an idle pool doesn't use the CPU.
+ *
+ * @code
+ * task_scheduler scheduler;
+ * task_group group;
+ * for (auto& job : jobs) {
+ *   scheduler.submit(group, [&job] { job.run(); });
+ * }
+ * scheduler.wait(group);
+ * @endcode
+ */
+class task_scheduler {
+ public:
+  using task = std::function<void()>;
+
+ private:
+  struct item {
+    task run;
+    task_group* group = nullptr;
+  };
+
+  struct alignas(64) worker_queue {
+    std::mutex mutex;
+    std::deque<item> items;
+  };
+
+  std::vector<std::unique_ptr<worker_queue>> queues;
+  std::vector<std::thread> threads;
+
+  std::atomic<size_t> queued{0};  ///< Number of the tasks in all the queues.
+  std::atomic<size_t> next_queue{0};
+  std::atomic<unsigned> sleepers{0};
+  bool stopping = false;
+  std::mutex sleep_mutex;
+  std::condition_variable wake;      ///< Signalled when a task is queued.
+  std::condition_variable finished;  ///< Signalled when a group has no more pending tasks.
+
+  void run(unsigned index);
+  bool pop(unsigned index, item& work);
+  bool steal(unsigned thief, item& work);
+  bool run_one(unsigned index);
+  void execute(item& work);
+
+ public:
+  /**
+   * Starts the workers.
+   *
+   * @param threads Number of the workers, 0 means all the cores.
+   */
+  explicit task_scheduler(unsigned threads = 0);
+
+  /**
+   * Runs all the queued tasks and stops the workers.
+   */
+  ~task_scheduler();
+
+  task_scheduler(const task_scheduler&) = delete;
+  task_scheduler& operator=(const task_scheduler&) = delete;
+
+  /**
+   * Queues the task. It can be called from any thread, also from the tasks.
+   */
+  void submit(task_group& group, task work);
+
+  /**
+   * Waits until all the tasks of the group are finished.
+   *
+   * A worker waiting for the group runs the queued tasks in the meantime, so the tasks can
+   * wait for their subtasks without blocking the pool.
+   *
+   * @throws Rethrows the first exception thrown by a task of the group.
+   */
+  void wait(task_group& group);
+
+  /**
+   * Calls `body(begin, end)` for the ranges of at most `grain` indices covering `[0, count)`,
+   * in parallel, and waits for all of them.
+   *
+   * The range is split in halves, so the stolen tasks are large and the number of steals is
+   * logarithmic in the number of the ranges.
+   */
+  template <typename F>
+  void parallel_for(size_t count, size_t grain, F&& body) {
+    grain = std::max<size_t>(grain, 1);
+    task_group group;
+    std::function<void(size_t, size_t)> split = [&](size_t begin, size_t end) {
+      while (end - begin > grain) {
+        auto middle = begin + (end - begin) / 2;
+        submit(group, [&split, middle, end] { split(middle, end); });
+        end = middle;
+      }
+      body(begin, end);
+    };
+    if (count > 0) {
+      submit(group, [&split, count] { split(0, count); });
+      wait(group);
+    }
+  }
+
+  /**
+   * Returns the number of the workers.
+   */
+  [[nodiscard]] size_t size() const { return queues.size(); }
+
+  /**
+   * Returns the index of the worker running the calling task, lower than `size()`, so
+   * the tasks can keep their state per worker without locking. It returns `size()` when
+   * called by a thread which isn't a worker of this scheduler.
+   */
+  [[nodiscard]] size_t worker_index() const;
+};
+
+}  // namespace slchess
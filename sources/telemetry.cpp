@@ -0,0 +1,108 @@
+#include "telemetry.hpp"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/stdout_sinks.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <mutex>
+
+namespace slchess::telemetry {
+
+namespace {
+
+std::mutex logger_mutex;
+std::shared_ptr<spdlog::logger> logger;
+
+/// The raw pointer of the `logger`, checked by the logging threads without any lock.
+std::atomic<spdlog::logger*> active = nullptr;
+
+}  // namespace
+
+void start(const std::string& path, size_t queue_size) {
+  stop();
+  std::lock_guard lock(logger_mutex);
+
+  spdlog::sink_ptr sink;
+  if (path == "-") {
+    sink = std::make_shared<spdlog::sinks::stderr_sink_mt>();
+  } else {
+    sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path);
+  }
+  spdlog::init_thread_pool(queue_size, 1);
+  logger = std::make_shared<spdlog::async_logger>("telemetry",
+                                                  std::move(sink),
+                                                  spdlog::thread_pool(),
+                                                  spdlog::async_overflow_policy::overrun_oldest);
+  logger->set_pattern(R"({"time":"%Y-%m-%dT%H:%M:%S.%f","level":"%l","thread":%t,%v})");
+  active = logger.get();
+}
+
+void stop() {
+  std::lock_guard lock(logger_mutex);
+  active = nullptr;
+  if (logger) {
+    logger->flush();
+    logger.reset();
+    // the pool's thread writes all the queued messages before it finishes
+    spdlog::shutdown();
+  }
+}
+
+bool enabled() { return active.load(std::memory_order_relaxed) != nullptr; }
+
+event::event(std::string_view name) { field("event", name); }
+
+event& event::field(std::string_view key, int64_t value) {
+  fmt::format_to(std::back_inserter(text), ",\"{}\":{}", key, value);
+  return *this;
+}
+
+event& event::field(std::string_view key, uint64_t value) {
+  fmt::format_to(std::back_inserter(text), ",\"{}\":{}", key, value);
+  return *this;
+}
+
+event& event::field(std::string_view key, double value) {
+  // JSON has no NaN or infinity
+  if (!std::isfinite(value)) {
+    fmt::format_to(std::back_inserter(text), ",\"{}\":null", key);
+    return *this;
+  }
+  fmt::format_to(std::back_inserter(text), ",\"{}\":{}", key, value);
+  return *this;
+}
+
+event& event::field(std::string_view key, bool value) {
+  fmt::format_to(std::back_inserter(text), ",\"{}\":{}", key, value ? "true" : "false");
+  return *this;
+}
+
+event& event::field(std::string_view key, std::string_view value) {
+  fmt::format_to(std::back_inserter(text), ",\"{}\":\"", key);
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      text += '\\';
+      text += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      fmt::format_to(std::back_inserter(text), "\\u{:04x}", static_cast<int>(c));
+    } else {
+      text += c;
+    }
+  }
+  text += '"';
+  return *this;
+}
+
+void event::log() const {
+  auto* log = active.load(std::memory_order_acquire);
+  if (log != nullptr) {
+    log->info("{}", fields());
+  }
+}
+
+}  // namespace slchess::telemetry
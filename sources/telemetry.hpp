@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace slchess::telemetry {
+
+/**
+ * Starts writing the telemetry events to the file.
+ *
+ * The events are logged by an asynchronous spdlog logger: the calling thread only formats
+ * the message and puts it into a queue, and a separate thread writes it. When the queue is
+ * full, the oldest message is dropped, so the logging threads never wait for the disk.
+ *
+ * Every event is written as one JSON object per line:
+ * `{"time":"...","level":"info","thread":123,"event":"iteration","depth":5,...}`.
+ *
+ * @param path Output file, the events are appended, "-" means the standard error.
+ * @param queue_size Number of the messages kept in the queue.
+ * @throws spdlog::spdlog_ex when the file can't be opened.
+ */
+void start(const std::string& path, size_t queue_size = 8192);
+
+/**
+ * Writes all the queued events and stops the logging.
+ *
+ * It must not be called while other threads can log the events.
+ */
+void stop();
+
+/**
+ * Returns true if the telemetry is started.
+ *
+ * It's cheap, so the callers should check it before preparing the event.
+ */
+[[nodiscard]] bool enabled();
+
+/**
+ * A telemetry event built field by field.
+ *
+ * @code
+ * if (telemetry::enabled()) {
+ *   telemetry::event("iteration").field("depth", depth).field("nodes", nodes).log();
+ * }
+ * @endcode
+ */
+class event {
+ private:
+  std::string text;
+
+ public:
+  explicit event(std::string_view name);
+
+  event& field(std::string_view key, int64_t value);
+  event& field(std::string_view key, uint64_t value);
+  event& field(std::string_view key, int value) { return field(key, static_cast<int64_t>(value)); }
+  event& field(std::string_view key, bool value);
+
+  /**
+   * Adds the number field, NaN and the infinities are written as null.
+   */
+  event& field(std::string_view key, double value);
+
+  /**
+   * Adds the string field, the value is escaped.
+   */
+  event& field(std::string_view key, std::string_view value);
+  event& field(std::string_view key, const char* value) {
+    return field(key, std::string_view(value));
+  }
+
+  /**
+   * Returns the fields of the event, without the enclosing braces.
+   */
+  [[nodiscard]] std::string_view fields() const { return std::string_view(text).substr(1); }
+
+  /**
+   * Queues the event for writing, it does nothing when the telemetry is not started.
+   */
+  void log() const;
+};
+
+}  // namespace slchess::telemetry
@@ -0,0 +1,96 @@
+#include "time_manager.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace slchess {
+
+namespace {
+
+/// The remaining moves expected at the start of the game, and at least in the endgame.
+constexpr int opening_moves_left = 45;
+constexpr int endgame_moves_left = 20;
+
+}  // namespace
+
+time_manager::time_manager(const time_control& control, int ply) {
+  if (!control.is_limited()) {
+    throw std::invalid_argument("the time control has no limit");
+  }
+
+  if (control.move_time.count() > 0) {
+    fixed = true;
+    optimum_time = std::max(control.move_time - control.overhead, milliseconds(1));
+    maximum_time = optimum_time;
+    budget_time = optimum_time;
+    return;
+  }
+
+  auto usable = std::max(control.remaining - control.overhead, milliseconds(1));
+  int moves_left = control.moves_to_go > 0
+                       ? std::min(control.moves_to_go, opening_moves_left)
+                       : std::max(opening_moves_left - ply / 4, endgame_moves_left);
+
+  // the increments of the remaining moves are spent in advance, but never more than the clock
+  auto pool = usable + control.increment * (moves_left - 1);
+  maximum_time = std::max(std::min(pool / moves_left * 5, usable * 4 / 5), milliseconds(1));
+  optimum_time = std::min(pool / moves_left, maximum_time);
+  budget_time = optimum_time;
+}
+
+bool time_manager::next_iteration(move best, int score, milliseconds elapsed) {
+  ++iterations;
+  auto duration = elapsed - previous_elapsed;
+
+  // the best move changes are remembered for a few iterations
+  instability /= 2;
+  if (iterations > 1 && best != previous_best) {
+    instability += 1;
+    stable_iterations = 0;
+  } else {
+    ++stable_iterations;
+  }
+
+  double factor = (1 + instability) * std::max(0.5, 1.1 - 0.05 * stable_iterations);
+  if (iterations > 1) {
+    // a falling score means the search found a problem, it needs time to find a way out
+    factor *= 1 + std::clamp(previous_score - score, 0, 200) / 200.0;
+  }
+  budget_time = std::min(
+      milliseconds(static_cast<int64_t>(static_cast<double>(optimum_time.count()) * factor)),
+      maximum_time);
+
+  // every iteration takes a few times longer than the previous one
+  double growth = previous_duration.count() > 0
+                      ? std::clamp(static_cast<double>(duration.count()) /
+                                       static_cast<double>(previous_duration.count()),
+                                   1.5, 4.0)
+                      : 2.0;
+  auto predicted_end =
+      static_cast<double>(elapsed.count()) + static_cast<double>(duration.count()) * growth;
+
+  previous_best = best;
+  previous_score = score;
+  previous_elapsed = elapsed;
+  previous_duration = duration;
+  return fixed || predicted_end <= static_cast<double>(budget_time.count());
+}
+
+stop_timer::stop_timer(std::chrono::steady_clock::time_point deadline, std::atomic<bool>& flag)
+    : thread([this, deadline, &flag] {
+        std::unique_lock lock(mutex);
+        if (!wake.wait_until(lock, deadline, [this] { return cancelled; })) {
+          flag.store(true, std::memory_order_relaxed);
+        }
+      }) {}
+
+stop_timer::~stop_timer() {
+  {
+    std::lock_guard lock(mutex);
+    cancelled = true;
+  }
+  wake.notify_one();
+  thread.join();
+}
+
+}  // namespace slchess
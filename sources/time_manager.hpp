@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "move.hpp"
+
+namespace slchess {
+
+using milliseconds = std::chrono::milliseconds;
+
+/**
+ * The clock of the side to move. The zero values mean "not set".
+ */
+struct time_control {
+  milliseconds remaining{0};  ///< Time left on the clock.
+  milliseconds increment{0};  ///< Time added after every move.
+  int moves_to_go = 0;        ///< Moves to the next time control, zero means the whole game.
+  milliseconds move_time{0};  ///< Exact time for this move, it overrides the clock.
+  milliseconds overhead{20};  ///< Time reserved for the communication delay of every move.
+
+  [[nodiscard]] bool is_limited() const {
+    return remaining.count() > 0 || move_time.count() > 0;
+  }
+};
+
+/**
+ * Splits the clock into the think time of one move.
+ *
+ * Two budgets are computed when the search starts: the optimum time, which the search is
+ * expected to use, and the maximum time, after which it's stopped in the middle of an iteration.
+ * After every iteration the optimum is scaled: it's extended when the best move changes or
+ * the score drops, and cut when the best move stays the same. The next iteration isn't started
+ * when it's predicted to end after the budget, so the time isn't spent on an iteration which
+ * would be stopped before its result could be used.
+ */
+class time_manager {
+ private:
+  milliseconds optimum_time{0};
+  milliseconds maximum_time{0};
+  milliseconds budget_time{0};
+  bool fixed = false;
+
+  int iterations = 0;
+  move previous_best;
+  int previous_score = 0;
+  int stable_iterations = 0;
+  double instability = 0;
+  milliseconds previous_elapsed{0};
+  milliseconds previous_duration{0};
+
+ public:
+  time_manager() = default;
+
+  /**
+   * Allocates the time for the move.
+   *
+   * Without `moves_to_go` the number of the remaining moves is estimated from the game ply,
+   * so the engine thinks longer in the middlegame and still keeps the time for the endgame.
+   *
+   * @param control Clock of the side to move, it must be limited.
+   * @param ply Number of the half moves played in the game.
+   * @throws std::invalid_argument when the clock has no limit.
+   */
+  time_manager(const time_control& control, int ply);
+
+  /**
+   * Returns the time the search is expected to use, before the adjustments.
+   */
+  [[nodiscard]] milliseconds optimum() const { return optimum_time; }
+
+  /**
+   * Returns the hard limit of the search.
+   */
+  [[nodiscard]] milliseconds maximum() const { return maximum_time; }
+
+  /**
+   * Returns the optimum time adjusted by the completed iterations.
+   */
+  [[nodiscard]] milliseconds budget() const { return budget_time; }
+
+  /**
+   * Updates the budget with the result of the completed iteration.
+   *
+   * @param best Best move of the iteration.
+   * @param score Score of the iteration.
+   * @param elapsed Time since the search start.
+   * @return True if the next iteration should be started.
+   */
+  bool next_iteration(move best, int score, milliseconds elapsed);
+};
+
+/**
+ * Sets the flag when the deadline passes, from its own thread.
+ *
+ * The search only polls the flag, so it never reads the clock on the hot path. The timer is
+ * cancelled when it's destroyed.
+ */
+class stop_timer {
+ private:
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool cancelled = false;
+  std::thread thread;
+
+ public:
+  stop_timer(std::chrono::steady_clock::time_point deadline, std::atomic<bool>& flag);
+  ~stop_timer();
+
+  stop_timer(const stop_timer&) = delete;
+  stop_timer& operator=(const stop_timer&) = delete;
+};
+
+}  // namespace slchess
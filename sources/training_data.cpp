@@ -0,0 +1,289 @@
+#include "training_data.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "movegen.hpp"
+#include "packed_position.hpp"
+#include "search.hpp"
+
+namespace slchess {
+
+packed_sample pack_sample(const position& pos, int score, int result) {
+  auto occupied = pos.pieces();
+  if (occupied.count() > 32) {
+    throw std::invalid_argument("Position has more than 32 pieces.");
+  }
+
+  packed_sample sample;
+  sample.occupancy = occupied.to_ullong();
+  packed::write_piece_codes(
+      sample.occupancy, [&](square_index sq) { return pos.piece_on(sq); }, sample.pieces);
+
+  sample.state = static_cast<uint8_t>(pos.side_to_move() | (pos.castling_rights() << 1));
+  sample.en_passant = pos.en_passant();
+  sample.halfmove_clock = static_cast<uint8_t>(std::min(pos.halfmove_clock(), 255U));
+  sample.fullmove_number = static_cast<uint16_t>(pos.fullmove_number());
+  sample.score = static_cast<int16_t>(std::clamp(score, -score_infinite, score_infinite));
+  sample.result = static_cast<int8_t>(result);
+  return sample;
+}
+
+position unpack_position(const packed_sample& sample) {
+  if (std::popcount(sample.occupancy) > 32) {
+    throw std::invalid_argument("Training sample has more than 32 pieces.");
+  }
+  if (sample.en_passant > no_square) {
+    throw std::invalid_argument("Training sample has an invalid en passant square.");
+  }
+  position pos;
+  packed::read_piece_codes(sample.occupancy, sample.pieces, [&](square_index sq, uint8_t code) {
+    if ((code & 7) == 0 || (code & 7) > 6) {
+      throw std::invalid_argument("Training sample has an invalid piece code.");
+    }
+    pos.put_piece(piece(code), sq);
+  });
+  pos.set_state(color(sample.state & 1),
+                sample.state >> 1,
+                sample.en_passant,
+                sample.halfmove_clock,
+                sample.fullmove_number);
+  pos.validate();
+  return pos;
+}
+
+std::vector<packed_sample> read_samples(const std::string& path) {
+  std::ifstream input(path, std::ios::binary | std::ios::ate);
+  if (!input) {
+    throw std::runtime_error("Can't open the training data file: " + path);
+  }
+  auto size = static_cast<size_t>(input.tellg());
+  if (size % sizeof(packed_sample) != 0) {
+    throw std::runtime_error("Training data file has invalid size: " + path);
+  }
+  std::vector<packed_sample> samples(size / sizeof(packed_sample));
+  input.seekg(0);
+  input.read(reinterpret_cast<char*>(samples.data()), static_cast<std::streamsize>(size));
+  if (!input) {
+    throw std::runtime_error("Can't read the training data file: " + path);
+  }
+  // a foreign or a corrupted file must not reach the move generation
+  for (size_t n = 0; n < samples.size(); ++n) {
+    try {
+      static_cast<void>(unpack_position(samples[n]));
+    } catch (const std::invalid_argument& e) {
+      throw std::runtime_error("Training data file " + path + " has an invalid sample " +
+                               std::to_string(n) + ": " + e.what());
+    }
+  }
+  return samples;
+}
+
+sample_writer::sample_writer(const std::string& path)
+    : file_path(path), output(path, std::ios::binary | std::ios::trunc) {
+  if (!output) {
+    throw std::runtime_error("Can't open the training data file: " + path);
+  }
+  thread = std::thread(&sample_writer::run, this);
+}
+
+sample_writer::~sample_writer() {
+  {
+    std::lock_guard lock(mutex);
+    finished = true;
+  }
+  ready.notify_all();
+  thread.join();
+}
+
+void sample_writer::submit(std::vector<packed_sample>&& buffer) {
+  if (buffer.empty()) {
+    return;
+  }
+  {
+    std::lock_guard lock(mutex);
+    queue.push_back(std::move(buffer));
+  }
+  ready.notify_all();
+}
+
+uint64_t sample_writer::flush() {
+  std::unique_lock lock(mutex);
+  ready.wait(lock, [this] { return queue.empty(); });
+  if (!failed() && !output.flush()) {
+    failed_.store(true, std::memory_order_relaxed);
+  }
+  if (failed()) {
+    throw std::runtime_error("Can't write the training data file: " + file_path + ", only " +
+                             std::to_string(written_) + " samples were written.");
+  }
+  return written_;
+}
+
+void sample_writer::run() {
+  std::unique_lock lock(mutex);
+  while (true) {
+    ready.wait(lock, [this] { return finished || !queue.empty(); });
+    if (queue.empty()) {
+      break;
+    }
+    auto buffer = std::move(queue.front());
+
+    // the file is written without the lock, so the workers can submit in the meantime
+    lock.unlock();
+    bool good = false;
+    if (!failed()) {
+      good = static_cast<bool>(
+          output.write(reinterpret_cast<const char*>(buffer.data()),
+                       static_cast<std::streamsize>(buffer.size() * sizeof(packed_sample))));
+    }
+    lock.lock();
+
+    // the buffer is removed after writing, so `flush` waits for the write to finish
+    queue.pop_front();
+    if (good) {
+      written_ += buffer.size();
+    } else {
+      failed_.store(true, std::memory_order_relaxed);
+    }
+    ready.notify_all();
+  }
+  if (!failed()) {
+    output.flush();
+  }
+}
+
+namespace {
+
+/**
+ * Returns true if the position happened at least twice before.
+ */
+bool is_threefold(const position& pos, const std::vector<uint64_t>& keys) {
+  int repetitions = 0;
+  auto distance = std::min<size_t>(pos.halfmove_clock(), keys.size() - 1);
+  for (size_t back = 2; back <= distance; back += 2) {
+    if (keys[keys.size() - 1 - back] == pos.key() && ++repetitions == 2) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Plays one self-play game and appends its positions to the samples.
+ */
+void play_game(const gensfen_options& options,
+               searcher& search,
+               std::mt19937_64& rng,
+               std::vector<packed_sample>& samples) {
+  auto pos = position::start();
+  std::vector<uint64_t> keys = {pos.key()};
+  move_list moves;
+
+  for (int ply = 0; ply < options.random_plies; ++ply) {
+    generate_legal(pos, moves);
+    if (moves.empty()) {
+      return;
+    }
+    pos.make_move(moves[rng() % moves.size()]);
+    keys.push_back(pos.key());
+  }
+
+  auto first = samples.size();
+  int white_result = 0;
+  for (int ply = 0; ply < options.max_plies; ++ply) {
+    generate_legal(pos, moves);
+    if (moves.empty()) {
+      if (pos.in_check()) {
+        white_result = pos.side_to_move() == white ? -1 : 1;
+      }
+      break;
+    }
+    if (pos.halfmove_clock() >= 100 || pos.insufficient_material() || is_threefold(pos, keys)) {
+      break;
+    }
+
+    search.set_game_history({keys.begin(), keys.end() - 1});
+    auto result = search.search(pos, {options.depth, 0});
+    if (!pos.in_check() && !is_mate_score(result.score)) {
+      samples.push_back(pack_sample(pos, result.score, 0));
+    }
+
+    pos.make_move(result.best_move);
+    keys.push_back(pos.key());
+  }
+
+  for (auto n = first; n < samples.size(); ++n) {
+    auto& sample = samples[n];
+    sample.result = static_cast<int8_t>((sample.state & 1) == white ? white_result : -white_result);
+  }
+}
+
+}  // namespace
+
+uint64_t gensfen(const gensfen_options& options) {
+  task_scheduler scheduler(options.threads);
+  return gensfen(options, scheduler);
+}
+
+uint64_t gensfen(const gensfen_options& options, task_scheduler& scheduler) {
+  sample_writer writer(options.output);
+  std::atomic<uint64_t> generated = 0;
+
+  struct worker_state {
+    searcher search;
+    std::mt19937_64 rng;
+    std::vector<packed_sample> game;
+    std::vector<packed_sample> buffer;
+  };
+  std::vector<std::unique_ptr<worker_state>> workers;
+  for (size_t id = 0; id < scheduler.size(); ++id) {
+    auto& state = *workers.emplace_back(std::make_unique<worker_state>());
+    state.rng.seed(options.seed + id);
+    state.buffer.reserve(options.buffer_size);
+  }
+
+  // every game is a task, which queues the next game when more positions are needed
+  task_group group;
+  std::function<void()> play = [&] {
+    auto& state = *workers[scheduler.worker_index()];
+    if (generated.load(std::memory_order_relaxed) >= options.count || writer.failed()) {
+      return;
+    }
+    state.game.clear();
+    play_game(options, state.search, state.rng, state.game);
+
+    // reserve the place for the game positions, the last game may be cut
+    auto start = generated.fetch_add(state.game.size());
+    if (start >= options.count) {
+      return;
+    }
+    auto take = std::min<uint64_t>(state.game.size(), options.count - start);
+    state.buffer.insert(state.buffer.end(), state.game.begin(),
+                        state.game.begin() + static_cast<ptrdiff_t>(take));
+
+    if (state.buffer.size() >= options.buffer_size) {
+      writer.submit(std::move(state.buffer));
+      state.buffer = {};
+      state.buffer.reserve(options.buffer_size);
+    }
+    scheduler.submit(group, play);
+  };
+  for (size_t n = 0; n < scheduler.size(); ++n) {
+    scheduler.submit(group, play);
+  }
+  scheduler.wait(group);
+
+  for (auto& state : workers) {
+    writer.submit(std::move(state->buffer));
+  }
+  return writer.flush();
+}
+
+}  // namespace slchess
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "position.hpp"
+#include "task_scheduler.hpp"
+
+namespace slchess {
+
+static_assert(std::endian::native == std::endian::little,
+              "The training data files are written as little-endian.");
+
+/**
+ * A labeled position stored in 32 bytes.
+ *
+ * The pieces are stored as the occupancy bitboard followed by the 4 bit piece codes of the
+ * occupied squares in the layout of `packed::write_piece_codes`, the same as in
+ * `encode_position`. That's enough for any position with at most 32 pieces.
+ *
+ * The structure is written to the files as it is in the memory, so it must not have padding.
+ */
+struct packed_sample {
+  uint64_t occupancy = 0;
+  std::array<uint8_t, 16> pieces{};
+  uint8_t state = 0;  ///< Bit 0 is the side to move, bits 1-4 are the castling rights.
+  uint8_t en_passant = no_square;
+  uint8_t halfmove_clock = 0;
+  int8_t result = 0;  ///< Game result for the side to move: 1 for a win, 0 draw, -1 loss.
+  int16_t score = 0;  ///< Search score in centipawns for the side to move.
+  uint16_t fullmove_number = 1;
+};
+
+static_assert(sizeof(packed_sample) == 32, "packed_sample must be exactly 32 bytes.");
+
+/**
+ * Packs the position with its labels.
+ *
+ * @throws std::invalid_argument when the position has more than 32 pieces.
+ */
+[[nodiscard]] packed_sample pack_sample(const position& pos, int score, int result);
+
+/**
+ * Unpacks the position from the sample, the score and the result are available in the sample.
+ *
+ * @throws std::invalid_argument when the sample is not a legal position, e.g. it has an invalid
+ * piece code or en passant square, see also `position::validate`.
+ */
+[[nodiscard]] position unpack_position(const packed_sample& sample);
+
+/**
+ * Reads all the samples from a file written by the `sample_writer`.
+ *
+ * Every sample is checked with `unpack_position`.
+ *
+ * @throws std::runtime_error when the file can't be read or it has an invalid sample.
+ */
+[[nodiscard]] std::vector<packed_sample> read_samples(const std::string& path);
+
+/**
+ * Writes buffers of samples to a file in a separate thread.
+ *
+ * The producers fill their own buffers and pass whole buffers with `submit`, so the lock is
+ * taken once per buffer, not once per sample. The destructor writes all the pending buffers.
+ *
+ * When a write fails (e.g. the disk is full), the following buffers are dropped and the failure
+ * is reported by `flush`.
+ */
+class sample_writer {
+ private:
+  std::string file_path;
+  std::ofstream output;
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::deque<std::vector<packed_sample>> queue;
+  bool finished = false;
+  uint64_t written_ = 0;
+  std::atomic<bool> failed_{false};
+  std::thread thread;
+
+  void run();
+
+ public:
+  /**
+   * Opens the file for writing, the existing file is truncated.
+   *
+   * @throws std::runtime_error when the file can't be opened.
+   */
+  explicit sample_writer(const std::string& path);
+  ~sample_writer();
+
+  sample_writer(const sample_writer&) = delete;
+  sample_writer& operator=(const sample_writer&) = delete;
+
+  /**
+   * Queues the buffer for writing.
+   */
+  void submit(std::vector<packed_sample>&& buffer);
+
+  /**
+   * Writes all the queued buffers and waits until they are written.
+   *
+   * @return Number of the samples written so far.
+   * @throws std::runtime_error when a write has failed.
+   */
+  uint64_t flush();
+
+  /**
+   * Returns true if a write has failed, so the producers can stop early.
+   */
+  [[nodiscard]] bool failed() const { return failed_.load(std::memory_order_relaxed); }
+};
+
+/**
+ * Options for the self-play training data generation.
+ */
+struct gensfen_options {
+  std::string output = "training_data.bin";
+  uint64_t count = 1'000'000;  ///< Number of positions to generate.
+  int depth = 4;               ///< Search depth for every move.
+  unsigned threads = 0;        ///< Number of the worker threads, 0 means all the cores.
+  int random_plies = 8;        ///< Number of random moves played at the beginning of a game.
+  int max_plies = 400;         ///< Games longer than this are adjudicated as a draw.
+  uint64_t seed = 0;
+  size_t buffer_size = 4096;  ///< Number of samples buffered by a worker before writing.
+};
+
+/**
+ * Generates the training data by playing the fixed depth self-play games.
+ *
+ * Every game is a task of the `task_scheduler`. A worker keeps the positions of its games in its
+ * own buffer, and the full buffers are written to the output by a single writer thread.
+ * The positions in check are skipped, as the static evaluation is meaningless for them.
+ *
+ * @return Number of the written positions.
+ * @throws std::runtime_error when the output can't be opened or written.
+ */
+uint64_t gensfen(const gensfen_options& options);
+
+/**
+ * Generates the training data on the workers of the scheduler, `options.threads` is ignored.
+ */
+uint64_t gensfen(const gensfen_options& options, task_scheduler& scheduler);
+
+}  // namespace slchess
@@ -0,0 +1,98 @@
+#include "transposition_table.hpp"
+
+#include <algorithm>
+
+#include "stats.hpp"
+
+namespace slchess {
+
+namespace {
+
+/**
+ * The data word: move in bits 0-15, score 16-31, depth 32-39, bound 40-41 and the generation
+ * in bits 48-55. The stored entries always have a bound, so the empty entry has zero data.
+ */
+uint64_t pack(move best_move, int score, int depth, bound type, uint8_t generation) {
+  return best_move.raw() | (static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16) |
+         (static_cast<uint64_t>(depth) << 32) | (static_cast<uint64_t>(type) << 40) |
+         (static_cast<uint64_t>(generation) << 48);
+}
+
+tt_entry unpack(uint64_t data) {
+  return {move::from_raw(static_cast<uint16_t>(data)),
+          static_cast<int16_t>(data >> 16),
+          static_cast<int>((data >> 32) & 0xff),
+          bound((data >> 40) & 3)};
+}
+
+uint8_t generation_of(uint64_t data) { return static_cast<uint8_t>(data >> 48); }
+
+}  // namespace
+
+transposition_table::transposition_table(size_t megabytes, unsigned threads) {
+  resize(megabytes, threads);
+}
+
+void transposition_table::resize(size_t megabytes, unsigned threads) {
+  auto count =
+      std::max<uint64_t>(megabytes * 1024 * 1024 / (bucket_size * sizeof(lockless_entry)), 1);
+  // the table is unchanged if the allocation throws
+  memory = large_buffer(count * bucket_size * sizeof(lockless_entry));
+  table = lockless_table(memory.data(), count);
+  generation = 0;
+  // the memory is already zeroed, but touching it in parallel maps all the pages much faster
+  memory.clear(threads);
+}
+
+void transposition_table::clear(unsigned threads) {
+  memory.clear(threads);
+  generation = 0;
+}
+
+int transposition_table::hashfull() const {
+  auto sample = std::min<size_t>(capacity(), 1000);
+  size_t used = 0;
+  for (size_t n = 0; n < sample; ++n) {
+    auto data = table.entry(n).load_data();
+    used += data != 0 && generation_of(data) == generation ? 1 : 0;
+  }
+  return static_cast<int>(used * 1000 / sample);
+}
+
+std::optional<tt_entry> transposition_table::probe(uint64_t key) const {
+  stats::add(stat_counter::tt_probes);
+  auto data = table.probe(key);
+  if (data == 0) {
+    return std::nullopt;
+  }
+  stats::add(stat_counter::tt_hits);
+  return unpack(data);
+}
+
+void transposition_table::store(uint64_t key, move best_move, int score, int depth, bound type) {
+  if (depth < 1) {
+    return;
+  }
+  depth = std::min(depth, 255);
+
+  auto age = [this](uint64_t data) {
+    return static_cast<int>(static_cast<uint8_t>(generation - generation_of(data)));
+  };
+  // the least valuable entry is the shallowest one, the older searches count as shallower
+  auto slot =
+      table.find_slot(key, [&](uint64_t data) { return unpack(data).depth - 8 * age(data); });
+  if (slot.same_key) {
+    if (age(slot.data) == 0 && unpack(slot.data).depth > depth + 2 && type != bound::exact) {
+      return;
+    }
+    // the result without a move doesn't remove the move found before
+    if (best_move.is_none()) {
+      best_move = unpack(slot.data).best_move;
+    }
+  } else if (slot.data != 0) {
+    stats::add(stat_counter::tt_collisions);
+  }
+  slot.entry->save(key, pack(best_move, score, depth, type, generation));
+}
+
+}  // namespace slchess
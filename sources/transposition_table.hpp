@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "large_memory.hpp"
+#include "lockless_table.hpp"
+#include "move.hpp"
+
+namespace slchess {
+
+/**
+ * Kind of the score kept in the transposition table.
+ */
+enum class bound : uint8_t {
+  none = 0,
+  upper = 1,  ///< The real score is at most the stored one (no move raised alpha).
+  lower = 2,  ///< The real score is at least the stored one (beta cutoff).
+  exact = 3,
+};
+
+/**
+ * A transposition table entry.
+ */
+struct tt_entry {
+  move best_move;
+  int score = 0;
+  int depth = 0;
+  bound type = bound::none;
+};
+
+/**
+ * The transposition table: results of the searched nodes, shared by the searches.
+ *
+ * The entries are kept in a `lockless_table`, so the table is shared by many search threads
+ * without any locks.
+ *
+ * The memory is a `large_buffer`, so a big table is backed by the huge pages and spread over
+ * the NUMA nodes.
+ */
+class transposition_table {
+ public:
+  static constexpr size_t bucket_size = lockless_table::bucket_size;
+
+ private:
+  large_buffer memory;
+  lockless_table table;
+  uint8_t generation = 0;
+
+ public:
+  /**
+   * Creates the table of the given size.
+   *
+   * @param megabytes Size of the table, at least one bucket is always allocated.
+   * @param threads Number of the threads clearing the memory, 0 means all the cores.
+   */
+  explicit transposition_table(size_t megabytes = 16, unsigned threads = 0);
+
+  /**
+   * Allocates a new empty table of the given size.
+   *
+   * The memory is cleared in parallel, so all its pages are mapped before the search starts.
+   *
+   * @throws std::system_error when the memory can't be allocated.
+   */
+  void resize(size_t megabytes, unsigned threads = 0);
+
+  /**
+   * Removes all the entries, e.g. before a new game.
+   */
+  void clear(unsigned threads = 0);
+
+  /**
+   * Marks the beginning of a new search, so the old entries are replaced first.
+   */
+  void new_search() { ++generation; }
+
+  /**
+   * Returns the entry for the position key.
+   */
+  [[nodiscard]] std::optional<tt_entry> probe(uint64_t key) const;
+
+  /**
+   * Stores the search result.
+   *
+   * The entry of the same position is always replaced, unless it's much deeper and it's from
+   * the current search. Otherwise the least valuable entry of the bucket is replaced: the
+   * shallowest one, with the older searches counted as shallower.
+   *
+   * @param depth Depth of the search, the results with the depth lower than 1 are not stored.
+   */
+  void store(uint64_t key, move best_move, int score, int depth, bound type);
+
+  /**
+   * Returns the number of the entries.
+   */
+  [[nodiscard]] size_t capacity() const { return table.capacity(); }
+
+  /**
+   * Returns the permille of the entries used by the current search, estimated from the first
+   * thousand entries, like the UCI "hashfull" value.
+   */
+  [[nodiscard]] int hashfull() const;
+
+  /**
+   * Returns the kind of the memory pages of the table.
+   */
+  [[nodiscard]] page_kind pages() const { return memory.pages(); }
+};
+
+}  // namespace slchess
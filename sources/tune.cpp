@@ -0,0 +1,108 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+#include "evaluate.hpp"
+#include "task_scheduler.hpp"
+#include "tuner.hpp"
+
+using namespace slchess;
+
+namespace {
+
+void print_usage() {
+  std::cout << PROJECT_NAME << "-tune " << PROJECT_VERSION << "\n\n"
+            << "Usage:\n"
+            << "  slchess-tune <file>... [epochs N] [rate R] [lambda L] [threads N]\n"
+            << "               [output PATH]\n\n"
+            << "Tunes the evaluation weights on the positions generated by `slchess gensfen`.\n";
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int run(const std::vector<std::string>& args) {
+  std::vector<std::string> files;
+  tuning_options options;
+  double lambda = 1.0;
+  unsigned threads = 0;
+  std::string output;
+  for (size_t n = 0; n < args.size(); ++n) {
+    const auto& name = args[n];
+    bool has_value = n + 1 < args.size();
+    if (name == "epochs" && has_value) {
+      options.epochs = std::stoi(args[++n]);
+    } else if (name == "rate" && has_value) {
+      options.learning_rate = std::stod(args[++n]);
+    } else if (name == "lambda" && has_value) {
+      lambda = std::stod(args[++n]);
+    } else if (name == "threads" && has_value) {
+      threads = static_cast<unsigned>(std::stoul(args[++n]));
+    } else if (name == "output" && has_value) {
+      output = args[++n];
+    } else {
+      files.push_back(name);
+    }
+  }
+  if (files.empty()) {
+    throw std::invalid_argument("no training data files");
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  tuning_set data;
+  for (const auto& file : files) {
+    data.load(file);
+  }
+  std::cerr << "positions " << data.size() << " memory " << data.memory_usage() / (1 << 20)
+            << "MB load time " << seconds_since(start) << "s\n";
+
+  task_scheduler scheduler(threads);
+  texel_tuner tuner(data, scheduler, lambda);
+  auto weights = to_tuning_weights(default_eval_weights());
+  auto scale = tuner.fit_scale(weights);
+  auto initial_loss = tuner.loss(weights);
+  std::cerr << "scale " << scale << " loss " << initial_loss << "\n";
+
+  start = std::chrono::steady_clock::now();
+  auto final_loss = tuner.tune(weights, options, [&](int epoch, double loss) {
+    if (epoch % 10 == 0) {
+      std::cerr << "epoch " << epoch << " loss " << loss << " time " << seconds_since(start)
+                << "s\n";
+    }
+  });
+  std::cerr << "loss " << initial_loss << " -> " << final_loss << " time " << seconds_since(start)
+            << "s\n";
+
+  auto result = format_eval_weights(to_eval_weights(weights));
+  if (output.empty()) {
+    std::cout << result;
+  } else {
+    std::ofstream file(output);
+    if (!(file << result)) {
+      throw std::runtime_error("Can't write the weights to: " + output);
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+  if (args.empty()) {
+    print_usage();
+    return 0;
+  }
+
+  try {
+    return run(args);
+  } catch (const std::exception& e) {
+    std::cerr << "error: " << e.what() << "\n";
+    return 1;
+  }
+}
@@ -0,0 +1,341 @@
+#include "tuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include "endgame.hpp"
+
+namespace slchess {
+
+namespace {
+
+constexpr size_t material_feature = 6 * 64;
+
+/// Positions in a task, enough to make the scheduling cost negligible.
+constexpr size_t positions_per_task = 16384;
+
+constexpr double ln10 = 2.302585092994046;
+
+/// Returns the predicted result of the evaluation.
+double predict(double eval, double scale) {
+  return 1.0 / (1.0 + std::exp(-scale * eval * ln10 / 400.0));
+}
+
+size_t feature(piece_type type, size_t table_index) {
+  return type * 64 + table_index;
+}
+
+/// Returns whether the table entry can be used, the pawns are never on the 1st and the 8th rank.
+bool is_reachable(piece_type type, size_t table_index) {
+  return type != pawn || (table_index >= 8 && table_index < 56);
+}
+
+/**
+ * Sums `f(n)` over the positions in parallel, every worker in its own slot.
+ */
+template <typename F>
+double parallel_sum(task_scheduler& scheduler, size_t count, F&& f) {
+  std::vector<double> sums(scheduler.size() * 8, 0.0);  // a slot per cache line
+  scheduler.parallel_for(count, positions_per_task, [&](size_t begin, size_t end) {
+    double sum = 0;
+    for (auto n = begin; n < end; ++n) {
+      sum += f(n);
+    }
+    sums[scheduler.worker_index() * 8] += sum;
+  });
+  return std::accumulate(sums.begin(), sums.end(), 0.0);
+}
+
+}  // namespace
+
+tuning_weights to_tuning_weights(const eval_weights& weights) {
+  tuning_weights result(2 * eval_feature_count, 0.0F);
+  for (auto type : {pawn, knight, bishop, rook, queen, king}) {
+    for (size_t index = 0; index < 64; ++index) {
+      auto n = feature(type, index);
+      result[2 * n] = static_cast<float>(weights.middle_game_tables[type][index]);
+      result[2 * n + 1] = static_cast<float>(weights.end_game_tables[type][index]);
+    }
+    result[2 * (material_feature + type)] = static_cast<float>(weights.middle_game_values[type]);
+    result[2 * (material_feature + type) + 1] = static_cast<float>(weights.end_game_values[type]);
+  }
+  return result;
+}
+
+eval_weights to_eval_weights(const tuning_weights& weights) {
+  if (weights.size() != 2 * eval_feature_count) {
+    throw std::invalid_argument("Invalid number of the tuning weights.");
+  }
+
+  eval_weights result;
+  for (auto type : {pawn, knight, bishop, rook, queen, king}) {
+    for (size_t phase = 0; phase < 2; ++phase) {
+      auto& table = phase == 0 ? result.middle_game_tables[type] : result.end_game_tables[type];
+      auto& value = phase == 0 ? result.middle_game_values[type] : result.end_game_values[type];
+
+      double sum = 0;
+      int reachable = 0;
+      for (size_t index = 0; index < 64; ++index) {
+        if (is_reachable(type, index)) {
+          sum += weights[2 * feature(type, index) + phase];
+          ++reachable;
+        }
+      }
+      // every side has one king, so the king tables can be shifted without changing anything
+      auto shift = static_cast<int>(std::lround(sum / reachable));
+      value = static_cast<int>(std::lround(weights[2 * (material_feature + type) + phase]));
+      if (type != king) {
+        value += shift;
+      }
+      for (size_t index = 0; index < 64; ++index) {
+        auto weight = weights[2 * feature(type, index) + phase];
+        table[index] =
+            is_reachable(type, index) ? static_cast<int>(std::lround(weight)) - shift : 0;
+      }
+    }
+  }
+  return result;
+}
+
+std::string format_eval_weights(const eval_weights& weights) {
+  std::ostringstream output;
+  auto write_tables = [&output](const std::array<std::array<int, 64>, 6>& tables) {
+    output << "    {{\n";
+    for (const auto& table : tables) {
+      output << "        {\n";
+      for (size_t row = 0; row < 8; ++row) {
+        output << "           ";
+        for (size_t column = 0; column < 8; ++column) {
+          output << " " << table[row * 8 + column] << ",";
+        }
+        output << "  //\n";
+      }
+      output << "        },\n";
+    }
+    output << "    }},\n";
+  };
+  auto write_values = [&output](const std::array<int, 6>& values) {
+    output << "    {";
+    for (size_t type = 0; type < values.size(); ++type) {
+      output << (type > 0 ? ", " : "") << values[type];
+    }
+    output << "},\n";
+  };
+
+  output << "eval_weights{\n";
+  write_tables(weights.middle_game_tables);
+  write_tables(weights.end_game_tables);
+  write_values(weights.middle_game_values);
+  write_values(weights.end_game_values);
+  output << "}\n";
+  return output.str();
+}
+
+void tuning_set::add(const position& pos, float result, int score) {
+  if (evaluate_endgame(pos)) {
+    return;
+  }
+  std::array<int8_t, eval_feature_count> counts{};
+  for_each_square(pos.pieces(), [&](square_index sq) {
+    auto p = pos.piece_on(sq);
+    auto type = type_of(p);
+    // the same table indices as in the evaluation: the white squares are flipped
+    if (color_of(p) == white) {
+      ++counts[feature(type, flip_rank(sq))];
+      ++counts[material_feature + type];
+    } else {
+      --counts[feature(type, sq)];
+      --counts[material_feature + type];
+    }
+  });
+
+  for (size_t n = 0; n < counts.size(); ++n) {
+    if (counts[n] != 0) {
+      features.push_back(static_cast<uint16_t>(n));
+      coefficients.push_back(counts[n]);
+    }
+  }
+  offsets.push_back(static_cast<uint32_t>(features.size()));
+  phases.push_back(static_cast<uint8_t>(game_phase(pos)));
+  results.push_back(result);
+  scores.push_back(static_cast<int16_t>(std::clamp(score, -32000, 32000)));
+}
+
+void tuning_set::add(const packed_sample& sample) {
+  auto pos = unpack_position(sample);
+  auto result = static_cast<float>(sample.result + 1) / 2;
+  if (pos.side_to_move() == white) {
+    add(pos, result, sample.score);
+  } else {
+    add(pos, 1 - result, -sample.score);
+  }
+}
+
+void tuning_set::load(const std::string& path) {
+  for (const auto& sample : read_samples(path)) {
+    add(sample);
+  }
+}
+
+float tuning_set::evaluate(size_t n, const tuning_weights& weights) const {
+  float middle_game = 0;
+  float end_game = 0;
+  for (auto k = offsets[n]; k < offsets[n + 1]; ++k) {
+    const auto* weight = &weights[2 * features[k]];
+    middle_game += coefficients[k] * weight[0];
+    end_game += coefficients[k] * weight[1];
+  }
+  float phase = phases[n];
+  return (middle_game * phase + end_game * (max_phase - phase)) / max_phase;
+}
+
+size_t tuning_set::memory_usage() const {
+  return offsets.size() * sizeof(uint32_t) + features.size() * sizeof(uint16_t)
+         + coefficients.size() * sizeof(int8_t) + phases.size() * sizeof(uint8_t)
+         + results.size() * sizeof(float) + scores.size() * sizeof(int16_t);
+}
+
+texel_tuner::texel_tuner(const tuning_set& data, task_scheduler& scheduler, double lambda)
+    : data(data), scheduler(scheduler), lambda(lambda) {
+  if (data.size() == 0) {
+    throw std::invalid_argument("No positions to tune on.");
+  }
+  if (lambda < 0 || lambda > 1) {
+    throw std::invalid_argument("The lambda must be between 0 and 1.");
+  }
+  update_targets();
+}
+
+void texel_tuner::update_targets() {
+  targets.resize(data.size());
+  for (size_t n = 0; n < targets.size(); ++n) {
+    targets[n] = static_cast<float>(lambda * data.results[n]
+                                    + (1 - lambda) * predict(data.scores[n], scale_));
+  }
+}
+
+void texel_tuner::set_scale(double scale) {
+  scale_ = scale;
+  update_targets();
+}
+
+double texel_tuner::fit_scale(const tuning_weights& weights) {
+  std::vector<float> evals(data.size());
+  scheduler.parallel_for(data.size(), positions_per_task, [&](size_t begin, size_t end) {
+    for (auto n = begin; n < end; ++n) {
+      evals[n] = data.evaluate(n, weights);
+    }
+  });
+  auto loss = [&](double scale) {
+    return parallel_sum(scheduler, evals.size(), [&](size_t n) {
+      auto error = predict(evals[n], scale) - data.results[n];
+      return error * error;
+    });
+  };
+
+  // the loss is unimodal in the scale, so the golden section search finds the minimum
+  const double ratio = (std::sqrt(5.0) - 1) / 2;
+  double low = 0.01;
+  double high = 10;
+  double left = high - ratio * (high - low);
+  double right = low + ratio * (high - low);
+  double left_loss = loss(left);
+  double right_loss = loss(right);
+  while (high - low > 1e-4) {
+    if (left_loss < right_loss) {
+      high = right;
+      right = left;
+      right_loss = left_loss;
+      left = high - ratio * (high - low);
+      left_loss = loss(left);
+    } else {
+      low = left;
+      left = right;
+      left_loss = right_loss;
+      right = low + ratio * (high - low);
+      right_loss = loss(right);
+    }
+  }
+  set_scale((low + high) / 2);
+  return scale_;
+}
+
+double texel_tuner::loss(const tuning_weights& weights) const {
+  auto sum = parallel_sum(scheduler, data.size(), [&](size_t n) {
+    auto error = predict(data.evaluate(n, weights), scale_) - targets[n];
+    return error * error;
+  });
+  return sum / static_cast<double>(data.size());
+}
+
+double texel_tuner::gradient(const tuning_weights& weights, std::vector<double>& gradient) const {
+  constexpr size_t stride = 2 * eval_feature_count + 8;  // the loss and a cache line of padding
+  std::vector<double> sums(scheduler.size() * stride, 0.0);
+
+  scheduler.parallel_for(data.size(), positions_per_task, [&](size_t begin, size_t end) {
+    auto* worker_sums = &sums[scheduler.worker_index() * stride];
+    double loss = 0;
+    for (auto n = begin; n < end; ++n) {
+      auto prediction = predict(data.evaluate(n, weights), scale_);
+      auto error = prediction - targets[n];
+      loss += error * error;
+
+      // the derivative of the loss by the evaluation, split by the phase
+      auto derivative = 2 * error * prediction * (1 - prediction) * scale_ * ln10 / 400;
+      auto middle_game = derivative * data.phases[n] / max_phase;
+      auto end_game = derivative - middle_game;
+      for (auto k = data.offsets[n]; k < data.offsets[n + 1]; ++k) {
+        auto* feature_sums = &worker_sums[2 * data.features[k]];
+        feature_sums[0] += data.coefficients[k] * middle_game;
+        feature_sums[1] += data.coefficients[k] * end_game;
+      }
+    }
+    worker_sums[2 * eval_feature_count] += loss;
+  });
+
+  auto count = static_cast<double>(data.size());
+  gradient.assign(2 * eval_feature_count, 0.0);
+  double loss = 0;
+  for (size_t worker = 0; worker < scheduler.size(); ++worker) {
+    const auto* worker_sums = &sums[worker * stride];
+    for (size_t n = 0; n < gradient.size(); ++n) {
+      gradient[n] += worker_sums[n] / count;
+    }
+    loss += worker_sums[2 * eval_feature_count];
+  }
+  return loss / count;
+}
+
+double texel_tuner::tune(tuning_weights& weights,
+                         const tuning_options& options,
+                         const std::function<void(int, double)>& progress) {
+  constexpr double epsilon = 1e-12;
+  std::vector<double> gradient;
+  std::vector<double> momentum(weights.size(), 0.0);
+  std::vector<double> velocity(weights.size(), 0.0);
+  double beta1_power = 1;
+  double beta2_power = 1;
+
+  for (int epoch = 1; epoch <= options.epochs; ++epoch) {
+    auto current_loss = this->gradient(weights, gradient);
+    if (progress) {
+      progress(epoch, current_loss);
+    }
+
+    beta1_power *= options.beta1;
+    beta2_power *= options.beta2;
+    for (size_t n = 0; n < weights.size(); ++n) {
+      momentum[n] = options.beta1 * momentum[n] + (1 - options.beta1) * gradient[n];
+      velocity[n] = options.beta2 * velocity[n] + (1 - options.beta2) * gradient[n] * gradient[n];
+      auto step = (momentum[n] / (1 - beta1_power))
+                  / (std::sqrt(velocity[n] / (1 - beta2_power)) + epsilon);
+      weights[n] -= static_cast<float>(options.learning_rate * step);
+    }
+  }
+  return loss(weights);
+}
+
+}  // namespace slchess
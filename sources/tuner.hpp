@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "evaluate.hpp"
+#include "position.hpp"
+#include "task_scheduler.hpp"
+#include "training_data.hpp"
+
+namespace slchess {
+
+/**
+ * Number of the evaluation features: a piece-square feature for every piece type and square,
+ * `type * 64 + table index`, followed by a material feature for every piece type.
+ */
+constexpr size_t eval_feature_count = 6 * 64 + 6;
+
+/**
+ * The evaluation weights as the tuned parameters: the middle game and the end game weight of
+ * every feature, interleaved, so `2 * feature` is the middle game weight and `2 * feature + 1`
+ * the end game weight.
+ */
+using tuning_weights = std::vector<float>;
+
+[[nodiscard]] tuning_weights to_tuning_weights(const eval_weights& weights);
+
+/**
+ * Rounds the tuned weights to the evaluation weights.
+ *
+ * Adding a constant to all the entries of a piece-square table has the same effect as adding it
+ * to the piece value, so the average of every table is moved to the value, which keeps the tables
+ * comparable with the hand written ones. The pawn tables are averaged over the 2nd to 7th ranks.
+ */
+[[nodiscard]] eval_weights to_eval_weights(const tuning_weights& weights);
+
+/**
+ * Formats the weights as the initializer of `eval_weights`, in the layout of the tables
+ * in evaluate.cpp.
+ */
+[[nodiscard]] std::string format_eval_weights(const eval_weights& weights);
+
+/**
+ * The labeled positions for the tuning, with the features extracted once.
+ *
+ * A position is a list of its non-zero features with their coefficients, which is the number of
+ * the white pieces minus the number of the black pieces of the feature, so the evaluation is
+ * the sum of the weights multiplied by the coefficients, tapered by the game phase. The lists are
+ * stored back to back in two arrays, 3 bytes per feature, and a position with 30 pieces takes
+ * about 100 bytes.
+ */
+class tuning_set {
+ private:
+  friend class texel_tuner;
+
+  /// The features of the position `n` are at [offsets[n], offsets[n + 1]).
+  std::vector<uint32_t> offsets{0};
+  std::vector<uint16_t> features;
+  std::vector<int8_t> coefficients;
+  std::vector<uint8_t> phases;
+  std::vector<float> results;  ///< Game results for white: 1 for a win, 0.5 draw, 0 loss.
+  std::vector<int16_t> scores;  ///< Search scores for white in centipawns.
+
+ public:
+  /**
+   * Adds the position.
+   *
+   * The positions of the endgames with a special evaluator are skipped, as their scores don't
+   * depend on the weights.
+   *
+   * @param result Game result for white: 1 for a win, 0.5 draw, 0 loss.
+   * @param score Search score for white in centipawns.
+   */
+  void add(const position& pos, float result, int score);
+
+  /**
+   * Adds the position of the training sample, the labels are converted to the white side.
+   */
+  void add(const packed_sample& sample);
+
+  /**
+   * Adds all the samples from a file written by `gensfen`.
+   *
+   * @throws std::runtime_error when the file can't be read.
+   */
+  void load(const std::string& path);
+
+  /**
+   * Returns the evaluation of the position `n` with the weights, for white.
+   */
+  [[nodiscard]] float evaluate(size_t n, const tuning_weights& weights) const;
+
+  [[nodiscard]] size_t size() const { return phases.size(); }
+
+  [[nodiscard]] size_t memory_usage() const;
+};
+
+/**
+ * Options of `texel_tuner::tune`.
+ */
+struct tuning_options {
+  int epochs = 500;
+  double learning_rate = 1.0;  ///< The largest step of a weight in an epoch, in centipawns.
+  double beta1 = 0.9;
+  double beta2 = 0.999;
+};
+
+/**
+ * Tunes the evaluation weights by minimizing the mean squared error between the predicted and
+ * the labeled result, where the prediction is `1 / (1 + 10^(-scale * eval / 400))`.
+ *
+ * The target of a position is its game result mixed with the prediction of its search score:
+ * `lambda * result + (1 - lambda) * prediction(score)`.
+ *
+ * The loss and the gradient are computed in parallel on the scheduler. The positions are split
+ * into the ranges, every worker sums the gradient of its ranges in its own array, and the arrays
+ * are added at the end, so the workers never share a cache line. The weights are updated by
+ * Adam with the full batch gradient.
+ */
+class texel_tuner {
+ private:
+  const tuning_set& data;
+  task_scheduler& scheduler;
+  double lambda;
+  double scale_ = 1.0;
+  std::vector<float> targets;
+
+  void update_targets();
+
+ public:
+  /**
+   * @param lambda Weight of the game result in the targets, the rest is the search score.
+   * @throws std::invalid_argument when the set is empty or the lambda is not in [0, 1].
+   */
+  texel_tuner(const tuning_set& data, task_scheduler& scheduler, double lambda = 1.0);
+
+  /**
+   * Finds the scale minimizing the loss of the weights against the game results.
+   *
+   * @return The new scale, which is used by the tuner from now.
+   */
+  double fit_scale(const tuning_weights& weights);
+
+  [[nodiscard]] double scale() const { return scale_; }
+
+  void set_scale(double scale);
+
+  /**
+   * Returns the mean squared error of the weights.
+   */
+  [[nodiscard]] double loss(const tuning_weights& weights) const;
+
+  /**
+   * Computes the gradient of the loss.
+   *
+   * @param gradient Resized to the number of the weights.
+   * @return The loss.
+   */
+  double gradient(const tuning_weights& weights, std::vector<double>& gradient) const;
+
+  /**
+   * Optimizes the weights in place.
+   *
+   * @param progress Called after every epoch with the epoch number and the loss before it.
+   * @return The final loss.
+   */
+  double tune(tuning_weights& weights,
+              const tuning_options& options,
+              const std::function<void(int, double)>& progress = {});
+};
+
+}  // namespace slchess
@@ -0,0 +1,274 @@
+#include "uci.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "bitbase.hpp"
+#include "config.hpp"
+#include "movegen.hpp"
+
+namespace slchess {
+
+namespace {
+
+constexpr size_t default_hash = 16;
+
+/**
+ * Reads the rest of the option name or value, until the given keyword.
+ */
+std::string read_words(std::istringstream& command, const std::string& until) {
+  std::string text;
+  std::string word;
+  while (command >> word && word != until) {
+    text += (text.empty() ? "" : " ") + word;
+  }
+  return text;
+}
+
+}  // namespace
+
+std::string uci_score(int score) {
+  if (score >= score_mate - max_ply) {
+    return "mate " + std::to_string((score_mate - score + 1) / 2);
+  }
+  if (score <= -score_mate + max_ply) {
+    return "mate -" + std::to_string((score_mate + score) / 2);
+  }
+  return "cp " + std::to_string(score);
+}
+
+uci_engine::uci_engine(std::istream& in, std::ostream& out)
+    : input(in), output(out), tt(default_hash) {
+  // the bitbase is generated by its first use, which would stall the first search reaching KPK
+  static_cast<void>(kpk());
+  search.set_transposition_table(&tt);
+  search.set_iteration_callback([this](const search_result& result, milliseconds elapsed) {
+    auto nps = static_cast<uint64_t>(result.nodes * 1000 /
+                                     static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 1)));
+    for (size_t n = 0; n < result.lines.size(); ++n) {
+      const auto& line = result.lines[n];
+      std::string text = "info depth " + std::to_string(result.depth);
+      if (result.lines.size() > 1) {
+        text += " multipv " + std::to_string(n + 1);
+      }
+      text += " score " + uci_score(line.score) + " nodes " + std::to_string(result.nodes) +
+              " nps " + std::to_string(nps) + " time " + std::to_string(elapsed.count()) +
+              " hashfull " + std::to_string(tt.hashfull()) + " pv";
+      for (auto m : line.pv) {
+        text += " " + m.to_uci();
+      }
+      send(text);
+    }
+  });
+}
+
+uci_engine::~uci_engine() {
+  stop_search();
+}
+
+void uci_engine::send(const std::string& line) {
+  std::lock_guard lock(output_mutex);
+  output << line << std::endl;
+}
+
+void uci_engine::release_bestmove() {
+  {
+    std::lock_guard lock(hold_mutex);
+    infinite = false;
+    pondering = false;
+  }
+  released.notify_all();
+}
+
+void uci_engine::stop_search() {
+  stop.store(true, std::memory_order_relaxed);
+  release_bestmove();
+  if (worker.joinable()) {
+    worker.join();
+  }
+  ponder_timer.reset();
+}
+
+void uci_engine::ponder_hit() {
+  {
+    std::lock_guard lock(hold_mutex);
+    if (!pondering) {
+      return;
+    }
+    pondering = false;
+  }
+  released.notify_all();
+  // the opponent played the expected move, so the clock runs from now
+  if (ponder_time.is_limited()) {
+    int ply = static_cast<int>(pos.fullmove_number() - 1) * 2 + pos.side_to_move();
+    ponder_timer.emplace(
+        std::chrono::steady_clock::now() + time_manager(ponder_time, ply).optimum(), stop);
+  }
+}
+
+void uci_engine::set_option(std::istringstream& command) {
+  std::string word;
+  command >> word;
+  if (word != "name") {
+    throw std::invalid_argument("setoption requires the option name");
+  }
+  auto name = read_words(command, "value");
+  auto value = read_words(command, "");
+  stop_search();
+  if (name == "Hash") {
+    tt.resize(std::max<size_t>(std::stoull(value), 1));
+  } else if (name == "MultiPV") {
+    multi_pv = std::max(std::stoi(value), 1);
+  } else if (name == "Move Overhead") {
+    move_overhead = milliseconds(std::stoll(value));
+  } else {
+    throw std::invalid_argument("unknown option: " + name);
+  }
+}
+
+void uci_engine::set_position(std::istringstream& command) {
+  std::string word;
+  command >> word;
+  position next;
+  if (word == "startpos") {
+    next = position::start();
+    command >> word;
+  } else if (word == "fen") {
+    std::string fen;
+    while (command >> word && word != "moves") {
+      fen += (fen.empty() ? "" : " ") + word;
+    }
+    next = position::from_fen(fen);
+  } else {
+    throw std::invalid_argument("position requires startpos or fen");
+  }
+
+  std::vector<uint64_t> keys;
+  if (word == "moves") {
+    while (command >> word) {
+      auto m = parse_uci_move(next, word);
+      if (m.is_none()) {
+        throw std::invalid_argument("illegal move: " + word);
+      }
+      keys.push_back(next.key());
+      next.make_move(m);
+    }
+  }
+  stop_search();
+  pos = next;
+  history = std::move(keys);
+}
+
+void uci_engine::go(std::istringstream& command) {
+  search_limits limits;
+  milliseconds white_time{0};
+  milliseconds black_time{0};
+  milliseconds white_increment{0};
+  milliseconds black_increment{0};
+  bool go_infinite = false;
+  bool go_ponder = false;
+  std::string word;
+  auto value = [&]() {
+    int64_t number = 0;
+    if (!(command >> number)) {
+      throw std::invalid_argument("go option without a value: " + word);
+    }
+    return number;
+  };
+  while (command >> word) {
+    if (word == "wtime") {
+      white_time = milliseconds(value());
+    } else if (word == "btime") {
+      black_time = milliseconds(value());
+    } else if (word == "winc") {
+      white_increment = milliseconds(value());
+    } else if (word == "binc") {
+      black_increment = milliseconds(value());
+    } else if (word == "movestogo") {
+      limits.time.moves_to_go = static_cast<int>(value());
+    } else if (word == "movetime") {
+      limits.time.move_time = milliseconds(value());
+    } else if (word == "depth") {
+      limits.depth = static_cast<int>(value());
+    } else if (word == "nodes") {
+      limits.nodes = static_cast<uint64_t>(value());
+    } else if (word == "infinite") {
+      go_infinite = true;
+    } else if (word == "ponder") {
+      go_ponder = true;
+    }
+    // the other tokens, like "searchmoves" and its moves, are ignored
+  }
+  bool white = pos.side_to_move() == slchess::white;
+  limits.time.remaining = white ? white_time : black_time;
+  limits.time.increment = white ? white_increment : black_increment;
+  limits.time.overhead = move_overhead;
+  limits.multi_pv = multi_pv;
+  limits.stop = &stop;
+
+  stop_search();
+  ponder_time = go_ponder ? limits.time : time_control{};
+  if (go_infinite || go_ponder) {
+    limits.time = time_control{};
+  }
+  {
+    std::lock_guard lock(hold_mutex);
+    infinite = go_infinite;
+    pondering = go_ponder;
+  }
+  stop.store(false, std::memory_order_relaxed);
+  search.set_game_history(history);
+  worker = std::thread([this, limits, root = pos] {
+    auto result = search.search(root, limits);
+    {
+      std::unique_lock lock(hold_mutex);
+      released.wait(lock, [this] { return !infinite && !pondering; });
+    }
+    send("bestmove " + (result.best_move.is_none() ? std::string("0000")
+                                                    : result.best_move.to_uci()));
+  });
+}
+
+void uci_engine::run() {
+  std::string line;
+  while (std::getline(input, line)) {
+    std::istringstream command(line);
+    std::string name;
+    command >> name;
+    try {
+      if (name == "uci") {
+        send("id name " PROJECT_NAME " " PROJECT_VERSION);
+        send("id author slchess developers");
+        send("option name Hash type spin default 16 min 1 max 65536");
+        send("option name MultiPV type spin default 1 min 1 max 256");
+        send("option name Move Overhead type spin default 20 min 0 max 5000");
+        send("uciok");
+      } else if (name == "isready") {
+        send("readyok");
+      } else if (name == "ucinewgame") {
+        stop_search();
+        tt.clear();
+        search.clear_history();
+      } else if (name == "setoption") {
+        set_option(command);
+      } else if (name == "position") {
+        set_position(command);
+      } else if (name == "go") {
+        go(command);
+      } else if (name == "stop") {
+        stop.store(true, std::memory_order_relaxed);
+        release_bestmove();
+      } else if (name == "ponderhit") {
+        ponder_hit();
+      } else if (name == "quit") {
+        break;
+      }
+    } catch (const std::exception& e) {
+      send(std::string("info string error: ") + e.what());
+    }
+  }
+  stop_search();
+}
+
+}  // namespace slchess
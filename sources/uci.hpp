@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "position.hpp"
+#include "search.hpp"
+#include "time_manager.hpp"
+#include "transposition_table.hpp"
+
+namespace slchess {
+
+/**
+ * Formats the score like the UCI "score" value: "cp 25", "mate 3" or "mate -2".
+ */
+[[nodiscard]] std::string uci_score(int score);
+
+/**
+ * The UCI protocol loop, enough for playing the engine matches.
+ *
+ * Supported commands: "uci", "isready", "ucinewgame", "setoption" (Hash, MultiPV, Move Overhead),
+ * "position [startpos | fen FEN] [moves ...]", "go" with "wtime", "btime", "winc", "binc",
+ * "movestogo", "movetime", "depth", "nodes", "infinite" and "ponder", "ponderhit", "stop" and
+ * "quit". The other "go" tokens, like "searchmoves" and its moves, are ignored.
+ *
+ * The search runs in its own thread, so "stop" is handled while it's searching. It only sets
+ * the stop flag, which the search polls, and the search thread sends the "bestmove".
+ *
+ * The "bestmove" of "go infinite" and "go ponder" is held back until "stop" (or "ponderhit"
+ * for pondering), also when the search ends on its own by the depth or the nodes limit. The
+ * ponder search ignores the clock, which is used from "ponderhit": the search is then stopped
+ * after the optimum time of the move.
+ *
+ * The commands changing the engine state ("position", "go", "ucinewgame", "setoption") stop the
+ * running search first.
+ */
+class uci_engine {
+ private:
+  std::istream& input;
+  std::ostream& output;
+  std::mutex output_mutex;
+
+  position pos = position::start();
+  std::vector<uint64_t> history;  ///< Keys of the game positions before the current one.
+
+  transposition_table tt;
+  searcher search;
+  std::atomic<bool> stop{false};
+  std::thread worker;
+
+  std::mutex hold_mutex;
+  std::condition_variable released;
+  bool infinite = false;     ///< The bestmove is held until "stop".
+  bool pondering = false;    ///< The bestmove is held until "ponderhit" or "stop".
+  time_control ponder_time;  ///< Clock of the ponder search, used from "ponderhit".
+  std::optional<stop_timer> ponder_timer;
+
+  milliseconds move_overhead{20};
+  int multi_pv = 1;
+
+  void send(const std::string& line);
+  void release_bestmove();
+  void stop_search();
+  void ponder_hit();
+
+  void set_option(std::istringstream& command);
+  void set_position(std::istringstream& command);
+  void go(std::istringstream& command);
+
+ public:
+  uci_engine(std::istream& in, std::ostream& out);
+  ~uci_engine();
+
+  uci_engine(const uci_engine&) = delete;
+  uci_engine& operator=(const uci_engine&) = delete;
+
+  /**
+   * Handles the commands until "quit" or the end of the input.
+   */
+  void run();
+};
+
+}  // namespace slchess
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "chess.hpp"
+
+namespace slchess {
+
+/**
+ * Zobrist hashing keys.
+ *
+ * The position key is a xor of the keys for every piece on its square, the castling rights,
+ * the en passant file and the side to move. The keys are generated at compile time with
+ * the splitmix64 generator, so they are the same in every build and every process.
+ */
+namespace zobrist {
+
+namespace detail {
+
+constexpr uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+struct keys {
+  std::array<std::array<uint64_t, 64>, 16> pieces{};  ///< Indexed with the piece code.
+  std::array<uint64_t, 16> castling{};
+  std::array<uint64_t, 8> en_passant{};
+  uint64_t side = 0;
+};
+
+constexpr keys make_keys() {
+  keys result;
+  uint64_t state = 0x5c5ce55ULL;
+  for (auto& squares : result.pieces) {
+    for (auto& key : squares) {
+      key = splitmix64(state);
+    }
+  }
+  // no rights must not change the key, so the combinations are xors of the single rights
+  std::array<uint64_t, 4> single{};
+  for (auto& key : single) {
+    key = splitmix64(state);
+  }
+  for (size_t rights = 0; rights < 16; ++rights) {
+    for (size_t bit = 0; bit < 4; ++bit) {
+      if ((rights & (1 << bit)) != 0) {
+        result.castling[rights] ^= single[bit];
+      }
+    }
+  }
+  for (auto& key : result.en_passant) {
+    key = splitmix64(state);
+  }
+  result.side = splitmix64(state);
+  return result;
+}
+
+}  // namespace detail
+
+inline constexpr detail::keys keys = detail::make_keys();
+
+[[nodiscard]] constexpr uint64_t piece_key(piece p, square_index sq) { return keys.pieces[p][sq]; }
+
+[[nodiscard]] constexpr uint64_t castling_key(uint8_t rights) { return keys.castling[rights]; }
+
+[[nodiscard]] constexpr uint64_t en_passant_key(square_index sq) {
+  return sq == no_square ? 0 : keys.en_passant[file_of(sq)];
+}
+
+[[nodiscard]] constexpr uint64_t side_key() { return keys.side; }
+
+}  // namespace zobrist
+
+}  // namespace slchess
@@ -0,0 +1,104 @@
+#include "analysis_cache.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "catch.hpp"
+#include "movegen.hpp"
+#include "search.hpp"
+
+using namespace slchess;
+
+namespace {
+
+std::string temp_path(const char* name) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);
+  return path.string();
+}
+
+}  // namespace
+
+TEST_CASE("check analysis cache", "[analysis_cache]") {
+  auto path = temp_path("slchess_analysis_cache.test.bin");
+  auto e2e4 = parse_uci_move(position::start(), "e2e4");
+  auto d2d4 = parse_uci_move(position::start(), "d2d4");
+
+  SECTION("check store and probe") {
+    analysis_cache cache(path, 1000);
+    CHECK(cache.capacity() == 1000);
+    CHECK_FALSE(cache.probe(123).has_value());
+
+    cache.store(123, e2e4, -35, 12);
+    auto entry = cache.probe(123);
+    REQUIRE(entry.has_value());
+    CHECK(entry->best_move == e2e4);
+    CHECK(entry->score == -35);
+    CHECK(entry->depth == 12);
+
+    // the shallower results don't replace the deeper ones
+    cache.store(123, d2d4, 10, 11);
+    CHECK(cache.probe(123)->best_move == e2e4);
+    cache.store(123, d2d4, score_mate - 5, 12);
+    CHECK(cache.probe(123)->best_move == d2d4);
+    CHECK(cache.probe(123)->score == score_mate - 5);
+
+    cache.store(124, e2e4, 0, 0);
+    CHECK_FALSE(cache.probe(124).has_value());
+  }
+
+  SECTION("check full bucket") {
+    analysis_cache cache(path, 4);
+    for (uint64_t key = 1; key <= 4; ++key) {
+      cache.store(key, e2e4, 0, static_cast<int>(key + 10));
+    }
+    cache.store(5, d2d4, 0, 20);
+    CHECK_FALSE(cache.probe(1).has_value());
+    for (uint64_t key = 2; key <= 5; ++key) {
+      CHECK(cache.probe(key).has_value());
+    }
+  }
+
+  SECTION("check persistence and sharing") {
+    {
+      analysis_cache cache(path, 64);
+      cache.store(42, e2e4, 17, 9);
+    }
+    analysis_cache first(path, 1);
+    analysis_cache second(path, 1);
+    CHECK(first.capacity() == 64);
+    REQUIRE(first.probe(42).has_value());
+    CHECK(first.probe(42)->score == 17);
+
+    second.store(43, d2d4, -17, 3);
+    REQUIRE(first.probe(43).has_value());
+    CHECK(first.probe(43)->best_move == d2d4);
+  }
+
+  SECTION("check invalid file") {
+    std::ofstream(path) << "not a cache file";
+    CHECK_THROWS_AS(analysis_cache(path, 64), std::runtime_error);
+  }
+
+  SECTION("check search") {
+    analysis_cache cache(path, 1024);
+    searcher search;
+    search.set_analysis_cache(&cache);
+    auto pos = position::from_fen("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+
+    auto computed = search.search(pos, {3, 0});
+    CHECK(computed.nodes > 0);
+    auto cached = search.search(pos, {3, 0});
+    CHECK(cached.nodes == 0);
+    CHECK(cached.best_move == computed.best_move);
+    CHECK(cached.score == computed.score);
+    CHECK(cached.depth == 3);
+
+    // the deeper search is computed again
+    CHECK(search.search(pos, {4, 0}).nodes > 0);
+    CHECK(cache.probe(pos.key())->depth == 4);
+  }
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,147 @@
+#include "analysis_pool.hpp"
+
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "movegen.hpp"
+
+using namespace slchess;
+
+TEST_CASE("check multi-pv search", "[search]") {
+  SECTION("check the lines") {
+    search_limits limits;
+    limits.depth = 4;
+    searcher single;
+    auto best = single.search(position::start(), limits);
+
+    limits.multi_pv = 3;
+    searcher multi;
+    auto result = multi.search(position::start(), limits);
+    REQUIRE(result.lines.size() == 3);
+    CHECK(result.lines[0].score == best.score);
+    CHECK(result.lines[0].pv == result.pv);
+    CHECK(result.pv.front() == result.best_move);
+
+    std::set<uint16_t> first_moves;
+    for (size_t n = 0; n < result.lines.size(); ++n) {
+      first_moves.insert(result.lines[n].pv.front().raw());
+      if (n > 0) {
+        CHECK(result.lines[n].score <= result.lines[n - 1].score);
+      }
+    }
+    CHECK(first_moves.size() == 3);
+  }
+
+  SECTION("check more lines than legal moves") {
+    search_limits limits;
+    limits.depth = 3;
+    limits.multi_pv = 10;
+    searcher search;
+    // the king in the corner has three moves
+    auto result = search.search(position::from_fen("7k/8/8/8/8/8/8/K7 b - - 0 1"), limits);
+    CHECK(result.lines.size() == 3);
+
+    auto mated = search.search(position::from_fen("R5k1/5ppp/8/8/8/8/8/6K1 b - - 0 1"), limits);
+    REQUIRE(mated.lines.size() == 1);
+    CHECK(mated.lines[0].pv.empty());
+    CHECK(mated.score == -score_mate);
+  }
+}
+
+TEST_CASE("check analysis pool", "[analysis_pool]") {
+  const std::vector<std::string> fens = {
+      "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1",
+      "4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1",
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+  };
+  analysis_pool pool(2, 1);
+  CHECK(pool.size() == 2);
+
+  SECTION("check the batch results") {
+    search_limits limits;
+    limits.depth = 4;
+    limits.multi_pv = 2;
+    auto results = pool.analyse(fens, limits);
+    REQUIRE(results.size() == fens.size());
+    CHECK(results[0].best_move.to_uci() == "a1a8");
+    CHECK(results[0].score == score_mate - 1);
+    CHECK(results[1].best_move.to_uci() == "d1d5");
+    for (size_t n = 0; n < fens.size(); ++n) {
+      CHECK(results[n].depth == 4);
+      CHECK(results[n].lines.size() == 2);
+      CHECK(!parse_uci_move(position::from_fen(fens[n]), results[n].best_move.to_uci()).is_none());
+    }
+  }
+
+  SECTION("check the callbacks and the futures") {
+    std::atomic<int> calls{0};
+    search_limits limits;
+    limits.depth = 3;
+    std::vector<std::future<search_result>> futures;
+    for (const auto& fen : fens) {
+      futures.push_back(pool.submit(fen, limits, [&calls](const search_result& result) {
+        if (!result.best_move.is_none()) {
+          ++calls;
+        }
+      }));
+    }
+    for (auto& future : futures) {
+      CHECK(future.get().depth == 3);
+    }
+    CHECK(calls == static_cast<int>(fens.size()));
+  }
+
+  SECTION("check an invalid position") {
+    CHECK_THROWS_AS(pool.submit("not a fen", search_limits{}), std::invalid_argument);
+    CHECK(pool.pending() == 0);
+
+    // parseable, but the side not to move is in check
+    const std::string illegal = "4k3/4R3/8/8/8/8/8/4K3 w - - 0 1";
+    search_limits limits;
+    limits.depth = 2;
+    CHECK_THROWS_AS(pool.submit(illegal, limits), std::invalid_argument);
+    auto batch = fens;
+    batch.push_back(illegal);
+    CHECK_THROWS_AS(pool.analyse(batch, limits), std::invalid_argument);
+    CHECK(pool.pending() == 0);
+
+    // a position built by hand fails only its own future
+    position pos;
+    pos.put_piece(white_king, make_square(4, 0));
+    pos.put_piece(black_king, make_square(4, 7));
+    pos.put_piece(white_rook, make_square(4, 6));
+    auto future = pool.submit(pos, limits);
+    CHECK_THROWS_AS(future.get(), std::invalid_argument);
+    CHECK(pool.submit(fens[0], limits).get().best_move.to_uci() == "a1a8");
+  }
+
+  SECTION("check cancelling") {
+    // the searches without limits run until they are stopped
+    std::vector<std::future<search_result>> futures;
+    for (int n = 0; n < 6; ++n) {
+      futures.push_back(pool.submit(position::start(), search_limits{}));
+    }
+    pool.cancel();
+    CHECK(pool.pending() == 0);
+
+    int finished = 0;
+    int cancelled = 0;
+    for (auto& future : futures) {
+      try {
+        auto result = future.get();
+        CHECK_FALSE(result.best_move.is_none());
+        ++finished;
+      } catch (const std::future_error& e) {
+        CHECK(e.code() == std::future_errc::broken_promise);
+        ++cancelled;
+      }
+    }
+    CHECK(finished <= 2);
+    CHECK(finished + cancelled == 6);
+  }
+}
@@ -7,9 +7,8 @@
  * The tests are written with a 64bit compiler in mind. It's possible that on 32bit compiler
  * some of tests will fail. I don't care about this for now.
  *
- * At the moment of creating the code, the implementation uses only bitset to store the bits.
- * However, I can imagine changing the storage implementation. Because of this, it's important
- * to write all the tests for both: a one-word-size bitset and multiple-word-size bitset.
+ * The bits are stored in an array of the 64 bit words. It's important to write all the tests
+ * for both: a one-word bitboard and a multiple-word bitboard.
  *
  * I will also use extensively bitboard<8,8> for chess implementation.
  *
@@ -97,21 +96,23 @@ TEST_CASE("check file and rank", "[file, rank]") {
 
 TEST_CASE("check square", "[square]") {
   SECTION("check square constructor and converting to File and Rank") {
-    const int MAX_RAND = 120;
     const int MAX_ROUNDS = 100;
 
     for (int _ = 0; _ < MAX_ROUNDS; ++_) {
-      size_t f = rand() % MAX_RAND;
-      size_t r = rand() % MAX_RAND;
+      size_t f = rand() % Square::max_files;
+      size_t r = rand() % Square::max_ranks;
 
       File file(f);
       Rank rank(r);
       Square square(file, rank);
 
       // check the size of the Square
-      CHECK_MSG_TRUE(sizeof(square) == 2 * sizeof(size_t),
-                     "The size of Square should be twice the size_t, got sizeof(square)="
-                         << sizeof(square) << " while sizeof(size_t)==" << sizeof(size_t));
+      CHECK_MSG_TRUE(sizeof(square) == 1,
+                     "The size of Square should be one byte, got sizeof(square)="
+                         << sizeof(square));
+      CHECK(square.file() == file);
+      CHECK(square.rank() == rank);
+      CHECK(Square::from_index(square.index()) == square);
 
       auto casted_file = static_cast<File>(square);
       // check automatic conversion of Square to File
@@ -130,12 +131,11 @@ TEST_CASE("check square", "[square]") {
   }
 
   SECTION("check the comma operator") {
-    const int MAX_RAND = 120;
     const int MAX_ROUNDS = 100;
 
     for (int _ = 0; _ < MAX_ROUNDS; ++_) {
-      size_t f = rand() % MAX_RAND;
-      size_t r = rand() % MAX_RAND;
+      size_t f = rand() % Square::max_files;
+      size_t r = rand() % Square::max_ranks;
 
       File file(f);
       Rank rank(r);
@@ -156,6 +156,19 @@ TEST_CASE("check square", "[square]") {
               << casted_rank << " while the Rank==" << rank;);
     }
   }
+
+  SECTION("check the square range") {
+    CHECK_THROWS_WITH(Square(16_f, 0_r), "Square file is too large.");
+    CHECK_THROWS_WITH(Square(0_f, 16_r), "Square rank is too large.");
+    CHECK_NOTHROW(Square(15_f, 15_r));
+  }
+
+  SECTION("check the square in constant expressions") {
+    constexpr Square square = (3_f, 5_r);
+    static_assert(square.file() == 3 && square.rank() == 5);
+    static_assert(square.index() == 5 * Square::max_files + 3);
+    static_assert(Square() == (0_f, 0_r));
+  }
 }
 
 TEST_CASE("check_bitboard_size", "[bitboard]") {
@@ -197,17 +210,20 @@ void check_getting_too_large_field_coordinates() {
   const int MAX_RAND = 120;
   const int MAX_ROUNDS = 100;
 
-  for (int _ = 0; _ < MAX_ROUNDS; ++_) {
-    auto file = File(rand() % MAX_RAND);
-    auto rank = Rank(rand() % MAX_RAND);
-
-    // a couple of constants for simpler code
-    bool file_too_large = file >= bb.files();
-    bool rank_too_large = rank >= bb.ranks();
-    bool expecting_throw = bb.always_check_range() && (file_too_large || rank_too_large);
+  // the bitboards without the range check would read and write outside their words, so they get
+  // only the coordinates on the board
+  const int max_file = always_check_range_ ? MAX_RAND : files_;
+  const int max_rank = always_check_range_ ? MAX_RAND : ranks_;
+  // the squares keep the coordinates up to 16, which is still larger than the boards
+  const int max_square_file = always_check_range_ ? Square::max_files : files_;
+  const int max_square_rank = always_check_range_ ? Square::max_ranks : ranks_;
 
+  for (int _ = 0; _ < MAX_ROUNDS; ++_) {
 #define check_throws(func_call, bb, file, rank)                                             \
   {                                                                                         \
+    bool file_too_large = file >= bb.files();                                               \
+    bool rank_too_large = rank >= bb.ranks();                                               \
+    bool expecting_throw = bb.always_check_range() && (file_too_large || rank_too_large);   \
     if (expecting_throw) {                                                                  \
       if (file_too_large) {                                                                 \
         CHECK_BB_THROWS(                                                                    \
@@ -221,16 +237,22 @@ void check_getting_too_large_field_coordinates() {
     }                                                                                       \
   }
 
-    check_throws(bb.get(file, rank), bb, file, rank);
-    check_throws(bb.get(Square(file, rank)), bb, file, rank);
+    auto file = File(rand() % max_file);
+    auto rank = Rank(rand() % max_rank);
 
+    check_throws(bb.get(file, rank), bb, file, rank);
     check_throws(bb.set(file, rank), bb, file, rank);
-    check_throws(bb.set(Square(file, rank)), bb, file, rank);
-
     check_throws(bb.reset(file, rank), bb, file, rank);
-    check_throws(bb.reset(Square(file, rank)), bb, file, rank);
-
     check_throws(bb[file][rank], bb, file, rank);
+
+    auto square_file = File(rand() % max_square_file);
+    auto square_rank = Rank(rand() % max_square_rank);
+    Square square(square_file, square_rank);
+
+    check_throws(bb.get(square), bb, square_file, square_rank);
+    check_throws(bb.set(square), bb, square_file, square_rank);
+    check_throws(bb.reset(square), bb, square_file, square_rank);
+#undef check_throws
   }
 }
 
@@ -305,27 +327,25 @@ void check_test_function() {
   for (int _ = 0; _ < MAX_ROUNDS; ++_) {
     auto file = File(rand() % MAX_RAND);
     auto rank = Rank(rand() % MAX_RAND);
-    auto square = (file, rank);
-
-    // a couple of constants for simpler code
-    bool file_too_large = file >= bb.files();
-    bool rank_too_large = rank >= bb.ranks();
-
-    if (file_too_large) {
-      CHECK_BB_THROWS(
-          bb.test(file, rank), std::out_of_range&, "Requested file is too large.", bb, file, rank);
-      CHECK_BB_THROWS(
-          bb.test(square), std::out_of_range&, "Requested file is too large.", bb, file, rank);
-
-    } else if (rank_too_large) {
-      CHECK_BB_THROWS(
-          bb.test(file, rank), std::out_of_range&, "Requested rank is too large.", bb, file, rank);
-      CHECK_BB_THROWS(
-          bb.test(square), std::out_of_range&, "Requested rank is too large.", bb, file, rank);
-    } else {
-      CHECK_BB_NOTHROW(bb.test(file, rank), bb, file, rank);
-      CHECK_BB_NOTHROW(bb.test(square), bb, file, rank);
-    }
+    // the squares keep the coordinates up to 16, which is still larger than the boards
+    auto square_file = File(rand() % Square::max_files);
+    auto square_rank = Rank(rand() % Square::max_ranks);
+    auto square = (square_file, square_rank);
+
+#define check_test_throws(func_call, file, rank)                                              \
+  if (file >= bb.files()) {                                                                   \
+    CHECK_BB_THROWS(                                                                          \
+        func_call, std::out_of_range&, "Requested file is too large.", bb, file, rank);       \
+  } else if (rank >= bb.ranks()) {                                                            \
+    CHECK_BB_THROWS(                                                                          \
+        func_call, std::out_of_range&, "Requested rank is too large.", bb, file, rank);       \
+  } else {                                                                                    \
+    CHECK_BB_NOTHROW(func_call, bb, file, rank);                                              \
+  }
+
+    check_test_throws(bb.test(file, rank), file, rank);
+    check_test_throws(bb.test(square), square_file, square_rank);
+#undef check_test_throws
   }
 }
 
@@ -549,6 +569,72 @@ void check_converting_to_ullong() {
   }
 }
 
+template <size_t files_, size_t ranks_, bool always_check_range_>
+void check_words() {
+  bitboard<files_, ranks_, always_check_range_> bb;
+
+  CHECK(bb.words() == (files_ * ranks_ + 63) / 64);
+
+  // set the last field, it's in the last word
+  bb.set(File(files_ - 1), Rank(ranks_ - 1));
+  auto last_bit = (files_ * ranks_ - 1) % 64;
+  CHECK(bb.word(bb.words() - 1) == 1ULL << last_bit);
+
+  // the bits outside the board are dropped
+  for (size_t w = 0; w < bb.words(); ++w) {
+    bb.set_word(w, ~0ULL);
+  }
+  CHECK(bb.all());
+  CHECK(bb.count() == bb.size());
+
+  bb.set_word(0, 0);
+  CHECK(bb.word(0) == 0);
+  CHECK(bb.count() == bb.size() - std::min<size_t>(64, bb.size()));
+}
+
+template <size_t files_, size_t ranks_, bool always_check_range_>
+void check_bitwise_operators() {
+  using bb_type = bitboard<files_, ranks_, always_check_range_>;
+
+  bb_type a;
+  bb_type b;
+  a.set(File(0), Rank(0));
+  a.set(File(1), Rank(1));
+  b.set(File(1), Rank(1));
+  b.set(File(0), Rank(2));
+
+  auto and_bb = a & b;
+  CHECK(and_bb.count() == 1);
+  CHECK(and_bb.get(File(1), Rank(1)));
+
+  auto or_bb = a | b;
+  CHECK(or_bb.count() == 3);
+
+  auto xor_bb = a ^ b;
+  CHECK(xor_bb.count() == 2);
+  CHECK_FALSE(xor_bb.get(File(1), Rank(1)));
+
+  auto not_bb = ~a;
+  CHECK(not_bb.count() == a.size() - 2);
+  CHECK((not_bb & a).none());
+  CHECK((not_bb | a).all());
+
+  CHECK(a == a);
+  CHECK(a != b);
+  CHECK(bb_type(a) == a);
+
+  // shifting by the number of files moves everything one rank up
+  auto up = a << files_;
+  CHECK(up.count() == 2);
+  CHECK(up.get(File(0), Rank(1)));
+  CHECK(up.get(File(1), Rank(2)));
+  CHECK((up >> files_) == a);
+
+  // bits shifted outside are lost
+  CHECK((a << a.size()).none());
+  CHECK((a >> 1).count() == 1);
+}
+
 TEST_CASE("test_bitboard", "[bitboard]") {
   static constexpr params bb2x3 = {2, 3, true};
   static constexpr params bb2x3_nocheck = {2, 3, false};
@@ -613,6 +699,26 @@ TEST_CASE("test_bitboard", "[bitboard]") {
     CHECK(bb.to_string() == "-----x");
   }
 
+  SECTION("check to_board_string") {
+    bitboard<3, 2> bb;
+    CHECK(bb.to_board_string() == "---\n---\n");
+    CHECK(bb.board_string_size() == 8);
+
+    // the highest rank is the first line, the lowest file the first column
+    bb.set(File(0), Rank(0));
+    bb.set(File(2), Rank(1));
+    CHECK(bb.to_board_string() == "--x\nx--\n");
+    CHECK(bb.to_board_string('.', '1') == "..1\n1..\n");
+
+    bitboard<10, 10> large;
+    large.set(File(9), Rank(9));
+    large.set(File(0), Rank(0));
+    auto text = large.to_board_string();
+    CHECK(text.size() == 110);
+    CHECK(text.substr(0, 11) == "---------x\n");
+    CHECK(text.substr(99, 11) == "x---------\n");
+  }
+
   SECTION("check ulong constructor") {
     {
       bitboard<4, 5> bb(0);
@@ -651,4 +757,33 @@ TEST_CASE("test_bitboard", "[bitboard]") {
     run_tests(check_converting_to_ulong);
     run_tests(check_converting_to_ullong);
   }
+
+  SECTION("check words") { run_tests(check_words); }
+
+  SECTION("check constant expressions") {
+    // a multiple-word bitboard built at compile time
+    constexpr auto diagonal = [] {
+      bitboard<10, 10> bb;
+      for (size_t n = 0; n < 10; ++n) {
+        bb.set(Square(File(n), Rank(n)));
+      }
+      return bb;
+    }();
+    static_assert(diagonal.size() == 100 && diagonal.count() == 10);
+    static_assert(diagonal.get(3_f, 3_r) && !diagonal.get(3_f, 4_r));
+    static_assert(diagonal.test((9_f, 9_r)));
+    static_assert((diagonal << 10).get(0_f, 1_r) && (diagonal << 10).count() == 9);
+    static_assert((diagonal >> 11).get(0_f, 0_r) && (diagonal >> 11).count() == 9);
+    static_assert((~diagonal).count() == 90 && (diagonal | ~diagonal).all());
+    static_assert((diagonal & ~diagonal).none());
+    static_assert(bitboard<8, 8>(0xff).word(0) == 0xff);
+    static_assert(bitboard<2, 3>(~0ULL).to_ullong() == 0b111111);
+    static_assert(bitboard<2, 3>(1).to_string() == "-----x");
+
+    // the fields 66, 77, 88 and 99 are in the second word
+    CHECK(diagonal.word(1) == (1ULL << 2 | 1ULL << 13 | 1ULL << 24 | 1ULL << 35));
+    CHECK_THROWS_AS(diagonal.to_ullong(), std::overflow_error);
+  }
+
+  SECTION("check bitwise operators") { run_tests(check_bitwise_operators); }
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "bitboard_batch.hpp"
+
+#include <random>
+#include <vector>
+
+#include "catch.hpp"
+
+/**
+ * All the batch operations are compared with the same operations done on the single bitboards.
+ *
+ * The same shapes as in the bitboard tests are used: one word (2x3, 8x8) and two words (10x10),
+ * and the batch sizes are chosen to have both full lane blocks and the tail.
+ */
+
+using namespace slchess;
+
+template <size_t files_, size_t ranks_>
+std::vector<bitboard<files_, ranks_>> random_bitboards(size_t count, std::mt19937_64& rng) {
+  std::vector<bitboard<files_, ranks_>> result(count);
+  for (auto& bb : result) {
+    for (size_t w = 0; w < bb.words(); ++w) {
+      bb.set_word(w, rng());
+    }
+  }
+  return result;
+}
+
+template <size_t files_, size_t ranks_>
+bitboard_batch<files_, ranks_> make_batch(const std::vector<bitboard<files_, ranks_>>& boards) {
+  bitboard_batch<files_, ranks_> batch(boards.size());
+  for (size_t i = 0; i < boards.size(); ++i) {
+    batch.store(i, boards[i]);
+  }
+  return batch;
+}
+
+template <size_t files_, size_t ranks_>
+void check_batch_equals(const bitboard_batch<files_, ranks_>& batch,
+                        const std::vector<bitboard<files_, ranks_>>& expected) {
+  REQUIRE(batch.size() == expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    INFO("bitboard<" << files_ << "x" << ranks_ << "> failed for batch element " << i);
+    CHECK(batch.load(i) == expected[i]);
+  }
+}
+
+template <size_t files_, size_t ranks_>
+void check_store_and_load(size_t count) {
+  std::mt19937_64 rng(count);
+  auto boards = random_bitboards<files_, ranks_>(count, rng);
+  auto batch = make_batch(boards);
+  check_batch_equals(batch, boards);
+
+  CHECK_THROWS_AS(batch.load(count), std::out_of_range);
+  CHECK_THROWS_AS(batch.store(count, boards[0]), std::out_of_range);
+}
+
+template <size_t files_, size_t ranks_>
+void check_binary_operations(size_t count) {
+  std::mt19937_64 rng(count);
+  auto lhs = random_bitboards<files_, ranks_>(count, rng);
+  auto rhs = random_bitboards<files_, ranks_>(count, rng);
+  auto rhs_batch = make_batch(rhs);
+
+  auto and_batch = make_batch(lhs);
+  auto or_batch = make_batch(lhs);
+  auto xor_batch = make_batch(lhs);
+  auto andnot_batch = make_batch(lhs);
+  and_batch &= rhs_batch;
+  or_batch |= rhs_batch;
+  xor_batch ^= rhs_batch;
+  andnot_batch.and_not(rhs_batch);
+
+  std::vector<bitboard<files_, ranks_>> and_expected, or_expected, xor_expected, andnot_expected;
+  for (size_t i = 0; i < count; ++i) {
+    and_expected.push_back(lhs[i] & rhs[i]);
+    or_expected.push_back(lhs[i] | rhs[i]);
+    xor_expected.push_back(lhs[i] ^ rhs[i]);
+    andnot_expected.push_back(lhs[i] & ~rhs[i]);
+  }
+
+  check_batch_equals(and_batch, and_expected);
+  check_batch_equals(or_batch, or_expected);
+  check_batch_equals(xor_batch, xor_expected);
+  check_batch_equals(andnot_batch, andnot_expected);
+
+  bitboard_batch<files_, ranks_> other(count + 1);
+  CHECK_THROWS_AS(and_batch &= other, std::invalid_argument);
+}
+
+template <size_t files_, size_t ranks_>
+void check_broadcast_operations(size_t count) {
+  std::mt19937_64 rng(count);
+  auto boards = random_bitboards<files_, ranks_>(count, rng);
+  auto mask = random_bitboards<files_, ranks_>(1, rng)[0];
+
+  auto and_batch = make_batch(boards);
+  auto or_batch = make_batch(boards);
+  auto xor_batch = make_batch(boards);
+  auto andnot_batch = make_batch(boards);
+  and_batch &= mask;
+  or_batch |= mask;
+  xor_batch ^= mask;
+  andnot_batch.and_not(mask);
+
+  std::vector<bitboard<files_, ranks_>> and_expected, or_expected, xor_expected, andnot_expected;
+  for (const auto& bb : boards) {
+    and_expected.push_back(bb & mask);
+    or_expected.push_back(bb | mask);
+    xor_expected.push_back(bb ^ mask);
+    andnot_expected.push_back(bb & ~mask);
+  }
+
+  check_batch_equals(and_batch, and_expected);
+  check_batch_equals(or_batch, or_expected);
+  check_batch_equals(xor_batch, xor_expected);
+  check_batch_equals(andnot_batch, andnot_expected);
+
+  // the padding must stay empty, otherwise it would be counted
+  uint64_t total = 0;
+  for (const auto& bb : or_expected) {
+    total += bb.count();
+  }
+  CHECK(or_batch.popcount() == total);
+}
+
+template <size_t files_, size_t ranks_>
+void check_shifts(size_t count) {
+  std::mt19937_64 rng(count);
+  auto boards = random_bitboards<files_, ranks_>(count, rng);
+
+  for (size_t shift : {0UL, 1UL, files_, 63UL, 64UL, 65UL, files_ * ranks_ - 1, files_ * ranks_}) {
+    INFO("shift by " << shift);
+    auto left = make_batch(boards);
+    auto right = make_batch(boards);
+    left <<= shift;
+    right >>= shift;
+
+    std::vector<bitboard<files_, ranks_>> left_expected, right_expected;
+    for (const auto& bb : boards) {
+      left_expected.push_back(bb << shift);
+      right_expected.push_back(bb >> shift);
+    }
+    check_batch_equals(left, left_expected);
+    check_batch_equals(right, right_expected);
+  }
+}
+
+template <size_t files_, size_t ranks_>
+void check_popcount(size_t count) {
+  std::mt19937_64 rng(count);
+  auto boards = random_bitboards<files_, ranks_>(count, rng);
+  auto batch = make_batch(boards);
+
+  std::vector<uint32_t> counts(count);
+  batch.popcount(counts);
+
+  uint64_t total = 0;
+  for (size_t i = 0; i < count; ++i) {
+    CHECK(counts[i] == boards[i].count());
+    total += boards[i].count();
+  }
+  CHECK(batch.popcount() == total);
+
+  std::vector<uint32_t> too_small(count / 2);
+  if (too_small.size() < count) {
+    CHECK_THROWS_AS(batch.popcount(too_small), std::invalid_argument);
+  }
+}
+
+TEST_CASE("test_bitboard_batch", "[bitboard_batch]") {
+#define run_batch_tests(func) \
+  for (size_t count : {1UL, 4UL, 8UL, 13UL, 100UL}) { \
+    func<2, 3>(count);                                 \
+    func<8, 8>(count);                                 \
+    func<10, 10>(count);                               \
+  }
+
+  SECTION("check store and load") { run_batch_tests(check_store_and_load); }
+  SECTION("check binary operations") { run_batch_tests(check_binary_operations); }
+  SECTION("check broadcast operations") { run_batch_tests(check_broadcast_operations); }
+  SECTION("check shifts") { run_batch_tests(check_shifts); }
+  SECTION("check popcount") { run_batch_tests(check_popcount); }
+
+  SECTION("check empty batch") {
+    bitboard_batch<8, 8> batch;
+    CHECK(batch.size() == 0);
+    CHECK(batch.popcount() == 0);
+    batch <<= 3;
+    CHECK(batch.popcount() == 0);
+  }
+}
@@ -0,0 +1,105 @@
+#include "bitboard_io.hpp"
+
+#include <array>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "catch.hpp"
+
+using namespace slchess;
+
+namespace {
+
+template <size_t files_, size_t ranks_>
+std::vector<bitboard<files_, ranks_>> random_bitboards(size_t count, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<bitboard<files_, ranks_>> result(count);
+  for (auto& bb : result) {
+    for (size_t w = 0; w < bb.words(); ++w) {
+      bb.set_word(w, rng());
+    }
+  }
+  return result;
+}
+
+template <size_t files_, size_t ranks_>
+void check_round_trips(size_t count) {
+  using board = bitboard<files_, ranks_>;
+  INFO("bitboard<" << files_ << "x" << ranks_ << "> with " << count << " bitboards");
+  auto boards = random_bitboards<files_, ranks_>(count, count + files_);
+
+  auto hex = to_hex(boards);
+  CHECK(hex.size() == count * (hex_digits<board>() + 1));
+  CHECK(from_hex<board>(hex) == boards);
+  std::ostringstream hex_stream;
+  write_hex(boards, hex_stream);
+  CHECK(hex_stream.str() == hex);
+
+  auto binary = to_binary(boards);
+  CHECK(binary.size() == count * binary_size<board>());
+  CHECK(from_binary<board>(binary) == boards);
+  std::ostringstream binary_stream;
+  write_binary(boards, binary_stream);
+  CHECK(binary_stream.str() == std::string(binary.begin(), binary.end()));
+}
+
+}  // namespace
+
+TEST_CASE("check bitboard hex format", "[bitboard_io]") {
+  SECTION("check the digits") {
+    CHECK(hex_digits<bitboard<2, 3>>() == 2);
+    CHECK(hex_digits<bitboard<8, 8>>() == 16);
+    CHECK(hex_digits<bitboard<10, 10>>() == 25);
+
+    // the highest fields are the first digits, like in to_string
+    bitboard<8, 8> bb(0xf0);
+    CHECK(to_hex(std::array{bb}) == "00000000000000f0\n");
+    bitboard<10, 10> large;
+    large.set(File(9), Rank(9));
+    large.set(File(0), Rank(0));
+    CHECK(to_hex(std::vector{large}) == "8000000000000000000000001\n");
+    CHECK(parse_hex<bitboard<10, 10>>("8000000000000000000000001") == large);
+    CHECK(parse_hex<bitboard<8, 8>>("00000000000000F0") == bb);
+  }
+
+  SECTION("check the parsing errors") {
+    using board = bitboard<10, 10>;
+    using small_board = bitboard<2, 3>;
+    CHECK(from_hex<board>(" \n").empty());
+    CHECK(from_hex<board>("0000000000000000000000001 \r\n8000000000000000000000000").size() == 2);
+    CHECK_THROWS_AS(parse_hex<board>("000000000000000000000001"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_hex<board>("000000000000000000000000g"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_hex<board>("00000000000000000000000-1"), std::invalid_argument);
+    // the 2x3 bitboard has 6 bits in 2 digits
+    CHECK(parse_hex<small_board>("3f").all());
+    CHECK_THROWS_AS(parse_hex<small_board>("40"), std::invalid_argument);
+    CHECK_THROWS_AS(from_hex<board>("0000000000000000000000001 00"), std::invalid_argument);
+  }
+
+  SECTION("check the round trips") {
+    for (size_t count : {0, 1, 1000, 10000}) {
+      check_round_trips<2, 3>(count);
+      check_round_trips<8, 8>(count);
+      check_round_trips<10, 10>(count);
+      check_round_trips<16, 16>(count);
+    }
+  }
+}
+
+TEST_CASE("check bitboard binary format", "[bitboard_io]") {
+  using board = bitboard<10, 10>;
+  board bb;
+  bb.set_word(0, 0x0102030405060708);
+  bb.set_word(1, 0x0a0b);
+
+  // the words are little endian on every platform
+  auto binary = to_binary(std::array{bb});
+  REQUIRE(binary.size() == 16);
+  CHECK(binary == std::vector<char>{8, 7, 6, 5, 4, 3, 2, 1, 0x0b, 0x0a, 0, 0, 0, 0, 0, 0});
+
+  CHECK_THROWS_AS(from_binary<board>(std::vector<char>(15)), std::invalid_argument);
+  binary[15] = 1;
+  CHECK_THROWS_AS(from_binary<board>(binary), std::invalid_argument);
+  CHECK(from_binary<board>(std::vector<char>()).empty());
+}
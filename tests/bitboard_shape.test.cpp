@@ -0,0 +1,158 @@
+#include "bitboard_shape.hpp"
+
+#include <random>
+
+#include "catch.hpp"
+
+/**
+ * The word level conversions are compared with copying the fields one by one.
+ */
+
+using namespace slchess;
+
+namespace {
+
+template <size_t files_, size_t ranks_>
+bitboard<files_, ranks_> random_bitboard(std::mt19937_64& rng) {
+  bitboard<files_, ranks_> bb;
+  for (size_t w = 0; w < bb.words(); ++w) {
+    bb.set_word(w, rng());
+  }
+  return bb;
+}
+
+/// Returns the field of the bitboard, or false for the coordinates outside it.
+template <size_t files_, size_t ranks_>
+bool field(const bitboard<files_, ranks_>& bb, long file, long rank) {
+  return file >= 0 && rank >= 0 && static_cast<size_t>(file) < files_
+         && static_cast<size_t>(rank) < ranks_ && bb.get(File(file), Rank(rank));
+}
+
+/// Checks that `to` has the fields of `from` moved by the offset, and nothing else.
+template <size_t from_files_, size_t from_ranks_, size_t to_files_, size_t to_ranks_>
+void check_moved(const bitboard<from_files_, from_ranks_>& from,
+                 const bitboard<to_files_, to_ranks_>& to,
+                 long file_offset,
+                 long rank_offset) {
+  for (size_t rank = 0; rank < to_ranks_; ++rank) {
+    for (size_t file = 0; file < to_files_; ++file) {
+      INFO(from_files_ << "x" << from_ranks_ << " to " << to_files_ << "x" << to_ranks_
+                       << " field " << file << ", " << rank);
+      bool expected = field(from, static_cast<long>(file) - file_offset,
+                            static_cast<long>(rank) - rank_offset);
+      REQUIRE(to.get(File(file), Rank(rank)) == expected);
+    }
+  }
+}
+
+template <size_t from_files_, size_t from_ranks_, size_t to_files_, size_t to_ranks_>
+void check_conversions() {
+  std::mt19937_64 rng(from_files_ * 1000 + to_files_);
+  for (int n = 0; n < 20; ++n) {
+    auto bb = random_bitboard<from_files_, from_ranks_>(rng);
+    check_moved(bb, resize<to_files_, to_ranks_>(bb), 0, 0);
+
+    if constexpr (from_files_ <= to_files_ && from_ranks_ <= to_ranks_) {
+      auto file = rng() % (to_files_ - from_files_ + 1);
+      auto rank = rng() % (to_ranks_ - from_ranks_ + 1);
+      auto embedded = embed<to_files_, to_ranks_>(bb, File(file), Rank(rank));
+      check_moved(bb, embedded, static_cast<long>(file), static_cast<long>(rank));
+      CHECK(extract<from_files_, from_ranks_>(embedded, File(file), Rank(rank)) == bb);
+      auto embed_at = [&bb](size_t file_, size_t rank_) {
+        return embed<to_files_, to_ranks_>(bb, File(file_), Rank(rank_));
+      };
+      CHECK_THROWS_AS(embed_at(to_files_ - from_files_ + 1, 0), std::out_of_range);
+      CHECK_THROWS_AS(embed_at(0, to_ranks_ - from_ranks_ + 1), std::out_of_range);
+    } else if constexpr (from_files_ >= to_files_ && from_ranks_ >= to_ranks_) {
+      auto file = rng() % (from_files_ - to_files_ + 1);
+      auto rank = rng() % (from_ranks_ - to_ranks_ + 1);
+      auto region = extract<to_files_, to_ranks_>(bb, File(file), Rank(rank));
+      check_moved(bb, region, -static_cast<long>(file), -static_cast<long>(rank));
+      auto extract_at = [&bb](size_t file_, size_t rank_) {
+        return extract<to_files_, to_ranks_>(bb, File(file_), Rank(rank_));
+      };
+      CHECK_THROWS_AS(extract_at(from_files_ - to_files_ + 1, 0), std::out_of_range);
+      CHECK_THROWS_AS(extract_at(0, from_ranks_ - to_ranks_ + 1), std::out_of_range);
+    }
+  }
+}
+
+template <size_t files_, size_t ranks_, size_t padding_>
+void check_sentinel_shifts() {
+  std::mt19937_64 rng(files_ * 100 + padding_);
+  for (int n = 0; n < 10; ++n) {
+    auto bb = random_bitboard<files_, ranks_>(rng);
+    sentinel_bitboard<files_, ranks_, padding_> padded(bb);
+    CHECK(padded.to_bitboard() == bb);
+    CHECK((padded.board() & ~sentinel_bitboard<files_, ranks_, padding_>::board_mask).none());
+
+    auto max_delta = static_cast<int>(padding_);
+    for (int file_delta = -max_delta; file_delta <= max_delta; ++file_delta) {
+      for (int rank_delta = -2; rank_delta <= 2; ++rank_delta) {
+        auto shifted = padded.shift(file_delta, rank_delta);
+        check_moved(bb, shifted.to_bitboard(), file_delta, rank_delta);
+        CHECK(shifted.count() == shifted.to_bitboard().count());
+      }
+    }
+    CHECK_THROWS_AS(padded.shift(max_delta + 1, 0), std::invalid_argument);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("check bitboard shape conversions", "[bitboard_shape]") {
+  SECTION("check the chess board in a padded board") {
+    bitboard<8, 8> bb;
+    bb.set(File(0), Rank(0));
+    bb.set(File(7), Rank(7));
+    auto padded = embed<10, 10>(bb, File(1), Rank(1));
+    CHECK(padded.count() == 2);
+    CHECK(padded.get(File(1), Rank(1)));
+    CHECK(padded.get(File(8), Rank(8)));
+    CHECK(extract<8, 8>(padded, File(1), Rank(1)) == bb);
+    CHECK(resize<10, 10>(bb).get(File(7), Rank(7)));
+    CHECK(resize<4, 4>(bb).count() == 1);
+  }
+
+  SECTION("check the shapes") {
+    check_conversions<8, 8, 10, 10>();
+    check_conversions<10, 10, 8, 8>();
+    check_conversions<2, 3, 11, 13>();
+    check_conversions<11, 13, 3, 2>();
+    check_conversions<8, 8, 8, 8>();
+    check_conversions<8, 12, 12, 8>();
+    // the ranks longer than a word
+    check_conversions<70, 3, 130, 5>();
+    check_conversions<130, 5, 65, 2>();
+  }
+
+  SECTION("check constant expressions") {
+    constexpr auto corner = [] {
+      bitboard<8, 8> bb;
+      bb.set(File(7), Rank(7));
+      return embed<10, 10>(bb, File(1), Rank(1));
+    }();
+    static_assert(corner.get(File(8), Rank(8)) && corner.count() == 1);
+    static_assert(extract<2, 2>(corner, File(7), Rank(7)).get(File(1), Rank(1)));
+  }
+}
+
+TEST_CASE("check sentinel bitboard", "[bitboard_shape]") {
+  SECTION("check the mask") {
+    using board = sentinel_bitboard<8, 8>;
+    static_assert(board::storage::words() == 2);
+    static_assert(board::board_mask.count() == 64);
+    static_assert(!board::board_mask.get(File(8), Rank(0)));
+    static_assert(board().set(File(7), Rank(0)).shift(1, 0).count() == 0);
+    static_assert(board().set(File(0), Rank(1)).shift(-1, 0).count() == 0);
+    CHECK_THROWS_AS(board().set(File(8), Rank(0)), std::out_of_range);
+  }
+
+  SECTION("check the shifts") {
+    check_sentinel_shifts<8, 8, 1>();
+    check_sentinel_shifts<8, 8, 2>();
+    check_sentinel_shifts<10, 10, 1>();
+    check_sentinel_shifts<3, 5, 3>();
+    check_sentinel_shifts<70, 3, 2>();
+  }
+}
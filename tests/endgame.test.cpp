@@ -0,0 +1,104 @@
+#include "endgame.hpp"
+
+#include <stdexcept>
+
+#include "bitbase.hpp"
+#include "catch.hpp"
+#include "evaluate.hpp"
+#include "search.hpp"
+
+using namespace slchess;
+
+TEST_CASE("check kpk bitbase", "[endgame]") {
+  const auto& bitbase = kpk();
+  CHECK(bitbase.win_count() > 0);
+
+  auto sq = [](const char* name) { return make_square(name[0] - 'a', name[1] - '1'); };
+
+  SECTION("check the known positions") {
+    // the king on the 6th rank in front of the pawn wins with any side to move
+    CHECK(bitbase.is_win(white, sq("e6"), sq("e5"), sq("e8")));
+    CHECK(bitbase.is_win(black, sq("e6"), sq("e5"), sq("e8")));
+    // the king two squares in front of the pawn wins, the pawn move keeps the opposition
+    CHECK(bitbase.is_win(white, sq("e5"), sq("e3"), sq("e7")));
+    // the pawn outruns the king
+    CHECK(bitbase.is_win(black, sq("a1"), sq("e6"), sq("h1")));
+    // the black king takes the undefended pawn
+    CHECK_FALSE(bitbase.is_win(black, sq("a1"), sq("e4"), sq("d5")));
+    // the rook pawn with the black king in the corner
+    CHECK_FALSE(bitbase.is_win(white, sq("a1"), sq("h2"), sq("h8")));
+    CHECK_FALSE(bitbase.is_win(white, sq("h6"), sq("h5"), sq("h8")));
+    // the stalemate
+    CHECK_FALSE(bitbase.is_win(black, sq("f6"), sq("f7"), sq("f8")));
+    // the black king in front of the pawn with the opposition
+    CHECK_FALSE(bitbase.is_win(white, sq("e3"), sq("e4"), sq("e5")));
+  }
+
+  SECTION("check the mirrored files") {
+    CHECK(bitbase.is_win(white, sq("d6"), sq("d5"), sq("d8")));
+    CHECK(bitbase.is_win(white, sq("d6"), sq("d5"), sq("d8")) ==
+          bitbase.is_win(white, sq("e6"), sq("e5"), sq("e8")));
+    CHECK_FALSE(bitbase.is_win(white, sq("h1"), sq("a2"), sq("a8")));
+  }
+}
+
+TEST_CASE("check endgame evaluation", "[endgame]") {
+  SECTION("check material signatures") {
+    CHECK(material_signature(position::from_fen("8/8/8/8/8/8/8/KBNk4 w - - 0 1")) ==
+          material_signature("KBNK"));
+    CHECK(material_signature(position::from_fen("8/8/8/8/8/8/8/Kbnk4 w - - 0 1")) ==
+          material_signature("KKBN"));
+    const char* start_code = "KQRRBBNNPPPPPPPPKQRRBBNNPPPPPPPP";
+    CHECK(material_signature(position::start()) == material_signature(start_code));
+    CHECK(material_signature("KK") == 0);
+    CHECK_THROWS_AS(material_signature("KR"), std::invalid_argument);
+    CHECK_THROWS_AS(material_signature("KRXK"), std::invalid_argument);
+    CHECK_THROWS_AS(material_signature("RKK"), std::invalid_argument);
+  }
+
+  SECTION("check kpk") {
+    auto won = position::from_fen("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1");
+    REQUIRE(evaluate_endgame(won).has_value());
+    CHECK(evaluate(won) < -score_known_win);
+    auto won_by_black = position::from_fen("8/8/8/8/4p3/4k3/8/4K3 w - - 0 1");
+    CHECK(evaluate(won_by_black) == evaluate(won));
+
+    auto drawn = position::from_fen("7k/8/8/8/8/8/7P/K7 w - - 0 1");
+    CHECK(evaluate(drawn) == 0);
+  }
+
+  SECTION("check the mating material") {
+    auto rook = position::from_fen("8/8/8/3k4/8/8/8/R3K3 w - - 0 1");
+    auto cornered = position::from_fen("k7/8/2K5/8/8/8/8/1R6 w - - 0 1");
+    CHECK(evaluate(rook) > score_known_win);
+    CHECK(evaluate(cornered) > evaluate(rook));
+    CHECK(evaluate(position::from_fen("r3k3/8/8/8/3K4/8/8/8 b - - 0 1")) == evaluate(rook));
+
+    // the bishop and knight mate only in the corner of the bishop color
+    auto dark_corner = position::from_fen("8/8/8/8/8/8/2K5/k1BN4 w - - 0 1");
+    auto light_corner = position::from_fen("k7/8/2K5/8/8/8/8/2BN4 w - - 0 1");
+    CHECK(evaluate(dark_corner) > evaluate(light_corner));
+    CHECK(evaluate(light_corner) > score_known_win);
+  }
+
+  SECTION("check the draws") {
+    CHECK(evaluate(position::from_fen("8/8/8/3k4/8/8/8/NN2K3 w - - 0 1")) == 0);
+    CHECK(evaluate(position::from_fen("8/8/8/3k4/8/8/8/B1B1K3 w - - 0 1")) == 0);
+    CHECK(evaluate(position::from_fen("8/8/8/3k4/8/8/8/BB2K3 w - - 0 1")) > score_known_win);
+    CHECK(evaluate(position::from_fen("8/8/8/3k4/8/8/8/4K2n b - - 0 1")) == 0);
+  }
+
+  SECTION("check the other endgames") {
+    CHECK_FALSE(evaluate_endgame(position::from_fen("8/8/8/3k4/8/3p4/8/R3K3 w - - 0 1")));
+    CHECK_FALSE(evaluate_endgame(position::start()));
+  }
+
+  SECTION("check the search") {
+    searcher search;
+    auto result = search.search(position::from_fen("8/8/8/4k3/8/8/8/R3K3 w - - 0 1"), {6, 0});
+    CHECK(result.score > score_known_win);
+
+    auto drawn = search.search(position::from_fen("7k/8/8/8/8/8/7P/K7 w - - 0 1"), {10, 0});
+    CHECK(drawn.score == 0);
+  }
+}
@@ -0,0 +1,141 @@
+#include "move_picker.hpp"
+
+#include <set>
+#include <string_view>
+#include <vector>
+
+#include "catch.hpp"
+#include "movegen.hpp"
+
+using namespace slchess;
+
+namespace {
+
+constexpr std::string_view picker_fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/Pp2P3/2N2Q1p/1PPBBPPP/R3K2R b KQkq a3 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+};
+
+std::vector<move> picked(move_picker& picker) {
+  std::vector<move> result;
+  for (auto m = picker.next(); !m.is_none(); m = picker.next()) {
+    result.push_back(m);
+  }
+  return result;
+}
+
+template <typename Moves>
+std::set<uint16_t> raw_moves(const Moves& moves) {
+  std::set<uint16_t> result;
+  for (auto m : moves) {
+    result.insert(m.raw());
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("check pseudo legal moves", "[movegen]") {
+  for (auto fen : picker_fens) {
+    auto pos = position::from_fen(fen);
+    move_list moves;
+    generate<gen_type::all>(pos, moves);
+    auto generated = raw_moves(moves);
+    for (uint32_t raw = 0; raw < 65536; ++raw) {
+      auto m = move::from_raw(static_cast<uint16_t>(raw));
+      if (is_pseudo_legal(pos, m) != generated.contains(m.raw())) {
+        FAIL(std::string(fen) + " " + m.to_uci() + " flags " + std::to_string(m.flags()));
+      }
+    }
+  }
+}
+
+TEST_CASE("check move picker", "[move_picker]") {
+  history_tables tables;
+
+  SECTION("check every move is picked once") {
+    for (auto fen : picker_fens) {
+      auto pos = position::from_fen(fen);
+      move_list moves;
+      generate<gen_type::all>(pos, moves);
+
+      // a hash move from another position is ignored
+      std::vector<move> hashes = {move(), moves[0], moves[moves.size() - 1], move(0, 63)};
+      tables.killers[1] = {moves[1], moves[2]};
+      for (auto hash : hashes) {
+        move_picker picker(pos, hash, tables, 1, move(12, 28, move::double_push));
+        auto result = picked(picker);
+        CHECK(result.size() == moves.size());
+        CHECK(raw_moves(result) == raw_moves(moves));
+        if (is_pseudo_legal(pos, hash)) {
+          CHECK(result.front() == hash);
+        }
+      }
+    }
+  }
+
+  SECTION("check the stages order") {
+    // the knight is taken by the cheaper piece first
+    auto pos = position::from_fen("4k3/8/2p5/1p1n4/4P3/1Q6/8/4K3 w - - 0 1");
+    auto hash = parse_uci_move(pos, "b3a4");
+    auto quiet = parse_uci_move(pos, "e1e2");
+    tables.killers[0] = {quiet, move()};
+    move_picker picker(pos, hash, tables, 0, move());
+    auto result = picked(picker);
+    REQUIRE(result.size() >= 5);
+    CHECK(result[0] == hash);
+    CHECK(result[1].to_uci() == "e4d5");
+    CHECK(result[2].to_uci() == "b3d5");
+    CHECK(result[3].to_uci() == "b3b5");
+    CHECK(result[4] == quiet);
+    CHECK(picker.current_stage() == move_picker::stage::done);
+  }
+
+  SECTION("check the quiescence picker") {
+    auto pos = position::from_fen(picker_fens[1]);
+    move_list captures;
+    generate<gen_type::captures>(pos, captures);
+    move_picker picker(pos, tables);
+    CHECK(picked(picker).size() == captures.size());
+
+    auto in_check = position::from_fen("4k3/8/8/8/8/8/4r3/4K3 w - - 0 1");
+    move_list evasions;
+    generate<gen_type::all>(in_check, evasions);
+    move_picker evasion_picker(in_check, tables);
+    CHECK(picked(evasion_picker).size() == evasions.size());
+  }
+
+  SECTION("check the history update") {
+    auto pos = position::start();
+    auto best = parse_uci_move(pos, "g1f3");
+    auto tried = parse_uci_move(pos, "a2a3");
+    auto previous = move();
+    std::vector<move> tried_moves = {tried};
+    tables.update(pos, best, tried_moves, 5, 3, previous);
+    CHECK(tables.history_score(white, best) > 0);
+    CHECK(tables.history_score(white, tried) < 0);
+    CHECK(tables.history_score(black, best) == 0);
+    CHECK(tables.killers[3][0] == best);
+
+    auto after = pos;
+    after.make_move(best);
+    auto reply = parse_uci_move(after, "b8c6");
+    tables.update(after, reply, {}, 5, 4, best);
+    CHECK(tables.countermove(after, best) == reply);
+
+    for (int n = 0; n < 1000; ++n) {
+      tables.update(pos, best, tried_moves, 30, 3, previous);
+    }
+    CHECK(tables.history_score(white, best) <= history_tables::history_max);
+    CHECK(tables.history_score(white, tried) >= -history_tables::history_max);
+
+    tables.new_search();
+    CHECK(tables.killers[3][0].is_none());
+    tables.clear();
+    CHECK(tables.history_score(white, best) == 0);
+  }
+}
@@ -0,0 +1,148 @@
+#include "packed_position.hpp"
+
+#include <array>
+#include <vector>
+
+#include "catch.hpp"
+#include "movegen.hpp"
+
+using namespace slchess;
+
+namespace {
+
+constexpr position_fields kings_and_pawn() {
+  position_fields fields;
+  fields.board[make_square(4, 0)] = white_king;
+  fields.board[make_square(4, 7)] = black_king;
+  fields.board[make_square(3, 4)] = white_pawn;
+  fields.board[make_square(4, 4)] = black_pawn;
+  fields.en_passant = make_square(4, 5);
+  fields.halfmove_clock = 0;
+  fields.fullmove_number = 300;
+  return fields;
+}
+
+constexpr bool check_constexpr_round_trip() {
+  std::array<uint8_t, max_packed_position_size> buffer{};
+  auto size = encode_position(kings_and_pawn(), buffer);
+  size_t used = 0;
+  auto decoded = decode_position(std::span(buffer).first(size), used);
+  return size == 8 + 2 + 1 + 4 && used == size && decoded == kings_and_pawn();
+}
+
+static_assert(check_constexpr_round_trip());
+
+const char* const fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "rnbqkbnr/pp1ppppp/8/2p5/4P3/8/PPPP1PPP/RNBQKBNR w KQkq c6 0 2",
+    "rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 3",
+    "8/8/8/8/8/8/8/K6k b - - 42 1077",
+    "4k3/8/8/8/8/8/8/4K3 w - - 0 1",
+};
+
+}  // namespace
+
+TEST_CASE("check packed position", "[packed_position]") {
+  SECTION("check round trip") {
+    for (const char* fen : fens) {
+      auto pos = position::from_fen(fen);
+      std::array<uint8_t, max_packed_position_size> buffer{};
+
+      auto size = encode_position(fields_of(pos), buffer);
+      CHECK(size == 8 + (pos.pieces().count() + 1) / 2 + 1 + 4);
+      size_t used = 0;
+      auto decoded = to_position(decode_position(buffer, used));
+      CHECK(used == size);
+      CHECK(decoded.to_fen() == fen);
+      CHECK(decoded.key() == pos.key());
+    }
+  }
+
+  SECTION("check without clocks") {
+    auto pos = position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w Kq - 5 9");
+    auto same = position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w Kq - 0 1");
+    std::array<uint8_t, max_packed_position_size> first{}, second{};
+
+    auto size = encode_position(fields_of(pos), first, false);
+    CHECK(size == 25);
+    CHECK(encode_position(fields_of(same), second, false) == size);
+    CHECK(first == second);
+
+    size_t used = 0;
+    CHECK(to_position(decode_position(first, used)).to_fen() == same.to_fen());
+    CHECK(used == size);
+  }
+
+  SECTION("check invalid data") {
+    std::array<uint8_t, max_packed_position_size> buffer{};
+    auto size = encode_position(fields_of(position::start()), buffer);
+    size_t used = 0;
+    CHECK_THROWS_AS(decode_position(std::span(buffer).first(size - 1), used),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(decode_position(std::span(buffer).first(20), used), std::invalid_argument);
+    buffer[8] = 0x08;
+    CHECK_THROWS_AS(decode_position(buffer, used), std::invalid_argument);
+
+    // the corrupted records of the starting position: a1 is the nibble 0, e1 4 and a2 8
+    auto corrupted = [](size_t nibble, uint8_t code) {
+      std::array<uint8_t, max_packed_position_size> record{};
+      encode_position(fields_of(position::start()), record);
+      auto& byte = record[8 + nibble / 2];
+      byte = static_cast<uint8_t>(nibble % 2 == 0 ? (byte & 0xf0) | code
+                                                  : (byte & 0x0f) | code << 4);
+      return record;
+    };
+    auto no_white_king = corrupted(4, white_queen);
+    CHECK_THROWS_AS(decode_position(no_white_king, used), std::invalid_argument);
+    auto two_black_kings = corrupted(4, black_king);
+    CHECK_THROWS_AS(decode_position(two_black_kings, used), std::invalid_argument);
+    auto pawn_on_first_rank = corrupted(0, white_pawn);
+    CHECK_THROWS_AS(decode_position(pawn_on_first_rank, used), std::invalid_argument);
+    auto en_passant_on_second_rank = corrupted(8, packed::en_passant_pawn);
+    CHECK_THROWS_AS(decode_position(en_passant_on_second_rank, used), std::invalid_argument);
+    CHECK_NOTHROW(decode_position(corrupted(4, white_king), used));
+
+    // the record is valid, but the side not to move is in check
+    auto check = fields_of(position::from_fen("4k3/4R3/8/8/8/8/8/4K3 b - - 0 1"));
+    check.side = white;
+    auto record = encode_position(check, buffer);
+    CHECK_NOTHROW(decode_position(std::span(buffer).first(record), used));
+    CHECK_THROWS_AS(decode_positions(std::span(buffer).first(record)), std::invalid_argument);
+
+    // such a position is rejected by `from_fen`, so it's built by hand
+    position pos;
+    pos.put_piece(white_king, make_square(4, 0));
+    pos.put_piece(black_king, make_square(4, 7));
+    pos.set_state(black, no_castling, make_square(4, 2));
+    CHECK_THROWS_AS(encode_position(fields_of(pos), buffer), std::invalid_argument);
+  }
+
+  SECTION("check batch") {
+    std::vector<position> positions;
+    for (const char* fen : fens) {
+      positions.push_back(position::from_fen(fen));
+    }
+    // the positions after all the moves from the starting position
+    move_list moves;
+    generate_legal(position::start(), moves);
+    for (auto m : moves) {
+      auto pos = position::start();
+      pos.make_move(m);
+      positions.push_back(pos);
+    }
+
+    std::vector<uint8_t> data = {42};
+    auto size = encode_positions(positions, data);
+    CHECK(data.size() == size + 1);
+
+    auto decoded = decode_positions(std::span(data).subspan(1));
+    REQUIRE(decoded.size() == positions.size());
+    for (size_t n = 0; n < positions.size(); ++n) {
+      CHECK(decoded[n].to_fen() == positions[n].to_fen());
+    }
+
+    data.pop_back();
+    CHECK_THROWS_AS(decode_positions(std::span(data).subspan(1)), std::invalid_argument);
+  }
+}
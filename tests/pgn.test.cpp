@@ -0,0 +1,160 @@
+#include "pgn.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "catch.hpp"
+
+using namespace slchess;
+
+namespace {
+
+const char* const two_games =
+    "[Event \"Test \\\"one\\\"\"]\n"
+    "[White \"Alice\"]\n"
+    "[Black \"Bob\"]\n"
+    "\n"
+    "1. e4 {best by test} e5 2. Nf3 (2. f4 exf4 (2... d5) 3. Nf3) Nc6 $1 3.Bb5 a6 4. Ba4\n"
+    "Nf6 5. O-O ; a comment\n"
+    "Be7 1-0\n"
+    "\n"
+    "[Event \"Test two\"]\n"
+    "[FEN \"4k3/P7/8/8/8/8/8/4K2R w K - 0 1\"]\n"
+    "\n"
+    "1. a8=Q+ Kd7 2. O-O 1/2-1/2\n";
+
+std::vector<std::string_view> tokens(std::string_view movetext) {
+  std::vector<std::string_view> result;
+  movetext_tokenizer tokenizer(movetext);
+  for (auto token = tokenizer.next(); !token.empty(); token = tokenizer.next()) {
+    result.push_back(token);
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("check san", "[pgn]") {
+  SECTION("check simple moves") {
+    auto pos = position::start();
+    CHECK(parse_san(pos, "e4").to_uci() == "e2e4");
+    CHECK(parse_san(pos, "Nf3").to_uci() == "g1f3");
+    CHECK(parse_san(pos, "Nf3!?").to_uci() == "g1f3");
+    CHECK(parse_san(pos, "e5").is_none());
+    CHECK(parse_san(pos, "Ke2").is_none());
+    CHECK(parse_san(pos, "").is_none());
+  }
+
+  SECTION("check castling") {
+    auto pos = position::from_fen("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1");
+    CHECK(parse_san(pos, "O-O").to_uci() == "e1g1");
+    CHECK(parse_san(pos, "0-0-0").to_uci() == "e1c1");
+    CHECK(parse_san(pos, "O-O+").to_uci() == "e1g1");
+  }
+
+  SECTION("check promotion") {
+    auto pos = position::from_fen("1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1");
+    CHECK(parse_san(pos, "a8=Q").to_uci() == "a7a8q");
+    CHECK(parse_san(pos, "a8N").to_uci() == "a7a8n");
+    CHECK(parse_san(pos, "axb8=R+").to_uci() == "a7b8r");
+    CHECK(parse_san(pos, "a8").is_none());
+  }
+
+  SECTION("check disambiguation") {
+    auto pos = position::from_fen("4k3/8/8/8/8/8/4K3/R6R w - - 0 1");
+    CHECK(parse_san(pos, "Rd1").is_none());
+    CHECK(parse_san(pos, "Rad1").to_uci() == "a1d1");
+    CHECK(parse_san(pos, "Rhf1").to_uci() == "h1f1");
+
+    pos = position::from_fen("4k3/8/N7/8/8/8/N7/4K3 w - - 0 1");
+    CHECK(parse_san(pos, "Nb4").is_none());
+    CHECK(parse_san(pos, "N2b4").to_uci() == "a2b4");
+    CHECK(parse_san(pos, "N6xb4").to_uci() == "a6b4");
+    CHECK(parse_san(pos, "Na2b4").to_uci() == "a2b4");
+  }
+}
+
+TEST_CASE("check pgn parsing", "[pgn]") {
+  SECTION("check split games") {
+    auto games = split_games(two_games);
+    REQUIRE(games.size() == 2);
+    CHECK(games[0].substr(0, 7) == "[Event ");
+    CHECK(games[1].substr(0, 17) == "[Event \"Test two\"");
+    CHECK(split_games("").empty());
+    CHECK(split_games("1. e4 e5 *").size() == 1);
+  }
+
+  SECTION("check tags") {
+    auto games = split_games(two_games);
+    pgn_game game(games[0]);
+    CHECK(game.tag("Event") == "Test \\\"one\\\"");
+    CHECK(game.tag("White") == "Alice");
+    CHECK(game.tag("Black") == "Bob");
+    CHECK(game.tag("Whit").empty());
+    CHECK(game.tag("FEN").empty());
+    CHECK(game.movetext().substr(0, 6) == "1. e4 ");
+  }
+
+  SECTION("check tokenizer") {
+    auto games = split_games(two_games);
+    std::vector<std::string_view> expected = {"e4",  "e5", "Nf3", "Nc6", "Bb5", "a6",
+                                              "Ba4", "Nf6", "O-O", "Be7"};
+    CHECK(tokens(pgn_game(games[0]).movetext()) == expected);
+    CHECK(tokens("12... Kd7 13.Qxd8# 1-0 14. e4").size() == 2);
+    CHECK(tokens("1. e4 { unterminated").size() == 1);
+    CHECK(tokens("1.").empty());
+  }
+
+  SECTION("check replay") {
+    auto games = split_games(two_games);
+    std::vector<std::string> moves;
+    auto on_move = [&](const position&, move m) { moves.push_back(m.to_uci()); };
+
+    CHECK(replay_game(games[0], on_move));
+    CHECK(moves.size() == 10);
+    CHECK(moves.back() == "f8e7");
+
+    moves.clear();
+    CHECK(replay_game(games[1], on_move));
+    CHECK(moves == std::vector<std::string>{"a7a8q", "e8d7", "e1g1"});
+
+    moves.clear();
+    CHECK_FALSE(replay_game("1. e4 e5 2. Ke3 *", on_move));
+    CHECK(moves.size() == 2);
+  }
+}
+
+TEST_CASE("check pgn file", "[pgn]") {
+  auto path = (std::filesystem::temp_directory_path() / "slchess_pgn.test.pgn").string();
+  {
+    std::ofstream out(path);
+    for (int n = 0; n < 100; ++n) {
+      out << two_games << "\n[Event \"broken\"]\n\n1. e4 e4 *\n\n";
+    }
+  }
+
+  SECTION("check parallel replay") {
+    pgn_file file(path);
+    REQUIRE(file.games().size() == 300);
+
+    for (unsigned threads : {1U, 4U}) {
+      std::atomic<uint64_t> visited = 0;
+      auto stats = replay_games(file.games(), threads, [&](unsigned worker, const position&, move) {
+        CHECK(worker < threads);
+        ++visited;
+      });
+      CHECK(stats.games == 300);
+      CHECK(stats.moves == 100 * (10 + 3 + 1));
+      CHECK(stats.errors == 100);
+      CHECK(visited == stats.moves);
+    }
+  }
+
+  SECTION("check missing file") { CHECK_THROWS_AS(pgn_file(path + ".missing"), std::system_error); }
+
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,195 @@
+#include "position.hpp"
+
+#include "attacks.hpp"
+#include "catch.hpp"
+#include "movegen.hpp"
+#include "zobrist.hpp"
+
+/**
+ * The move generator is checked with the well known perft results, see
+ * https://www.chessprogramming.org/Perft_Results
+ */
+
+using namespace slchess;
+
+namespace {
+
+const char* const kiwipete = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+
+uint64_t key_from_scratch(const position& pos) {
+  uint64_t key = 0;
+  for (square_index sq = 0; sq < 64; ++sq) {
+    if (pos.piece_on(sq) != no_piece) {
+      key ^= zobrist::piece_key(pos.piece_on(sq), sq);
+    }
+  }
+  key ^= zobrist::castling_key(pos.castling_rights()) ^ zobrist::en_passant_key(pos.en_passant());
+  if (pos.side_to_move() == black) {
+    key ^= zobrist::side_key();
+  }
+  return key;
+}
+
+void check_keys(const position& pos, int depth) {
+  CHECK(pos.key() == key_from_scratch(pos));
+  if (depth == 0) {
+    return;
+  }
+  move_list moves;
+  generate_legal(pos, moves);
+  for (auto m : moves) {
+    position next = pos;
+    next.make_move(m);
+    check_keys(next, depth - 1);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("check fen", "[position]") {
+  SECTION("check round trip") {
+    for (const char* fen : {position::start_fen.data(),
+                            kiwipete,
+                            "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+                            "rnbqkbnr/pp1ppppp/8/2p5/4P3/8/PPPP1PPP/RNBQKBNR w KQkq c6 0 2",
+                            "8/8/8/8/8/8/8/K6k b - - 42 77"}) {
+      CHECK(position::from_fen(fen).to_fen() == fen);
+    }
+  }
+
+  SECTION("check the starting position") {
+    auto pos = position::start();
+    CHECK(pos.side_to_move() == white);
+    CHECK(pos.castling_rights() == all_castling);
+    CHECK(pos.en_passant() == no_square);
+    CHECK(pos.pieces().count() == 32);
+    CHECK(pos.pieces(white, pawn).count() == 8);
+    CHECK(pos.piece_on(make_square(4, 0)) == white_king);
+    CHECK(pos.piece_on(make_square(3, 7)) == black_queen);
+    CHECK(pos.king_square(black) == make_square(4, 7));
+    CHECK_FALSE(pos.in_check());
+  }
+
+  SECTION("check invalid fen") {
+    CHECK_THROWS_AS(position::from_fen(""), std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("8/8/8/8/8/8/8/8 w - -"), std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1"),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkx - 0 1"),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq - 0 1"),
+                    std::invalid_argument);
+  }
+
+  SECTION("check illegal positions") {
+    // the kings
+    CHECK_THROWS_AS(position::from_fen("8/8/8/8/8/8/8/4K3 w - - 0 1"), std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("4k3/8/8/8/8/8/8/3KK3 w - - 0 1"), std::invalid_argument);
+    // the pawns on the first and the last rank
+    CHECK_THROWS_AS(position::from_fen("4k2P/8/8/8/8/8/8/4K3 w - - 0 1"), std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("4k3/8/8/8/8/8/8/p3K3 b - - 0 1"), std::invalid_argument);
+    // the side not to move in check
+    CHECK_THROWS_AS(position::from_fen("4k3/4R3/8/8/8/8/8/4K3 w - - 0 1"), std::invalid_argument);
+    CHECK_NOTHROW(position::from_fen("4k3/4R3/8/8/8/8/8/4K3 b - - 0 1"));
+    // the en passant square without the pawn, on the wrong rank or occupied
+    CHECK_THROWS_AS(position::from_fen("4k3/8/8/8/8/8/8/4K3 w - e6 0 1"), std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("4k3/8/8/4p3/8/8/8/4K3 b - e3 0 1"),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("4k3/8/4n3/4p3/8/8/8/4K3 w - e6 0 1"),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(position::from_fen("4k3/8/8/4P3/8/8/8/4K3 w - e6 0 1"),
+                    std::invalid_argument);
+    CHECK_NOTHROW(position::from_fen("4k3/8/8/4p3/8/8/8/4K3 w - e6 0 1"));
+  }
+}
+
+TEST_CASE("check perft", "[position][movegen]") {
+  CHECK(perft(position::start(), 1) == 20);
+  CHECK(perft(position::start(), 2) == 400);
+  CHECK(perft(position::start(), 3) == 8902);
+  CHECK(perft(position::start(), 4) == 197281);
+
+  CHECK(perft(position::from_fen(kiwipete), 1) == 48);
+  CHECK(perft(position::from_fen(kiwipete), 2) == 2039);
+  CHECK(perft(position::from_fen(kiwipete), 3) == 97862);
+
+  auto pos3 = position::from_fen("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+  CHECK(perft(pos3, 4) == 43238);
+  CHECK(perft(pos3, 5) == 674624);
+
+  auto pos4 =
+      position::from_fen("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+  CHECK(perft(pos4, 3) == 9467);
+
+  auto pos5 = position::from_fen("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+  CHECK(perft(pos5, 3) == 62379);
+}
+
+TEST_CASE("check attack tables", "[movegen]") {
+  // the tables are constant expressions, so they are checked at compile time
+  constexpr square_index a1 = make_square(0, 0);
+  constexpr square_index e4 = make_square(4, 3);
+  static_assert(knight_attacks(a1).count() == 2 && knight_attacks(e4).count() == 8);
+  static_assert(king_attacks(a1) == (square_board(1) | square_board(8) | square_board(9)));
+  static_assert(pawn_attacks(white, e4).get(3_f, 4_r) && pawn_attacks(white, e4).get(5_f, 4_r));
+  static_assert(rook_attacks(a1, square_board(a1)).count() == 14);
+  static_assert(queen_attacks(e4, square_board(make_square(4, 5))).count() == 25);
+  static_assert(lsb(knight_attacks(a1)) == make_square(2, 1));
+  CHECK(bishop_attacks(e4, chessboard()).count() == 13);
+}
+
+TEST_CASE("check generation types", "[movegen]") {
+  auto pos = position::from_fen(kiwipete);
+  move_list captures, quiets, all;
+  generate<gen_type::captures>(pos, captures);
+  generate<gen_type::quiets>(pos, quiets);
+  generate<gen_type::all>(pos, all);
+
+  CHECK(captures.size() + quiets.size() == all.size());
+  for (auto m : captures) {
+    CHECK((m.is_capture() || m.is_promotion()));
+  }
+  for (auto m : quiets) {
+    CHECK_FALSE((m.is_capture() || m.is_promotion()));
+  }
+}
+
+TEST_CASE("check make move", "[position]") {
+  SECTION("check uci moves") {
+    auto pos = position::start();
+    for (const char* uci : {"e2e4", "c7c5", "g1f3", "d7d6", "f1b5", "c8d7", "e1g1"}) {
+      auto m = parse_uci_move(pos, uci);
+      REQUIRE_FALSE(m.is_none());
+      CHECK(m.to_uci() == uci);
+      pos.make_move(m);
+    }
+    CHECK(pos.to_fen() == "rn1qkbnr/pp1bpppp/3p4/1Bp5/4P3/5N2/PPPP1PPP/RNBQ1RK1 b kq - 3 4");
+    CHECK(parse_uci_move(pos, "e1g1").is_none());
+  }
+
+  SECTION("check en passant and promotion") {
+    auto pos = position::from_fen("4k3/1P6/8/8/5p2/8/4P3/4K3 w - - 0 1");
+    pos.make_move(parse_uci_move(pos, "e2e4"));
+    CHECK(pos.en_passant() == make_square(4, 2));
+    pos.make_move(parse_uci_move(pos, "f4e3"));
+    CHECK(pos.piece_on(make_square(4, 3)) == no_piece);
+    CHECK(pos.piece_on(make_square(4, 2)) == black_pawn);
+    pos.make_move(parse_uci_move(pos, "b7b8n"));
+    CHECK(pos.piece_on(make_square(1, 7)) == white_knight);
+    CHECK(pos.to_fen() == "1N2k3/8/8/8/8/4p3/8/4K3 b - - 0 2");
+  }
+
+  SECTION("check keys are updated incrementally") {
+    check_keys(position::start(), 3);
+    check_keys(position::from_fen(kiwipete), 2);
+  }
+
+  SECTION("check insufficient material") {
+    CHECK(position::from_fen("8/8/8/8/8/8/8/K6k w - - 0 1").insufficient_material());
+    CHECK(position::from_fen("8/8/8/8/8/8/8/KN5k w - - 0 1").insufficient_material());
+    CHECK_FALSE(position::from_fen("7k/8/8/8/8/8/8/KR6 w - - 0 1").insufficient_material());
+    CHECK_FALSE(position::from_fen("8/8/8/8/8/8/P7/K6k w - - 0 1").insufficient_material());
+  }
+}
@@ -0,0 +1,63 @@
+#include "search.hpp"
+
+#include "catch.hpp"
+#include "evaluate.hpp"
+#include "movegen.hpp"
+
+using namespace slchess;
+
+TEST_CASE("check evaluation", "[evaluate]") {
+  SECTION("check the starting position is balanced") {
+    CHECK(evaluate(position::start()) == 0);
+    CHECK(game_phase(position::start()) == max_phase);
+  }
+
+  SECTION("check the evaluation is symmetric") {
+    auto pos = position::from_fen("4k3/8/8/8/8/8/8/QQQQK3 w - - 0 1");
+    auto mirrored = position::from_fen("qqqqk3/8/8/8/8/8/8/4K3 b - - 0 1");
+    CHECK(evaluate(pos) == evaluate(mirrored));
+    CHECK(evaluate(pos) > 3000);
+  }
+}
+
+TEST_CASE("check search", "[search]") {
+  searcher search;
+
+  SECTION("check mate in one") {
+    auto pos = position::from_fen("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+    auto result = search.search(pos, {3, 0});
+    CHECK(result.best_move.to_uci() == "a1a8");
+    CHECK(result.score == score_mate - 1);
+    CHECK(is_mate_score(result.score));
+  }
+
+  SECTION("check winning a queen") {
+    auto pos = position::from_fen("4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1");
+    auto result = search.search(pos, {4, 0});
+    CHECK(result.best_move.to_uci() == "d1d5");
+  }
+
+  SECTION("check no legal moves") {
+    auto mated = search.search(position::from_fen("R5k1/5ppp/8/8/8/8/8/6K1 b - - 0 1"), {3, 0});
+    CHECK(mated.best_move.is_none());
+    CHECK(mated.score == -score_mate);
+
+    auto stalemate = search.search(position::from_fen("7k/5Q2/8/8/8/8/8/6K1 b - - 0 1"), {3, 0});
+    CHECK(stalemate.best_move.is_none());
+    CHECK(stalemate.score == 0);
+  }
+
+  SECTION("check node limit") {
+    auto result = search.search(position::start(), {0, 5000});
+    CHECK_FALSE(result.best_move.is_none());
+    CHECK(result.depth >= 1);
+    CHECK(result.pv.front() == result.best_move);
+  }
+
+  SECTION("check repetition is a draw") {
+    // black is lost, but can repeat the position with a perpetual check
+    auto pos = position::from_fen("6k1/6p1/8/8/8/1q6/8/K7 b - - 0 1");
+    auto result = search.search(pos, {6, 0});
+    CHECK(result.score >= 0);
+  }
+}
@@ -0,0 +1,66 @@
+#include "stats.hpp"
+
+#include <thread>
+
+#include "bitboard.hpp"
+#include "catch.hpp"
+#include "search.hpp"
+
+using namespace slchess;
+
+TEST_CASE("check stats", "[stats]") {
+  stats::reset();
+
+  SECTION("check counting") {
+    stats::add(stat_counter::eval_calls, 3);
+    stats::add_cutoff(0);
+    stats::add_cutoff(100);
+    std::thread([] { stats::add(stat_counter::eval_calls); }).join();
+
+    auto values = stats::collect();
+    if constexpr (stats::enabled) {
+      CHECK(values[stat_counter::eval_calls] == 4);
+      CHECK(values.cutoffs[0] == 1);
+      CHECK(values.cutoffs[cutoff_slots - 1] == 1);
+    } else {
+      CHECK(values[stat_counter::eval_calls] == 0);
+      CHECK(values.cutoffs[0] == 0);
+    }
+
+    stats::reset();
+    CHECK(stats::collect()[stat_counter::eval_calls] == 0);
+  }
+
+  SECTION("check search counters") {
+    transposition_table tt(1);
+    searcher search;
+    search.set_transposition_table(&tt);
+    auto result = search.search(position::start(), {4, 0});
+
+    auto values = stats::collect();
+    if constexpr (stats::enabled) {
+      CHECK(values[stat_counter::nodes] + values[stat_counter::quiescence_nodes] == result.nodes);
+      CHECK(values[stat_counter::tt_probes] == values[stat_counter::nodes]);
+      CHECK(values[stat_counter::tt_hits] > 0);
+      CHECK(values[stat_counter::eval_calls] > 0);
+      CHECK(values.cutoffs[0] > 0);
+    } else {
+      CHECK(values[stat_counter::nodes] == 0);
+    }
+  }
+
+  SECTION("check range check failures") {
+    bitboard<3, 3> checked;
+    CHECK_THROWS_AS(checked.set(3_f, 0_r), std::out_of_range);
+    bitboard<3, 3, false> unchecked;
+    unchecked.set(0_f, 3_r);
+
+    CHECK(stats::collect()[stat_counter::range_check_failures] == (stats::enabled ? 2 : 0));
+  }
+
+  SECTION("check format") {
+    auto text = stats::format(stats::collect());
+    CHECK(text.find("nodes 0\n") == 0);
+    CHECK(text.find("cutoffs 0 0") != std::string::npos);
+  }
+}
@@ -0,0 +1,93 @@
+#include "task_scheduler.hpp"
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "catch.hpp"
+#include "movegen.hpp"
+
+using namespace slchess;
+
+TEST_CASE("check task scheduler", "[task_scheduler]") {
+  task_scheduler scheduler(4);
+  REQUIRE(scheduler.size() == 4);
+  CHECK(scheduler.worker_index() == scheduler.size());
+
+  SECTION("run many small tasks") {
+    task_group group;
+    std::atomic<int> sum{0};
+    for (int n = 1; n <= 10000; ++n) {
+      scheduler.submit(group, [&sum, n] { sum += n; });
+    }
+    scheduler.wait(group);
+    CHECK(sum == 10000 * 10001 / 2);
+
+    // the group can be reused after the wait
+    scheduler.submit(group, [&sum] { sum = 0; });
+    scheduler.wait(group);
+    CHECK(sum == 0);
+  }
+
+  SECTION("cover the range once") {
+    for (size_t count : {0, 1, 7, 1000, 4099}) {
+      std::vector<std::atomic<int>> visits(count);
+      std::atomic<bool> valid_index{true};
+      scheduler.parallel_for(count, 16, [&](size_t begin, size_t end) {
+        if (end <= begin || end - begin > 16 || scheduler.worker_index() >= scheduler.size()) {
+          valid_index = false;
+        }
+        for (auto n = begin; n < end; ++n) {
+          ++visits[n];
+        }
+      });
+      CHECK(valid_index);
+      for (const auto& visit : visits) {
+        CHECK(visit == 1);
+      }
+    }
+  }
+
+  SECTION("wait for the subtasks in the tasks") {
+    task_group outer;
+    std::atomic<int> leaves{0};
+    for (int n = 0; n < 16; ++n) {
+      scheduler.submit(outer, [&] {
+        task_group inner;
+        for (int k = 0; k < 16; ++k) {
+          scheduler.submit(inner, [&leaves] { ++leaves; });
+        }
+        scheduler.wait(inner);
+      });
+    }
+    scheduler.wait(outer);
+    CHECK(leaves == 256);
+  }
+
+  SECTION("rethrow the exception") {
+    task_group group;
+    std::atomic<int> finished{0};
+    for (int n = 0; n < 100; ++n) {
+      scheduler.submit(group, [&finished, n] {
+        if (n == 42) {
+          throw std::runtime_error("task failed");
+        }
+        ++finished;
+      });
+    }
+    CHECK_THROWS_AS(scheduler.wait(group), std::runtime_error);
+    CHECK(finished == 99);
+
+    scheduler.submit(group, [&finished] { ++finished; });
+    CHECK_NOTHROW(scheduler.wait(group));
+  }
+
+  SECTION("count perft in parallel") {
+    auto pos = position::from_fen(
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    CHECK(perft(pos, 3, scheduler, 1) == 97862);
+    CHECK(perft(pos, 3, scheduler, 4) == 97862);
+    CHECK(perft(position::start(), 5, scheduler, 2) == perft(position::start(), 5));
+  }
+}
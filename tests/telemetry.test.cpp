@@ -0,0 +1,68 @@
+#include "telemetry.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "search.hpp"
+
+using namespace slchess;
+
+TEST_CASE("check telemetry", "[telemetry]") {
+  SECTION("check event fields") {
+    telemetry::event event("test");
+    event.field("int", -5)
+        .field("unsigned", uint64_t{7})
+        .field("flag", false)
+        .field("text", "a \"quoted\"\\ \n line");
+    CHECK(event.fields() == R"("event":"test","int":-5,"unsigned":7,"flag":false,)"
+                               R"("text":"a \"quoted\"\\ \u000a line")");
+  }
+
+  SECTION("check non-finite numbers") {
+    telemetry::event event("test");
+    event.field("half", 0.5)
+        .field("nan", std::numeric_limits<double>::quiet_NaN())
+        .field("inf", -std::numeric_limits<double>::infinity());
+    CHECK(event.fields() == R"("event":"test","half":0.5,"nan":null,"inf":null)");
+  }
+
+  SECTION("check search events") {
+    auto path = std::filesystem::temp_directory_path() / "slchess_telemetry.test.log";
+    std::filesystem::remove(path);
+
+    CHECK_FALSE(telemetry::enabled());
+    telemetry::start(path.string());
+    CHECK(telemetry::enabled());
+    transposition_table tt(1);
+    searcher search;
+    search.set_transposition_table(&tt);
+    auto result = search.search(position::start(), {3, 0});
+    telemetry::stop();
+    CHECK_FALSE(telemetry::enabled());
+
+    // nothing is logged after stopping
+    telemetry::event("ignored").log();
+
+    std::ifstream input(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(input, line);) {
+      lines.push_back(line);
+    }
+    REQUIRE(lines.size() == 4);
+    for (const auto& line : lines) {
+      CHECK(line.front() == '{');
+      CHECK(line.back() == '}');
+      CHECK(line.find(R"("level":"info")") != std::string::npos);
+    }
+    CHECK(lines[0].find(R"("event":"iteration","depth":1,)") != std::string::npos);
+    CHECK(lines[2].find(R"("hashfull":)") != std::string::npos);
+    CHECK(lines[3].find(R"("event":"search","best_move":")" + result.best_move.to_uci()) !=
+          std::string::npos);
+
+    std::filesystem::remove(path);
+  }
+}
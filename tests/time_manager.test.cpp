@@ -0,0 +1,171 @@
+#include "time_manager.hpp"
+
+#include <sstream>
+
+#include "catch.hpp"
+#include "movegen.hpp"
+#include "search.hpp"
+#include "uci.hpp"
+
+using namespace slchess;
+using namespace std::chrono_literals;
+
+TEST_CASE("check time allocation", "[time]") {
+  SECTION("check the budget is a part of the clock") {
+    time_control control{60'000ms, 0ms, 0, 0ms, 20ms};
+    time_manager timing(control, 0);
+    CHECK(timing.optimum() > 500ms);
+    CHECK(timing.optimum() < 5'000ms);
+    CHECK(timing.maximum() > timing.optimum());
+    CHECK(timing.maximum() <= 48'000ms);
+  }
+
+  SECTION("check the increment and moves to go give more time") {
+    time_manager sudden_death({10'000ms, 0ms, 0, 0ms, 20ms}, 40);
+    time_manager increment({10'000ms, 1'000ms, 0, 0ms, 20ms}, 40);
+    time_manager last_moves({10'000ms, 0ms, 2, 0ms, 20ms}, 40);
+    CHECK(increment.optimum() > sudden_death.optimum());
+    CHECK(last_moves.optimum() > increment.optimum());
+  }
+
+  SECTION("check the clock is never exceeded") {
+    time_manager last_move({1'000ms, 5'000ms, 1, 0ms, 20ms}, 100);
+    CHECK(last_move.maximum() < 1'000ms);
+    CHECK(last_move.optimum() <= last_move.maximum());
+
+    time_manager no_time({10ms, 0ms, 0, 0ms, 20ms}, 100);
+    CHECK(no_time.maximum() == 1ms);
+  }
+
+  SECTION("check the move time") {
+    time_manager timing({0ms, 0ms, 0, 500ms, 20ms}, 10);
+    CHECK(timing.optimum() == 480ms);
+    CHECK(timing.maximum() == 480ms);
+    CHECK(timing.next_iteration(move(), 0, 400ms));
+  }
+
+  SECTION("check the clock without limits") {
+    CHECK_THROWS_AS(time_manager(time_control{}, 0), std::invalid_argument);
+  }
+}
+
+TEST_CASE("check budget adjustments", "[time]") {
+  auto pos = position::start();
+  move_list moves;
+  generate_legal(pos, moves);
+  time_control control{60'000ms, 0ms, 0, 0ms, 20ms};
+
+  SECTION("check the stable best move reduces the budget") {
+    time_manager timing(control, 0);
+    for (int n = 0; n < 10; ++n) {
+      timing.next_iteration(moves[0], 20, 1ms);
+    }
+    CHECK(timing.budget() < timing.optimum());
+  }
+
+  SECTION("check the changing best move and the falling score extend the budget") {
+    time_manager unstable(control, 0);
+    time_manager falling(control, 0);
+    for (int n = 0; n < 6; ++n) {
+      unstable.next_iteration(moves[n % 2], 20, 1ms);
+      falling.next_iteration(moves[0], 20 - 100 * n, 1ms);
+    }
+    CHECK(unstable.budget() > unstable.optimum());
+    CHECK(falling.budget() > falling.optimum());
+    CHECK(unstable.budget() <= unstable.maximum());
+  }
+
+  SECTION("check the iteration predicted to end after the budget isn't started") {
+    time_manager timing(control, 0);
+    auto budget = timing.optimum();
+    CHECK(timing.next_iteration(moves[0], 0, budget / 10));
+    CHECK_FALSE(timing.next_iteration(moves[0], 0, budget / 2));
+  }
+}
+
+TEST_CASE("check stopping the search", "[time]") {
+  searcher search;
+
+  SECTION("check the stop timer") {
+    std::atomic<bool> flag{false};
+    {
+      stop_timer timer(std::chrono::steady_clock::now() + 10ms, flag);
+      std::this_thread::sleep_for(100ms);
+    }
+    CHECK(flag.load());
+
+    flag = false;
+    { stop_timer timer(std::chrono::steady_clock::now() + 1h, flag); }
+    CHECK_FALSE(flag.load());
+  }
+
+  SECTION("check the move time is kept") {
+    search_limits limits;
+    limits.time.move_time = 200ms;
+    auto start = std::chrono::steady_clock::now();
+    auto result = search.search(position::start(), limits);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CHECK_FALSE(result.best_move.is_none());
+    CHECK(elapsed >= 150ms);
+    CHECK(elapsed < 1'000ms);
+  }
+
+  SECTION("check the stop flag") {
+    std::atomic<bool> stop{true};
+    search_limits limits;
+    limits.stop = &stop;
+    auto result = search.search(position::start(), limits);
+    CHECK_FALSE(result.best_move.is_none());
+    CHECK(result.depth == 1);
+  }
+}
+
+TEST_CASE("check uci", "[uci]") {
+  SECTION("check the scores") {
+    CHECK(uci_score(25) == "cp 25");
+    CHECK(uci_score(score_mate - 1) == "mate 1");
+    CHECK(uci_score(score_mate - 3) == "mate 2");
+    CHECK(uci_score(-score_mate + 2) == "mate -1");
+  }
+
+  SECTION("check the protocol") {
+    std::istringstream input(
+        "uci\n"
+        "isready\n"
+        "setoption name Hash value 4\n"
+        "position startpos moves e2e4 e7e5\n"
+        "go wtime 1000 btime 1000 depth 3\n"
+        "position startpos moves e2e5\n"
+        "quit\n");
+    std::ostringstream output;
+    uci_engine engine(input, output);
+    engine.run();
+
+    auto text = output.str();
+    CHECK(text.find("uciok\n") != std::string::npos);
+    CHECK(text.find("readyok\n") != std::string::npos);
+    CHECK(text.find("info depth 1 score cp") != std::string::npos);
+    CHECK(text.find("bestmove ") != std::string::npos);
+    CHECK(text.find("info string error: illegal move: e2e5") != std::string::npos);
+  }
+
+  SECTION("check the infinite and the ponder search") {
+    std::istringstream input(
+        "position startpos\n"
+        "go infinite depth 1 searchmoves e2e4 d2d4\n"
+        "isready\n"
+        "stop\n"
+        "go ponder wtime 1000 btime 1000 depth 2\n"
+        "ponderhit\n"
+        "quit\n");
+    std::ostringstream output;
+    uci_engine engine(input, output);
+    engine.run();
+
+    auto text = output.str();
+    CHECK(text.find("info string error") == std::string::npos);
+    // the bestmove of the infinite search is held until "stop"
+    CHECK(text.find("readyok\n") < text.find("bestmove "));
+    CHECK(text.find("bestmove ", text.find("bestmove ") + 1) != std::string::npos);
+  }
+}
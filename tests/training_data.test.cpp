@@ -0,0 +1,101 @@
+#include "training_data.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "catch.hpp"
+#include "movegen.hpp"
+
+using namespace slchess;
+
+TEST_CASE("check packed sample", "[training_data]") {
+  SECTION("check round trip") {
+    for (const char* fen :
+         {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+          "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+          "rnbqkbnr/pp1ppppp/8/2p5/4P3/8/PPPP1PPP/RNBQKBNR w KQkq c6 0 2",
+          "8/8/8/8/8/8/8/K6k b - - 42 77"}) {
+      auto pos = position::from_fen(fen);
+      auto sample = pack_sample(pos, -123, 1);
+      auto unpacked = unpack_position(sample);
+      CHECK(unpacked.to_fen() == fen);
+      CHECK(unpacked.key() == pos.key());
+      CHECK(sample.score == -123);
+      CHECK(sample.result == 1);
+    }
+  }
+
+  SECTION("check too many pieces") {
+    auto pos = position::from_fen("k7/8/PPPPPPPP/PPPPPPPP/PPPPPPPP/PPPPPPPP/PPPPPPPP/K7 w - - 0 1");
+    CHECK_THROWS_AS(pack_sample(pos, 0, 0), std::invalid_argument);
+  }
+
+  SECTION("check invalid sample") {
+    auto sample = pack_sample(position::start(), 0, 0);
+    auto corrupted = sample;
+    corrupted.pieces[0] = 0x77;
+    CHECK_THROWS_AS(unpack_position(corrupted), std::invalid_argument);
+    corrupted = sample;
+    corrupted.occupancy = ~uint64_t{0};
+    CHECK_THROWS_AS(unpack_position(corrupted), std::invalid_argument);
+    corrupted = sample;
+    corrupted.en_passant = 200;
+    CHECK_THROWS_AS(unpack_position(corrupted), std::invalid_argument);
+    corrupted = sample;
+    corrupted.en_passant = 20;
+    CHECK_THROWS_AS(unpack_position(corrupted), std::invalid_argument);
+    corrupted = sample;
+    corrupted.occupancy &= ~(uint64_t{1} << 4);
+    CHECK_THROWS_AS(unpack_position(corrupted), std::invalid_argument);
+  }
+}
+
+TEST_CASE("check gensfen", "[training_data]") {
+  auto path = (std::filesystem::temp_directory_path() / "slchess_gensfen.test.bin").string();
+
+  gensfen_options options;
+  options.output = path;
+  options.count = 300;
+  options.depth = 1;
+  options.threads = 2;
+  options.buffer_size = 16;
+
+  CHECK(gensfen(options) == options.count);
+
+  auto samples = read_samples(path);
+  REQUIRE(samples.size() == options.count);
+  for (const auto& sample : samples) {
+    auto pos = unpack_position(sample);
+    CHECK_FALSE(pos.in_check());
+    CHECK(sample.result >= -1);
+    CHECK(sample.result <= 1);
+    move_list moves;
+    generate_legal(pos, moves);
+    CHECK_FALSE(moves.empty());
+  }
+
+  samples[samples.size() / 2].pieces[0] = 0x77;
+  {
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(samples.data()),
+                 static_cast<std::streamsize>(samples.size() * sizeof(packed_sample)));
+  }
+  CHECK_THROWS_AS(read_samples(path), std::runtime_error);
+
+  std::remove(path.c_str());
+  CHECK_THROWS_AS(read_samples(path), std::runtime_error);
+}
+
+TEST_CASE("check sample writer failure", "[training_data]") {
+  // writing to /dev/full always fails with "no space left on device"
+  if (!std::filesystem::exists("/dev/full")) {
+    return;
+  }
+  sample_writer writer("/dev/full");
+  writer.submit(std::vector<packed_sample>(100'000));
+  CHECK_THROWS_AS(writer.flush(), std::runtime_error);
+  CHECK(writer.failed());
+}
@@ -0,0 +1,169 @@
+#include "transposition_table.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "catch.hpp"
+#include "lockless_table.hpp"
+#include "movegen.hpp"
+#include "search.hpp"
+
+using namespace slchess;
+
+TEST_CASE("check large buffer", "[large_memory]") {
+  CHECK(numa_nodes() >= 1);
+
+  SECTION("check small buffer") {
+    large_buffer buffer(1000);
+    REQUIRE(buffer.data() != nullptr);
+    CHECK(buffer.size() == 1000);
+    CHECK(buffer.pages() == page_kind::normal);
+    std::memset(buffer.data(), 1, buffer.size());
+    buffer.clear(4);
+    auto* bytes = static_cast<const uint8_t*>(buffer.data());
+    CHECK(std::all_of(bytes, bytes + buffer.size(), [](uint8_t b) { return b == 0; }));
+  }
+
+  SECTION("check huge buffer") {
+    auto size = 3 * large_buffer::huge_page_size + 100;
+    large_buffer buffer(size, numa_policy::interleave);
+    REQUIRE(buffer.data() != nullptr);
+    CHECK(reinterpret_cast<uintptr_t>(buffer.data()) % large_buffer::huge_page_size == 0);
+
+    auto* bytes = static_cast<uint8_t*>(buffer.data());
+    CHECK(bytes[0] == 0);
+    CHECK(bytes[size - 1] == 0);
+    std::memset(bytes, 0xff, size);
+    buffer.clear(3);
+    CHECK(std::all_of(bytes, bytes + size, [](uint8_t b) { return b == 0; }));
+
+    large_buffer moved(std::move(buffer));
+    CHECK(buffer.data() == nullptr);
+    CHECK(moved.data() == bytes);
+    CHECK(moved.size() == size);
+  }
+
+  SECTION("check bound buffer") {
+    large_buffer buffer(large_buffer::huge_page_size, numa_policy::bind, 0);
+    static_cast<uint8_t*>(buffer.data())[0] = 1;
+    buffer.clear();
+    CHECK(static_cast<uint8_t*>(buffer.data())[0] == 0);
+  }
+}
+
+TEST_CASE("check lockless table", "[transposition_table]") {
+  SECTION("check the portable multiplication") {
+    static_assert(detail::multiply_high_portable(~0ULL, ~0ULL) == ~0ULL - 1);
+    std::mt19937_64 rng(7);
+    for (int n = 0; n < 10000; ++n) {
+      auto a = rng();
+      auto b = n % 2 == 0 ? rng() : rng() >> (n % 64);
+      CHECK(detail::multiply_high_portable(a, b) == multiply_high(a, b));
+    }
+    CHECK(multiply_high(1ULL << 63, 10) == 5);
+  }
+
+  SECTION("check the slots") {
+    std::vector<lockless_entry> entries(2 * lockless_table::bucket_size);
+    lockless_table table(entries.data(), 2);
+    const uint64_t key = 0x123456789abcdef;
+    CHECK(table.probe(key) == 0);
+
+    auto depth = [](uint64_t data) { return static_cast<int>(data); };
+    auto slot = table.find_slot(key, depth);
+    CHECK_FALSE(slot.same_key);
+    CHECK(slot.data == 0);
+    slot.entry->save(key, 5);
+    CHECK(table.probe(key) == 5);
+    CHECK(table.find_slot(key, depth).same_key);
+
+    // the other keys of the bucket fill it, then the lowest value is replaced
+    auto* bucket = table.bucket(key);
+    for (uint64_t data = 1; data < lockless_table::bucket_size; ++data) {
+      bucket[data].save(key + data, data + 10);
+    }
+    bucket[2].save(key + 2, 2);
+    auto replaced = table.find_slot(key + 100, depth);
+    CHECK(replaced.entry == bucket + 2);
+    CHECK(replaced.data == 2);
+    CHECK_FALSE(replaced.same_key);
+
+    // a torn entry doesn't match its key
+    bucket[0].data = 6;
+    CHECK(table.probe(key) == 0);
+  }
+}
+
+TEST_CASE("check transposition table", "[transposition_table]") {
+  auto e2e4 = parse_uci_move(position::start(), "e2e4");
+  auto d2d4 = parse_uci_move(position::start(), "d2d4");
+
+  SECTION("check store and probe") {
+    transposition_table tt(1);
+    CHECK(tt.capacity() == 1024 * 1024 / 16);
+    CHECK_FALSE(tt.probe(7).has_value());
+
+    tt.store(7, e2e4, -score_mate + 3, 5, bound::lower);
+    auto entry = tt.probe(7);
+    REQUIRE(entry.has_value());
+    CHECK(entry->best_move == e2e4);
+    CHECK(entry->score == -score_mate + 3);
+    CHECK(entry->depth == 5);
+    CHECK(entry->type == bound::lower);
+
+    // a result without a move keeps the known move
+    tt.store(7, move(), 10, 6, bound::upper);
+    CHECK(tt.probe(7)->best_move == e2e4);
+    CHECK(tt.probe(7)->type == bound::upper);
+
+    tt.clear(2);
+    CHECK_FALSE(tt.probe(7).has_value());
+  }
+
+  SECTION("check replacement") {
+    transposition_table tt(0);
+    REQUIRE(tt.capacity() == transposition_table::bucket_size);
+    for (uint64_t key = 1; key <= 4; ++key) {
+      tt.store(key, e2e4, 0, static_cast<int>(10 + key), bound::exact);
+    }
+    // the shallowest entry is replaced
+    tt.store(5, d2d4, 0, 1, bound::exact);
+    CHECK_FALSE(tt.probe(1).has_value());
+    CHECK(tt.probe(5).has_value());
+
+    // the much deeper entry of the current search is kept
+    tt.store(4, d2d4, 0, 1, bound::lower);
+    CHECK(tt.probe(4)->depth == 14);
+
+    // the entries from the old searches are replaced first
+    tt.new_search();
+    tt.new_search();
+    tt.store(4, d2d4, 0, 13, bound::exact);
+    tt.store(6, d2d4, 0, 2, bound::exact);
+    CHECK(tt.probe(4).has_value());
+    CHECK(tt.probe(6).has_value());
+    CHECK_FALSE(tt.probe(5).has_value());
+  }
+
+  SECTION("check search") {
+    transposition_table tt(4);
+    searcher with_table;
+    with_table.set_transposition_table(&tt);
+    searcher without_table;
+
+    for (const char* fen :
+         {"6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1",
+          "4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1",
+          "r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4"}) {
+      auto pos = position::from_fen(fen);
+      auto expected = without_table.search(pos, {5, 0});
+      auto result = with_table.search(pos, {5, 0});
+      CHECK(result.best_move == expected.best_move);
+      CHECK(result.score == expected.score);
+      CHECK(result.nodes <= expected.nodes);
+    }
+  }
+}
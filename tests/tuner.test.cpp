@@ -0,0 +1,154 @@
+#include "tuner.hpp"
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "catch.hpp"
+#include "endgame.hpp"
+#include "movegen.hpp"
+
+using namespace slchess;
+
+namespace {
+
+/// Plays random games and returns their positions.
+std::vector<position> random_positions(size_t count, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<position> positions;
+  auto pos = position::start();
+  while (positions.size() < count) {
+    move_list moves;
+    generate_legal(pos, moves);
+    if (moves.empty() || pos.halfmove_clock() > 60) {
+      pos = position::start();
+      continue;
+    }
+    pos.make_move(moves[rng() % moves.size()]);
+    positions.push_back(pos);
+  }
+  return positions;
+}
+
+int material(const position& pos, color side) {
+  int sum = 0;
+  for (auto type : {pawn, knight, bishop, rook, queen}) {
+    sum += piece_values[type] * static_cast<int>(pos.pieces(side, type).count());
+  }
+  return sum;
+}
+
+}  // namespace
+
+TEST_CASE("check tuning features", "[tuner]") {
+  const auto weights = to_tuning_weights(default_eval_weights());
+  auto positions = random_positions(500, 1);
+  for (const char* fen : {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                          "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 0 1"}) {
+    positions.push_back(position::from_fen(fen));
+  }
+
+  tuning_set data;
+  for (const auto& pos : positions) {
+    data.add(pos, 0.5F, 0);
+  }
+  REQUIRE(data.size() == positions.size());
+  CHECK(data.memory_usage() > 0);
+
+  SECTION("check the evaluation") {
+    for (size_t n = 0; n < positions.size(); ++n) {
+      auto expected = evaluate(positions[n]);
+      if (positions[n].side_to_move() == black) {
+        expected = -expected;
+      }
+      // the engine rounds the tapered score towards zero
+      CHECK(std::abs(data.evaluate(n, weights) - static_cast<float>(expected)) < 1.01F);
+    }
+
+    // the special endgames are not evaluated with the weights, so they are skipped
+    for (const char* fen : {"8/8/8/4k3/8/8/3P4/4K3 w - - 0 1",
+                            "8/8/8/4k3/8/8/8/R3K3 b - - 0 1",
+                            "8/8/8/8/8/8/8/K6k w - - 0 1"}) {
+      auto pos = position::from_fen(fen);
+      REQUIRE(evaluate_endgame(pos).has_value());
+      CHECK(evaluate(pos) == *evaluate_endgame(pos));
+      data.add(pos, 0.5F, 0);
+      CHECK(data.size() == positions.size());
+    }
+  }
+
+  SECTION("check the conversion") {
+    auto converted = to_tuning_weights(to_eval_weights(weights));
+    for (size_t n = 0; n < positions.size(); ++n) {
+      CHECK(data.evaluate(n, converted) == Approx(data.evaluate(n, weights)).margin(0.01));
+    }
+    auto text = format_eval_weights(default_eval_weights());
+    CHECK(text.starts_with("eval_weights{"));
+    CHECK_THROWS_AS(to_eval_weights(tuning_weights(10)), std::invalid_argument);
+  }
+
+  SECTION("check the sample labels") {
+    auto pos = position::from_fen("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 0 1");
+    tuning_set samples;
+    samples.add(pack_sample(pos, 50, 1));
+    task_scheduler scheduler(1);
+    texel_tuner tuner(samples, scheduler);
+    tuner.set_scale(1.0);
+    // black won, so the target for white is 0
+    auto prediction = 1 / (1 + std::pow(10.0, -samples.evaluate(0, weights) / 400));
+    CHECK(tuner.loss(weights) == Approx(prediction * prediction));
+  }
+}
+
+TEST_CASE("check texel tuner", "[tuner]") {
+  tuning_set data;
+  for (const auto& pos : random_positions(3000, 2)) {
+    auto balance = material(pos, white) - material(pos, black);
+    float result = balance > 0 ? 1.0F : balance < 0 ? 0.0F : 0.5F;
+    data.add(pos, result, balance);
+  }
+  task_scheduler scheduler(3);
+
+  SECTION("check the arguments") {
+    CHECK_THROWS_AS(texel_tuner(tuning_set(), scheduler), std::invalid_argument);
+    CHECK_THROWS_AS(texel_tuner(data, scheduler, 1.5), std::invalid_argument);
+  }
+
+  SECTION("check the gradient") {
+    texel_tuner tuner(data, scheduler, 0.5);
+    auto weights = to_tuning_weights(default_eval_weights());
+    tuner.set_scale(1.0);
+    std::vector<double> gradient;
+    CHECK(tuner.gradient(weights, gradient) == Approx(tuner.loss(weights)));
+    REQUIRE(gradient.size() == weights.size());
+
+    // the white knight on f3 in the middle game, the pawn value in the end game
+    for (size_t n : {2 * (knight * 64 + 45), 2 * (6 * 64 + pawn) + 1}) {
+      auto changed = weights;
+      changed[n] += 1;
+      auto plus = tuner.loss(changed);
+      changed[n] -= 2;
+      auto minus = tuner.loss(changed);
+      CHECK(gradient[n] == Approx((plus - minus) / 2).epsilon(0.02));
+    }
+  }
+
+  SECTION("check the tuning") {
+    texel_tuner tuner(data, scheduler);
+    auto weights = to_tuning_weights(default_eval_weights());
+    auto scale = tuner.fit_scale(weights);
+    CHECK(scale > 0.01);
+    CHECK(scale < 10);
+    auto initial_loss = tuner.loss(weights);
+
+    int epochs = 0;
+    tuning_options options;
+    options.epochs = 30;
+    options.learning_rate = 2;
+    auto final_loss = tuner.tune(weights, options, [&](int epoch, double) { epochs = epoch; });
+    CHECK(epochs == 30);
+    CHECK(final_loss < initial_loss);
+    CHECK(final_loss == Approx(tuner.loss(weights)));
+  }
+}